@@ -0,0 +1,113 @@
+/*
+BENCH debug-gpio module
+Reports ns/op of DebugGpio_Put() with the DMA busy (enqueue only) and idle (enqueue and first frame
+encoding), against a transfer that only records its words (make bench).
+*/
+#define _POSIX_C_SOURCE 199309L
+#include "debug-gpio.h"
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_ITERATIONS    100000
+
+static volatile uint32_t m_sink;
+static bool m_transferRunning;
+
+static void StartTransfer(const uint32_t* words, uint16_t count)
+{
+    m_sink += words[0] + count;
+    m_transferRunning = true;
+}
+
+static const DebugGpio_Config_t m_config =
+{
+    .pins = { 0, 1, 2 },
+    .encoding = DEBUG_GPIO_MANCHESTER,
+    .startTransfer = StartTransfer,
+};
+
+static uint64_t NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Cost of the timing itself over BENCH_ITERATIONS, subtracted from every result */
+static uint64_t CalibrateNs(void)
+{
+    uint64_t elapsed = 0;
+
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; ++i)
+    {
+        const uint64_t start = NowNs();
+        elapsed += NowNs() - start;
+    }
+    return elapsed;
+}
+
+static void Report(const char* name, uint64_t elapsed, uint64_t overhead)
+{
+    const double ns = (elapsed > overhead) ? (double)(elapsed - overhead) / BENCH_ITERATIONS : 0.0;
+    printf("%-40s %8.1f ns/op\r\n", name, ns);
+}
+
+/* Drains the queue as the DMA interrupts would */
+static void CompleteTransfers(void)
+{
+    while (m_transferRunning)
+    {
+        m_transferRunning = false;
+        DebugGpio_OnTransferComplete();
+    }
+}
+
+static void BenchPutBusy(uint64_t overhead)
+{
+    uint64_t elapsed = 0;
+
+    DebugGpio_Init(&m_config);
+    DebugGpio_Put(0, 0);        /* Transfer running from now on */
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; ++i)
+    {
+        const uint64_t start = NowNs();
+        DebugGpio_Put(i % DEBUG_GPIO_NUM_LINES, (uint8_t)i);
+        elapsed += NowNs() - start;
+        if ((i % (DEBUG_GPIO_QUEUE_SIZE / 2)) == 0)
+        {
+            /* Keep the queue from filling up, one frame stays in flight */
+            m_transferRunning = false;
+            DebugGpio_OnTransferComplete();
+        }
+    }
+    CompleteTransfers();
+    Report("DebugGpio_Put, transfer running", elapsed, overhead);
+}
+
+static void BenchPutIdle(uint64_t overhead)
+{
+    uint64_t elapsed = 0;
+
+    DebugGpio_Init(&m_config);
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; ++i)
+    {
+        const uint64_t start = NowNs();
+        DebugGpio_Put(i % DEBUG_GPIO_NUM_LINES, (uint8_t)i);
+        elapsed += NowNs() - start;
+        CompleteTransfers();
+    }
+    Report("DebugGpio_Put, idle (starts a frame)", elapsed, overhead);
+}
+
+int main (int argc, char* argv[])
+{
+    const uint64_t overhead = CalibrateNs();
+    (void)argc;
+    (void)argv;
+
+    BenchPutBusy(overhead);
+    BenchPutIdle(overhead);
+    printf("%-40s %8lu\r\n", "Dropped", (unsigned long)DebugGpio_GetDropCount());
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include "assertion.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <string.h>
+#include "debug-gpio.h"
+
+#define QUEUE_MASK          (DEBUG_GPIO_QUEUE_SIZE - 1)
+#define IDLE_SLOTS          2
+
+/* Queued byte: line and value, the valid bit tells a written slot from a reserved one */
+#define RECORD_VALID        0x8000u
+#define RECORD(line, value) (uint16_t)(RECORD_VALID | ((uint16_t)(line) << 8) | (value))
+#define RECORD_LINE(record) (((record) >> 8) & 0x03)
+
+#if (DEBUG_GPIO_QUEUE_SIZE & QUEUE_MASK) != 0
+#error "DEBUG_GPIO_QUEUE_SIZE must be a power of two"
+#endif
+
+static const DebugGpio_Config_t* m_config;
+static uint32_t m_setBits[DEBUG_GPIO_NUM_LINES];
+static uint32_t m_resetBits[DEBUG_GPIO_NUM_LINES];
+
+/* Producers reserve a slot by moving the head, then write it. The consumer (whoever holds m_busy)
+ * clears the slots it takes before moving the tail past them. */
+static _Atomic uint16_t m_records[DEBUG_GPIO_QUEUE_SIZE];
+static _Atomic uint32_t m_head;
+static _Atomic uint32_t m_tail;
+static _Atomic bool m_busy;             /* Transfer running or being started */
+static _Atomic uint32_t m_dropCount;
+
+static uint32_t m_frame[DEBUG_GPIO_FRAME_SLOTS];
+
+/* Slots of one bit, PWM or Manchester */
+static uint8_t SlotsPerBit(void)
+{
+    return (m_config->encoding == DEBUG_GPIO_PWM) ? 3 : 2;
+}
+
+/* Levels of the slots of a bit, slot n in bit n */
+static uint8_t BitSlots(bool bit)
+{
+    if (m_config->encoding == DEBUG_GPIO_PWM)
+    {
+        return bit ? 0x03 : 0x01;       /* high-high-low, high-low-low */
+    }
+    return bit ? 0x01 : 0x02;           /* high-low, low-high */
+}
+
+static void EncodeByte(uint8_t line, uint8_t value)
+{
+    const uint8_t slotsPerBit = SlotsPerBit();
+    uint32_t* word = m_frame;
+
+    for (uint8_t b = 8; b-- > 0;)
+    {
+        const uint8_t slots = BitSlots((value >> b) & 1);
+        for (uint8_t s = 0; s < slotsPerBit; s++)
+        {
+            *word++ |= ((slots >> s) & 1) ? m_setBits[line] : m_resetBits[line];
+        }
+    }
+    for (uint8_t s = 0; s < IDLE_SLOTS; s++)
+    {
+        *word++ |= m_resetBits[line];
+    }
+}
+
+/* Encodes the next queued byte of each line, in queue order. Returns the number of words. */
+static uint16_t EncodeFrame(void)
+{
+    uint32_t tail = atomic_load_explicit(&m_tail, memory_order_relaxed);
+    uint8_t lines = 0;
+
+    memset(m_frame, 0, sizeof(m_frame));
+    for (;;)
+    {
+        _Atomic uint16_t* const slot = &m_records[tail & QUEUE_MASK];
+        const uint16_t record = atomic_load_explicit(slot, memory_order_acquire);
+        const uint8_t line = RECORD_LINE(record);
+
+        /* Not written yet, or a second byte for a line of this frame */
+        if (((record & RECORD_VALID) == 0) || (lines & (1u << line)))
+        {
+            break;
+        }
+        lines |= (uint8_t)(1u << line);
+        EncodeByte(line, (uint8_t)record);
+        atomic_store_explicit(slot, 0, memory_order_relaxed);
+        atomic_store_explicit(&m_tail, ++tail, memory_order_release);
+    }
+
+    return (lines == 0) ? 0 : (uint16_t)((8 * SlotsPerBit()) + IDLE_SLOTS);
+}
+
+static bool IsRecordReady(void)
+{
+    const uint32_t tail = atomic_load_explicit(&m_tail, memory_order_relaxed);
+
+    return (atomic_load_explicit(&m_records[tail & QUEUE_MASK], memory_order_acquire) & RECORD_VALID) != 0;
+}
+
+/* Runs with m_busy taken, releases it once there is nothing left to send */
+static void StartNextFrame(void)
+{
+    for (;;)
+    {
+        const uint16_t count = EncodeFrame();
+        if (count != 0)
+        {
+            (*(m_config->startTransfer))(m_frame, count);
+            return;
+        }
+
+        atomic_store_explicit(&m_busy, false, memory_order_release);
+        /* A byte written meanwhile saw m_busy taken, take it back for it */
+        if (!IsRecordReady() || atomic_exchange_explicit(&m_busy, true, memory_order_acquire))
+        {
+            return;
+        }
+    }
+}
+
+void DebugGpio_Init(const DebugGpio_Config_t* config)
+{
+    ASSERT(config != NULL);
+    ASSERT(config->startTransfer != NULL);
+
+    m_config = config;
+    for (uint8_t line = 0; line < DEBUG_GPIO_NUM_LINES; line++)
+    {
+        const uint8_t pin = config->pins[line];
+        ASSERT((pin < 16) || (pin == DEBUG_GPIO_NO_PIN));
+
+        m_setBits[line] = (pin == DEBUG_GPIO_NO_PIN) ? 0 : (1u << pin);
+        m_resetBits[line] = (pin == DEBUG_GPIO_NO_PIN) ? 0 : (1u << (pin + 16));
+    }
+    for (uint16_t i = 0; i < DEBUG_GPIO_QUEUE_SIZE; i++)
+    {
+        atomic_init(&m_records[i], 0);
+    }
+    atomic_init(&m_head, 0);
+    atomic_init(&m_tail, 0);
+    atomic_init(&m_busy, false);
+    atomic_init(&m_dropCount, 0);
+}
+
+bool DebugGpio_Put(uint8_t line, uint8_t value)
+{
+    ASSERT(line < DEBUG_GPIO_NUM_LINES);
+
+    uint32_t head = atomic_load_explicit(&m_head, memory_order_relaxed);
+
+    do
+    {
+        if ((head - atomic_load_explicit(&m_tail, memory_order_acquire)) >= DEBUG_GPIO_QUEUE_SIZE)
+        {
+            atomic_fetch_add_explicit(&m_dropCount, 1, memory_order_relaxed);
+            return false;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&m_head, &head, head + 1, memory_order_relaxed,
+                                                    memory_order_relaxed));
+
+    atomic_store_explicit(&m_records[head & QUEUE_MASK], RECORD(line, value), memory_order_release);
+    if (!atomic_exchange_explicit(&m_busy, true, memory_order_acquire))
+    {
+        StartNextFrame();
+    }
+    return true;
+}
+
+/* CONTEXT: Executes in the DMA interrupt context */
+void DebugGpio_OnTransferComplete(void)
+{
+    StartNextFrame();
+}
+
+uint32_t DebugGpio_GetDropCount(void)
+{
+    return atomic_load_explicit(&m_dropCount, memory_order_relaxed);
+}
@@ -0,0 +1,89 @@
+#ifndef DEBUG_GPIO_H
+#define DEBUG_GPIO_H
+
+/*
+ * Debug output of bytes over (up to) three GPIO lines of one port, PWM or Manchester encoded, for
+ * timing analysis with a logic analyzer.
+ *
+ * DebugGpio_Put() only stores the byte in a lock-free queue, so it can be called from any context,
+ * interrupts included. The bytes are encoded into a buffer of port set/reset (BSRR) words, one per
+ * slot, that the platform writes to the port with a DMA transfer paced by a timer: the CPU never
+ * waits on the line timing. Each frame carries one byte per line, the lines are independent.
+ *
+ *  - Manchester: 2 slots per bit, 1 is high-low and 0 is low-high
+ *  - PWM: 3 slots per bit, 1 is high-high-low and 0 is high-low-low
+ *
+ * Bits are sent MSB first and each byte is followed by 2 low slots.
+ *
+ * The event and digital-pattern modules have hooks to mark their activity, defined in AppDebugConfig.h:
+ *
+ *     #include "debug-gpio.h"
+ *     #define APP_EVENT_HOOK_DISPATCH_BEGIN(id)   DebugGpio_Put(0, 0x80 | (id))
+ *     #define APP_EVENT_HOOK_DISPATCH_END(id)     DebugGpio_Put(0, (id))
+ *     #define DIGITAL_PATTERN_HOOK_PHASE(pattern, phaseIndex, status) \
+ *                                                 DebugGpio_Put(1, (uint8_t)((((phaseIndex) + 1) << 2) | (status)))
+ *     #define DIGITAL_PATTERN_HOOK_NODE(matcher, node)    DebugGpio_Put(2, (node))
+ *
+ * The queue is built on C11 atomics (LDREX/STREX on Cortex-M3 and above). On single core parts only
+ * the producers preempting each other would need them, but the enqueue stays a few instructions.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DEBUG_GPIO_NUM_LINES        3
+#define DEBUG_GPIO_NO_PIN           0xFF
+
+/* Bytes waiting for the DMA, a power of two */
+#ifndef DEBUG_GPIO_QUEUE_SIZE
+#define DEBUG_GPIO_QUEUE_SIZE       64
+#endif
+
+typedef enum
+{
+    DEBUG_GPIO_MANCHESTER,
+    DEBUG_GPIO_PWM
+} DEBUG_GPIO_ENCODINGS;
+
+/* Port set/reset words of one frame: 8 bits of up to 3 slots, then the 2 idle slots */
+#define DEBUG_GPIO_FRAME_SLOTS      ((8 * 3) + 2)
+
+typedef struct
+{
+    uint8_t pins[DEBUG_GPIO_NUM_LINES];     /* Pin number (0-15) in the port of each line, or DEBUG_GPIO_NO_PIN */
+    DEBUG_GPIO_ENCODINGS encoding;
+    /* Starts the timer triggered DMA of @p count words to the port BSRR register, one word per slot.
+     * DebugGpio_OnTransferComplete() must be called once the last word is written. */
+    void (* startTransfer)(const uint32_t* words, uint16_t count);
+} DebugGpio_Config_t;
+
+/*
+ * @brief Initializes the module, the lines must already be outputs driven low
+ *
+ * @param config, lines and DMA transfer of the platform, kept by reference
+ */
+void DebugGpio_Init(const DebugGpio_Config_t* config);
+
+/*
+ * @brief Queues a byte for output on a line
+ *
+ * Lock-free, safe from any context. Starts the DMA if it is idle.
+ *
+ * @param line, line index, below DEBUG_GPIO_NUM_LINES
+ * @param value, byte to output
+ *
+ * @return false if the queue was full and the byte dropped
+ */
+bool DebugGpio_Put(uint8_t line, uint8_t value);
+
+/*
+ * @brief Hands the next frame to the DMA, to be called from the DMA transfer complete interrupt
+ */
+void DebugGpio_OnTransferComplete(void);
+
+/*
+ * @brief Returns the number of bytes dropped because the queue was full
+ */
+uint32_t DebugGpio_GetDropCount(void);
+
+#endif /* DEBUG_GPIO_H */
@@ -0,0 +1,182 @@
+/*
+TEST debug-gpio module
+Decodes the port set/reset words handed to the DMA back into bytes, as a logic analyzer would (make test).
+
+Random bytes are put on two of the three lines, from a producer racing the transfer complete
+interrupt, for both encodings. The port levels are replayed slot by slot from the set/reset words and
+each line is decoded on its own. Each result is one JSON object per line on stdout:
+
+    {"suite":"debug-gpio","test":"decode","encoding":"manchester","sent":[...],"decoded":[...],...}
+
+A failed check prints an "error" line and makes the suite exit with 1.
+*/
+#include "debug-gpio.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_PUTS               3000
+#define TEST_MAX_SLOTS          (TEST_PUTS * DEBUG_GPIO_FRAME_SLOTS)
+#define TEST_LINES              2
+
+#define CHECK(test, condition) \
+    do { if (!(condition)) { Fail((test), #condition, __LINE__); } } while (0)
+
+static const uint8_t m_pins[TEST_LINES] = { 3, 7 };
+
+static uint32_t m_words[TEST_MAX_SLOTS];
+static uint32_t m_numWords;
+static uint32_t m_frameWords;           /* Words of every transfer */
+static bool m_transferRunning;
+static bool m_overlap;
+static uint8_t m_sent[TEST_LINES][TEST_PUTS];
+static uint8_t m_decoded[TEST_LINES][TEST_PUTS];
+static uint32_t m_failures;
+
+static void Fail(const char* test, const char* condition, int line)
+{
+    printf("{\"suite\":\"debug-gpio\",\"test\":\"%s\",\"error\":\"%s\",\"line\":%d}\n", test, condition, line);
+    ++m_failures;
+}
+
+/* xorshift32, so that the bytes do not depend on the libc rand() */
+static uint32_t Random(uint32_t* state, uint32_t range)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x % range;
+}
+
+static void StartTransfer(const uint32_t* words, uint16_t count)
+{
+    m_overlap |= m_transferRunning;
+    if ((m_frameWords != 0) && (count != m_frameWords))
+    {
+        m_frameWords = 0xFFFF;
+    }
+    if (m_numWords + count <= TEST_MAX_SLOTS)
+    {
+        memcpy(&m_words[m_numWords], words, count * sizeof(words[0]));
+        m_numWords += count;
+    }
+    m_transferRunning = true;
+}
+
+static void CompleteTransfer(void)
+{
+    m_transferRunning = false;
+    DebugGpio_OnTransferComplete();
+}
+
+/* Replays the port levels of line @p pin and decodes its bytes, frames without a high slot carry none */
+static uint32_t Decode(uint8_t pin, uint8_t slotsPerBit, uint8_t* bytes)
+{
+    const uint32_t frameSlots = (8 * slotsPerBit) + 2;
+    uint32_t numBytes = 0;
+    bool level = false;
+
+    for (uint32_t frame = 0; frame + frameSlots <= m_numWords; frame += frameSlots)
+    {
+        bool levels[DEBUG_GPIO_FRAME_SLOTS];
+        bool high = false;
+
+        for (uint32_t slot = 0; slot < frameSlots; ++slot)
+        {
+            const uint32_t word = m_words[frame + slot];
+
+            level = (word & (1u << pin)) ? true : ((word & (1u << (pin + 16))) ? false : level);
+            levels[slot] = level;
+            high |= level;
+        }
+        if (!high)
+        {
+            continue;
+        }
+
+        uint8_t value = 0;
+        for (uint8_t bit = 0; bit < 8; ++bit)
+        {
+            /* Manchester 1 is high-low, PWM 1 is high-high-low */
+            const bool* const slots = &levels[bit * slotsPerBit];
+            value = (uint8_t)((value << 1) | ((slotsPerBit == 2) ? slots[0] : slots[1]));
+        }
+        if (levels[frameSlots - 2] || levels[frameSlots - 1])
+        {
+            /* Not followed by the idle slots, counted as a wrong byte */
+            value = (uint8_t)~value;
+        }
+        if (numBytes < TEST_PUTS)
+        {
+            bytes[numBytes] = value;
+        }
+        ++numBytes;
+    }
+    return numBytes;
+}
+
+static void TestDecode(DEBUG_GPIO_ENCODINGS encoding)
+{
+    const char* const name = (encoding == DEBUG_GPIO_PWM) ? "pwm" : "manchester";
+    const uint8_t slotsPerBit = (encoding == DEBUG_GPIO_PWM) ? 3 : 2;
+    const DebugGpio_Config_t config =
+    {
+        .pins = { m_pins[0], m_pins[1], DEBUG_GPIO_NO_PIN },
+        .encoding = encoding,
+        .startTransfer = StartTransfer,
+    };
+    uint32_t numSent[TEST_LINES] = { 0 };
+    uint32_t numDecoded[TEST_LINES];
+    uint32_t random = 1 + encoding;
+
+    m_numWords = 0;
+    m_frameWords = (8 * slotsPerBit) + 2;
+    m_transferRunning = false;
+    m_overlap = false;
+    DebugGpio_Init(&config);
+
+    for (uint32_t i = 0; i < TEST_PUTS; ++i)
+    {
+        const uint8_t line = (uint8_t)Random(&random, TEST_LINES);
+        const uint8_t value = (uint8_t)Random(&random, 256);
+
+        if (DebugGpio_Put(line, value))
+        {
+            m_sent[line][numSent[line]++] = value;
+        }
+        if (m_transferRunning && (Random(&random, 3) == 0))
+        {
+            CompleteTransfer();
+        }
+    }
+    while (m_transferRunning)
+    {
+        CompleteTransfer();
+    }
+
+    CHECK("decode", !m_overlap);
+    CHECK("decode", m_frameWords == (8u * slotsPerBit) + 2);
+    for (uint8_t line = 0; line < TEST_LINES; ++line)
+    {
+        numDecoded[line] = Decode(m_pins[line], slotsPerBit, m_decoded[line]);
+        CHECK("decode", numDecoded[line] == numSent[line]);
+        CHECK("decode", memcmp(m_decoded[line], m_sent[line], numSent[line]) == 0);
+    }
+    printf("{\"suite\":\"debug-gpio\",\"test\":\"decode\",\"encoding\":\"%s\",\"sent\":[%lu,%lu],"
+           "\"decoded\":[%lu,%lu],\"drops\":%lu}\n", name, (unsigned long)numSent[0], (unsigned long)numSent[1],
+           (unsigned long)numDecoded[0], (unsigned long)numDecoded[1], (unsigned long)DebugGpio_GetDropCount());
+}
+
+int main (int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    TestDecode(DEBUG_GPIO_MANCHESTER);
+    TestDecode(DEBUG_GPIO_PWM);
+
+    printf("{\"suite\":\"debug-gpio\",\"failures\":%lu}\n", (unsigned long)m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
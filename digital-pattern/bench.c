@@ -0,0 +1,188 @@
+/*
+BENCH digital-pattern module
+Reports ns/edge of the compiled pattern matcher over a recorded edge stream, and ns/tick of a
+pattern bank from 1 to 32 channels (make bench).
+*/
+#define _POSIX_C_SOURCE 199309L
+#include "digital-pattern.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_EDGES         1000000
+#define BENCH_MATCHES       1024
+#define BENCH_NODES         16
+#define BENCH_TICKS         100000
+
+static PatternEdge_t m_edges[BENCH_EDGES];
+static PatternMatch_t m_matches[BENCH_MATCHES];
+static PatternNode_t m_nodes[BENCH_NODES];
+static uint32_t m_patternStorage[PATTERN_ARENA_WORDS(2, 3, 1) + (2 * BENCH_NODES)];
+static uint32_t m_levels[BENCH_TICKS];
+
+static uint64_t NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void Report(const char* name, uint64_t elapsed, uint32_t numMatches)
+{
+    const double ns = (double)elapsed / BENCH_EDGES;
+    printf("%-40s %8.1f ns/edge %8.1f Medges/s (%lu matches)\r\n", name, ns, 1000.0 / ns,
+           (unsigned long)numMatches);
+}
+
+/* Button presses of 20 to 1500 ms, 1 to 3 in a row, with contact bounce on some of the edges */
+static TimerTime_t RecordStream(void)
+{
+    TimerTime_t time = 0;
+    uint32_t i = 0;
+
+    srand(1);
+    while (i < BENCH_EDGES)
+    {
+        const bool low = (i & 1) == 0;
+        time += low ? (50 + rand() % 2000) : (20 + rand() % 1500);
+        m_edges[i].timestamp = time;
+        m_edges[i].state = low ? INPUT_LOW : INPUT_HIGH;
+        ++i;
+        for (uint8_t bounce = rand() % 4; (bounce > 1) && (i + 1 < BENCH_EDGES); --bounce)
+        {
+            m_edges[i] = m_edges[i - 1];
+            m_edges[i].state = low ? INPUT_HIGH : INPUT_LOW;
+            m_edges[i + 1] = m_edges[i - 1];
+            m_edges[i].timestamp = ++time;
+            m_edges[i + 1].timestamp = ++time;
+            i += 2;
+        }
+    }
+    return time;
+}
+
+static void BenchScan(const char* name, TimerTime_t end)
+{
+    const uint64_t start = NowNs();
+    const uint32_t numMatches = DigitalPattern_Scan(m_nodes, m_edges, BENCH_EDGES, end, m_matches, BENCH_MATCHES);
+    Report(name, NowNs() - start, numMatches);
+}
+
+/* Reference: one PatternMatcher_Edge() call per edge, as a live input would */
+static void BenchEdgeByEdge(const char* name)
+{
+    PatternMatcher_t matcher;
+    uint32_t numMatches = 0;
+
+    PatternMatcher_Init(&matcher, m_nodes);
+    const uint64_t start = NowNs();
+    for (uint32_t i = 0; i < BENCH_EDGES; ++i)
+    {
+        PatternMatcher_Edge(&matcher, m_edges[i].state, m_edges[i].timestamp);
+        numMatches += PatternMatcher_Check(&matcher);
+    }
+    Report(name, NowNs() - start, numMatches);
+}
+
+/* Debounce stage ahead of the matcher: the bounce edges of the stream never reach it */
+static void BenchDebounce(void)
+{
+    PatternDebounce_t debounce;
+    PatternEdge_t stable;
+    uint32_t numStable = 0;
+
+    PatternDebounce_Init(&debounce, 5, INPUT_HIGH);
+    const uint64_t start = NowNs();
+    for (uint32_t i = 0; i < BENCH_EDGES; ++i)
+    {
+        numStable += PatternDebounce_Edge(&debounce, m_edges[i].state, m_edges[i].timestamp, &stable);
+    }
+    const double ns = (double)(NowNs() - start) / BENCH_EDGES;
+    printf("%-40s %8.1f ns/edge %8lu of %u edges passed on\r\n", "PatternDebounce_Edge, 5 ms", ns,
+           (unsigned long)numStable, BENCH_EDGES);
+}
+
+/* Input levels of 32 buttons sampled every 10 ms, each changing on about 1 tick in 32 */
+static void RecordLevels(void)
+{
+    uint32_t levels = 0xFFFFFFFFu;
+
+    srand(2);
+    for (uint32_t i = 0; i < BENCH_TICKS; ++i)
+    {
+        for (uint8_t channel = 0; channel < PATTERN_BANK_CHANNELS_MAX; ++channel)
+        {
+            if ((rand() % 32) == 0)
+            {
+                levels ^= 1u << channel;
+            }
+        }
+        m_levels[i] = levels;
+    }
+}
+
+static void BenchBank(PatternArena_t* arena, uint8_t numNodes, uint8_t numChannels)
+{
+    char name[48];
+    DigitalPatternBank_t bank;
+    const uint32_t channelMask = (numChannels < 32) ? ((1u << numChannels) - 1) : 0xFFFFFFFFu;
+    const size_t used = arena->used;
+    uint32_t numMatches = 0;
+
+    DigitalPatternBank_Init(&bank, m_nodes, numNodes, arena, 10, channelMask, NULL, NULL);
+    const uint64_t start = NowNs();
+    for (uint32_t i = 0; i < BENCH_TICKS; ++i)
+    {
+        DigitalPatternBank_Sample(&bank, m_levels[i]);
+        numMatches += __builtin_popcount(DigitalPatternBank_Check(&bank));
+    }
+    const uint64_t elapsed = NowNs() - start;
+    arena->used = used;     /* The next bank reuses the node masks */
+
+    snprintf(name, sizeof(name), "DigitalPatternBank, %u channels", numChannels);
+    printf("%-40s %8.1f ns/tick %8.1f ns/channel (%lu matches)\r\n", name, (double)elapsed / BENCH_TICKS,
+           (double)elapsed / BENCH_TICKS / numChannels, (unsigned long)numMatches);
+}
+
+int main (int argc, char* argv[])
+{
+    Gpio_t pin = { 0 };
+    PatternArena_t arena;
+    DigitalPattern_t doublePress;
+    DigitalPattern_t longPress;
+    const TimerTime_t end = RecordStream();
+    (void)argc;
+    (void)argv;
+
+    PatternArena_Init(&arena, m_patternStorage, sizeof(m_patternStorage));
+
+    /* Double press: two presses within 700 ms, then 400 ms without input */
+    DigitalPattern_Init(&doublePress, &pin, &arena, 2);
+    PatternPhase_t* presses = DigitalPattern_AddPhase(&doublePress, 700, false);
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        DigitalPattern_AddState(presses, INPUT_LOW);
+        DigitalPattern_AddState(presses, INPUT_HIGH);
+    }
+    DigitalPattern_AddPhase(&doublePress, 400, true);
+    DigitalPattern_Compile(&doublePress, m_nodes, BENCH_NODES);
+    BenchScan("DigitalPattern_Scan, double press", end);
+    BenchEdgeByEdge("PatternMatcher_Edge, double press");
+
+    /* Long press: held for at least 800 ms */
+    DigitalPattern_Init(&longPress, &pin, &arena, 1);
+    PatternPhase_t* hold = DigitalPattern_AddTimedPhase(&longPress, 0, 1);
+    DigitalPattern_AddTimedState(hold, INPUT_LOW, 800, PATTERN_DURATION_ANY);
+    const uint8_t numNodes = DigitalPattern_Compile(&longPress, m_nodes, BENCH_NODES);
+    BenchScan("DigitalPattern_Scan, long press", end);
+    BenchEdgeByEdge("PatternMatcher_Edge, long press");
+
+    BenchDebounce();
+
+    RecordLevels();
+    BenchBank(&arena, numNodes, 1);
+    BenchBank(&arena, numNodes, 8);
+    BenchBank(&arena, numNodes, 32);
+
+    return 0;
+}
@@ -1,31 +1,117 @@
+#include "AppDebugConfig.h"
+
+#define LOG_LEVEL        DEBUG_DIGITAL_PATTERN
+
 #include "assertion.h"
 #include <stddef.h>
+#include <string.h>
 #include "digital-pattern.h"
 
-#include "AppDebugConfig.h"
 #include "SerialConsole.h"
+#include "log.h"
+#include "timer-time.h"
+#include "utilities.h"
+#ifdef DIGITAL_PATTERN_TRACE
+#include "trace.h"
+#endif
+
+/* Log message codes, see FormatLogRecord(). The record id is the phase index. */
+typedef enum
+{
+    PATTERN_LOG_RESET,
+    PATTERN_LOG_COMPLETE,
+    PATTERN_LOG_PHASE_START,
+    PATTERN_LOG_NEXT_PHASE,         /* arg: phase duration */
+    PATTERN_LOG_PHASE_FAILURE,
+    PATTERN_LOG_INVALID_INPUT,
+    PATTERN_LOG_PROGRESS,           /* arg: see LogProgress() */
+    PATTERN_LOG_CAPTURE_OVERFLOW,   /* arg: edges dropped so far */
+} PATTERN_LOG_CODES;
+
+/* Keeps the compiler from moving the edge store past the ring buffer index update */
+#define COMPILER_BARRIER()  __asm volatile ("" ::: "memory")
+
+#define MAX_CAPTURE_SIZE    128
 
-const char* phasePrintTable[] = 
+/* Called on each phase change with the phase index (-1 once the pattern is reset) and its PHASE_STATE,
+ * and on each node change of a matcher, e.g. to output them on a debug gpio line. Defined in
+ * AppDebugConfig.h, see debug-gpio.h. */
+#ifndef DIGITAL_PATTERN_HOOK_PHASE
+#define DIGITAL_PATTERN_HOOK_PHASE(pattern, phaseIndex, status)     ((void)0)
+#endif
+#ifndef DIGITAL_PATTERN_HOOK_NODE
+#define DIGITAL_PATTERN_HOOK_NODE(matcher, node)                    ((void)0)
+#endif
+
+/* Trace points, compiled in with DIGITAL_PATTERN_TRACE, see trace.h */
+#ifdef DIGITAL_PATTERN_TRACE
+#define PATTERN_TRACE(code, id, arg)    Trace_Write((code), (uint8_t)(id), (uint16_t)(arg))
+#else
+#define PATTERN_TRACE(code, id, arg)    ((void)0)
+#endif
+
+#if LOG_LEVEL > LOG_LEVEL_NONE
+static void FormatLogRecord(const Log_Record_t* record)
 {
-    "Idle",
-    "In Progress",
-    "Complete",
-    "Invalid"
-};
+    static const char* const phasePrintTable[] =
+    {
+        "Idle",
+        "In Progress",
+        "Complete",
+        "Invalid"
+    };
+
+    switch (record->code)
+    {
+        case PATTERN_LOG_RESET:
+            PRINTF("Resetting Pattern\r\n");
+            break;
+        case PATTERN_LOG_COMPLETE:
+            PRINTF("Pattern Complete\r\n");
+            break;
+        case PATTERN_LOG_PHASE_START:
+            PRINTF("Starting Phase %u\r\n", record->id + 1);
+            break;
+        case PATTERN_LOG_NEXT_PHASE:
+            PRINTF("Next phase of %lu ms starting\r\n", (unsigned long)record->arg);
+            break;
+        case PATTERN_LOG_PHASE_FAILURE:
+            PRINTF("Phase %u Failure\r\n", record->id + 1);
+            break;
+        case PATTERN_LOG_INVALID_INPUT:
+            PRINTF("Additional invalid input detected in phase %u\r\n", record->id + 1);
+            break;
+        case PATTERN_LOG_PROGRESS:
+            PRINTF("Pattern phase %u of %lu: %s, state %d of %lu\r\n", record->id + 1, (unsigned long)(record->arg >> 24),
+                   phasePrintTable[(record->arg >> 16) & 0x03], (int8_t)(record->arg >> 8),
+                   (unsigned long)(record->arg & 0xFF));
+            break;
+        case PATTERN_LOG_CAPTURE_OVERFLOW:
+            PRINTF("Edge capture overflow, %lu edges dropped\r\n", (unsigned long)record->arg);
+            break;
+        default:
+            PRINTF("Pattern code %u arg %lu\r\n", record->code, (unsigned long)record->arg);
+            break;
+    }
+}
+#endif
 
-static void PrintDiagnostics(DigitalPattern_t* pattern)
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+static void LogProgress(DigitalPattern_t* pattern)
 {
     if (pattern->phaseIndex != -1)
     {
-        PatternPhase currentPhase = pattern->phases[pattern->phaseIndex];
-        DEBUG_PRINTF("Pattern phase %d of %d:\r\n", pattern->phaseIndex + 1, pattern->numPhases);
-        DEBUG_PRINTF("\tTime left in phase: %lu\r\n", TimerTimeRemaining( &pattern->phaseTimer ));
-        DEBUG_PRINTF("\tStatus: %s\r\n", phasePrintTable[(uint8_t)currentPhase.phaseStatus] );
-        DEBUG_PRINTF("\tState %d of %d\r\n", currentPhase.stateIndex, currentPhase.numStates);
+        const PatternPhase_t* currentPhase = &pattern->phases[pattern->phaseIndex];
+        const uint32_t progress = ((uint32_t)pattern->numPhases << 24) | ((uint32_t)currentPhase->phaseStatus << 16) |
+                                  ((uint32_t)(uint8_t)currentPhase->stateIndex << 8) | currentPhase->numStates;
+        LOG_DEBUG(LOG_MODULE_DIGITAL_PATTERN, (uint8_t)pattern->phaseIndex, PATTERN_LOG_PROGRESS, progress);
     }
 }
+#else
+#define LogProgress(pattern)    ((void)0)
+#endif
 
-static InputState CheckInputState(Gpio_t* inputPin)
+static INPUT_STATE CheckInputState(Gpio_t* inputPin)
 {
     if (!GpioRead( inputPin ))
         return INPUT_LOW;
@@ -33,27 +119,66 @@ static InputState CheckInputState(Gpio_t* inputPin)
         return INPUT_HIGH;
 }
 
-static void ResetPatternStruct(DigitalPattern* pattern)
+static INPUT_STATE PhaseState(const PatternPhase_t* phase, uint8_t index)
+{
+    return (INPUT_STATE)((phase->states >> index) & 1);
+}
+
+static void Notify(DigitalPattern_t* pattern)
+{
+    if (pattern->notify != NULL)
+    {
+        (*(pattern->notify))(pattern->notifyContext);
+    }
+}
+
+/* Patterns of a DigitalPatternSet_t only keep their deadline, the set owns the timer */
+static void StopPhaseTimer(DigitalPattern_t* pattern)
+{
+    if (!pattern->timerShared)
+    {
+        TimerStop( &pattern->phaseTimer );
+    }
+}
+
+static void ResetPatternStruct(DigitalPattern_t* pattern)
 {
     ASSERT(pattern != NULL);
     for (uint8_t i = 0; i < pattern->numPhases; i++)
     {
-        PatternPhase *idxPhase = &pattern->phases[i];
+        PatternPhase_t *idxPhase = &pattern->phases[i];
         idxPhase->phaseStatus = PHASE_IDLE;
         idxPhase->stateIndex = -1;
-        TimerStop( &pattern->phaseTimer );
     }
-    DEBUG_PRINTF("Resetting Pattern\r\n");
+    StopPhaseTimer(pattern);
+    LOG_DEBUG(LOG_MODULE_DIGITAL_PATTERN, (uint8_t)pattern->phaseIndex, PATTERN_LOG_RESET, 0);
     pattern->patternComplete = false;
+    pattern->phaseRunning = false;
     pattern->phaseIndex = -1;
+    DIGITAL_PATTERN_HOOK_PHASE(pattern, -1, PHASE_IDLE);
+    PATTERN_TRACE(TRACE_PATTERN_PHASE, -1, PHASE_IDLE);
 }
 
-static void OnPhaseTimerEvent(void* context)
+/* Starts the active phase at @p start. In edge capture mode the timer is armed by
+ * DigitalPattern_Process() once it is done, see ArmCaptureTimer(). */
+static void StartPhase(DigitalPattern_t* pattern, TimerTime_t start, uint32_t duration)
 {
-    ASSERT(context != NULL);
-    DigitalPattern *pattern = (DigitalPattern *) context;
-    PatternPhase *activePhase = &pattern->phases[pattern->phaseIndex];
+    pattern->phaseDeadline = start + duration;
+    pattern->phaseRunning = true;
+    if (pattern->timerShared || (pattern->edges != NULL))
+    {
+        return;
+    }
+    TimerSetValue( &pattern->phaseTimer, duration );
+    TimerStartWithParam( &pattern->phaseTimer, pattern );
+}
+
+/* Ends the active phase at @p time, either moving on to the next phase or completing/resetting the pattern */
+static void EndPhase(DigitalPattern_t* pattern, TimerTime_t time)
+{
+    PatternPhase_t *activePhase = &pattern->phases[pattern->phaseIndex];
 
+    pattern->phaseRunning = false;
     if (activePhase->phaseStatus == PHASE_COMPLETE
             || activePhase->numStates == 0)            //Phase has no states (phase does not need to see any edges)
     {
@@ -64,60 +189,88 @@ static void OnPhaseTimerEvent(void* context)
         else if (pattern->phaseIndex == pattern->numPhases -1)
         {
             pattern->patternComplete = true;
-            DEBUG_PRINTF("Pattern Complete\r\n");
+            LOG_DEBUG(LOG_MODULE_DIGITAL_PATTERN, (uint8_t)pattern->phaseIndex, PATTERN_LOG_COMPLETE, 0);
         }
         else
         {
             pattern->phaseIndex++;
-            PatternPhase *nextPhase = &pattern->phases[pattern->phaseIndex];
-            DEBUG_PRINTF("Next phase of %lu ms starting\r\n", nextPhase->phaseDuration);
-            TimerSetValue( &pattern->phaseTimer, nextPhase->phaseDuration );
-            TimerStartWithParam( &pattern->phaseTimer, pattern );
+            PatternPhase_t *nextPhase = &pattern->phases[pattern->phaseIndex];
+            DIGITAL_PATTERN_HOOK_PHASE(pattern, pattern->phaseIndex, nextPhase->phaseStatus);
+            PATTERN_TRACE(TRACE_PATTERN_PHASE, pattern->phaseIndex, nextPhase->phaseStatus);
+            LOG_DEBUG(LOG_MODULE_DIGITAL_PATTERN, (uint8_t)pattern->phaseIndex, PATTERN_LOG_NEXT_PHASE,
+                      nextPhase->phaseDuration);
+            StartPhase(pattern, time, nextPhase->phaseDuration);
         }
     }
     else
     {
         /* Phase was not completed successfully, reset pattern*/
-        DEBUG_PRINTF("Phase Failure, ");
+        LOG_DEBUG(LOG_MODULE_DIGITAL_PATTERN, (uint8_t)pattern->phaseIndex, PATTERN_LOG_PHASE_FAILURE, 0);
         ResetPatternStruct( pattern );
     }
 }
 
-void OnDigitalPatternEvent(DigitalPattern_t* pattern)
+/* Ends every phase whose deadline is reached at @p time */
+static void ExpirePhases(DigitalPattern_t* pattern, TimerTime_t time)
+{
+    while (pattern->phaseRunning && !TimerTime_IsBefore(time, pattern->phaseDeadline))
+    {
+        EndPhase(pattern, pattern->phaseDeadline);
+    }
+}
+
+static void OnPhaseTimerEvent(void* context)
+{
+    ASSERT(context != NULL);
+    DigitalPattern_t *pattern = (DigitalPattern_t *) context;
+
+    if (pattern->edges != NULL)
+    {
+        Notify(pattern);    /* The deadline is evaluated by DigitalPattern_Process() */
+        return;
+    }
+    EndPhase(pattern, pattern->phaseDeadline);
+}
+
+/* Advances the matcher with the input @p state seen at @p time */
+static void StepPattern(DigitalPattern_t* pattern, INPUT_STATE state, TimerTime_t time)
 {
-    ASSERT(pattern != NULL);
     if (pattern->phaseIndex == -1)
        pattern->phaseIndex = 0;  //Pattern has started
 
-    PatternPhase *activePhase = &pattern->phases[pattern->phaseIndex];
+    PatternPhase_t *activePhase = &pattern->phases[pattern->phaseIndex];
+    ASSERT(!activePhase->timed);    /* Timed phases need DigitalPattern_Compile() */
     if (activePhase->phaseStatus == PHASE_IDLE)
     {
-       DEBUG_PRINTF("Starting Phase\r\n");
+       LOG_DEBUG(LOG_MODULE_DIGITAL_PATTERN, (uint8_t)pattern->phaseIndex, PATTERN_LOG_PHASE_START, 0);
        activePhase->stateIndex = 0;
        activePhase->phaseStatus = PHASE_INPROGRESS;
+       DIGITAL_PATTERN_HOOK_PHASE(pattern, pattern->phaseIndex, PHASE_INPROGRESS);
+       PATTERN_TRACE(TRACE_PATTERN_PHASE, pattern->phaseIndex, PHASE_INPROGRESS);
        if (pattern->phaseIndex == 0)
        {
            /* Start timer if active phase is the first phase
             * Note: Phase timers for subsequent phases are started
-            * on the timer callback */
-           TimerSetValue( &pattern->phaseTimer, activePhase->phaseDuration );
-           TimerStartWithParam( &pattern->phaseTimer, pattern );
+            * when the previous phase ends */
+           StartPhase(pattern, time, activePhase->phaseDuration);
        }
     }
 
     if (activePhase->phaseStatus == PHASE_INPROGRESS)
     {
-        if (CheckInputState(pattern->inputPin) == activePhase->states[activePhase->stateIndex])
+        if ((activePhase->stateIndex < activePhase->numStates)
+                && (state == PhaseState(activePhase, (uint8_t)activePhase->stateIndex)))
            activePhase->stateIndex++;
 
         if (activePhase->stateIndex == activePhase->numStates)
         {
             activePhase->phaseStatus = PHASE_COMPLETE;
+            DIGITAL_PATTERN_HOOK_PHASE(pattern, pattern->phaseIndex, PHASE_COMPLETE);
+            PATTERN_TRACE(TRACE_PATTERN_PHASE, pattern->phaseIndex, PHASE_COMPLETE);
             if (!activePhase->fixedDuration)
             {
-                TimerStop(&pattern->phaseTimer);
-                /* Call timer callback */
-                OnPhaseTimerEvent(pattern);
+                StopPhaseTimer(pattern);
+                EndPhase(pattern, time);
             }
         }
     }
@@ -126,59 +279,115 @@ void OnDigitalPatternEvent(DigitalPattern_t* pattern)
         if (activePhase->phaseStatus == PHASE_COMPLETE)
         {
             /* additional input activity invalidates phase, reset pattern */
-            DEBUG_PRINTF("Additional invalid input detected: ");
+            LOG_DEBUG(LOG_MODULE_DIGITAL_PATTERN, (uint8_t)pattern->phaseIndex, PATTERN_LOG_INVALID_INPUT, 0);
             ResetPatternStruct(pattern);
         }
     }
-    PrintDiagnostics(pattern);
+    LogProgress(pattern);
 }
 
-DigitalPattern DigitalPattern_Init(Gpio_t *inputPin)
+void OnDigitalPatternEvent(DigitalPattern_t* pattern)
 {
-    ASSERT(inputPin != NULL);
+    ASSERT(pattern != NULL);
+    ASSERT(pattern->edges == NULL);     /* Use DigitalPattern_CaptureEdge() in edge capture mode */
 
-    DigitalPattern digPattern;
-    TimerEvent_t phaseTimer = {};   //initialize empty struct
+    StepPattern(pattern, CheckInputState(pattern->inputPin), TimerGetCurrentTime());
+}
 
-    digPattern.inputPin = inputPin;
-    digPattern.numPhases = 0;
-    digPattern.phaseIndex = -1;
-    digPattern.patternComplete = false;
-    digPattern.phaseTimer = phaseTimer;
+/* Returns @p size bytes of @p arena at the alignment of @p align */
+static void* ArenaAlloc(PatternArena_t* arena, size_t size, size_t align)
+{
+    const uintptr_t base = (uintptr_t)arena->buffer;
+    const size_t offset = (size_t)(((base + arena->used + align - 1) & ~(uintptr_t)(align - 1)) - base);
 
-    TimerInit(&digPattern.phaseTimer, OnPhaseTimerEvent);
+    ASSERT(offset + size <= arena->size);   /* See PATTERN_ARENA_SIZE() */
 
-    return digPattern;
+    arena->used = offset + size;
+    return &arena->buffer[offset];
 }
 
-PatternPhase DigitalPattern_CreatePhase(uint32_t timerVal, bool fixedDuration)
+void PatternArena_Init(PatternArena_t* arena, void* buffer, size_t size)
 {
-    PatternPhase phase;
+    ASSERT(arena != NULL);
+    ASSERT(buffer != NULL);
 
-    phase.phaseDuration = timerVal;
-    phase.numStates = 0;
-    phase.stateIndex = -1; //pattern is idle
-    phase.phaseStatus = PHASE_IDLE;
-    phase.fixedDuration = fixedDuration;
+    arena->buffer = (uint8_t*)buffer;
+    arena->size = size;
+    arena->used = 0;
+}
 
-    return phase;
+void DigitalPattern_Init(DigitalPattern_t* pattern, Gpio_t* inputPin, PatternArena_t* arena, uint8_t maxPhases)
+{
+    ASSERT(pattern != NULL);
+    ASSERT(inputPin != NULL);
+    ASSERT(arena != NULL);
+    ASSERT(maxPhases > 0);
+
+    memset(pattern, 0, sizeof(*pattern));
+    pattern->inputPin = inputPin;
+    pattern->arena = arena;
+    pattern->phases = ArenaAlloc(arena, maxPhases * sizeof(PatternPhase_t), _Alignof(PatternPhase_t));
+    pattern->maxPhases = maxPhases;
+    pattern->numPhases = 0;
+    pattern->phaseIndex = -1;
+    pattern->patternComplete = false;
+
+    TimerInit(&pattern->phaseTimer, OnPhaseTimerEvent);
+    LOG_SET_FORMATTER(LOG_MODULE_DIGITAL_PATTERN, FormatLogRecord);
 }
 
-void DigitalPattern_AddPhase(DigitalPattern_t* pattern, PatternPhase phase)
+PatternPhase_t* DigitalPattern_AddPhase(DigitalPattern_t* pattern, uint32_t duration, bool fixedDuration)
 {
     ASSERT(pattern != NULL);
-    ASSERT( pattern->numPhases < MAX_PHASES );
+    ASSERT(pattern->numPhases < pattern->maxPhases);
 
-    pattern->phases[pattern->numPhases] = phase;
+    PatternPhase_t* const phase = &pattern->phases[pattern->numPhases];
+
+    memset(phase, 0, sizeof(*phase));
+    phase->phaseDuration = duration;
+    phase->stateIndex = -1; //pattern is idle
+    phase->phaseStatus = PHASE_IDLE;
+    phase->fixedDuration = fixedDuration;
     pattern->numPhases++;
+
+    return phase;
+}
+
+PatternPhase_t* DigitalPattern_AddTimedPhase(DigitalPattern_t* pattern, uint32_t duration, uint8_t maxStates)
+{
+    ASSERT((maxStates > 0) && (maxStates <= PATTERN_STATES_MAX));
+
+    PatternPhase_t* const phase = DigitalPattern_AddPhase(pattern, duration, false);
+
+    phase->timed = true;
+    phase->maxStates = maxStates;
+    phase->holds = ArenaAlloc(pattern->arena, maxStates * sizeof(PatternHold_t), _Alignof(PatternHold_t));
+
+    return phase;
+}
+
+void DigitalPattern_AddState(PatternPhase_t* phase, INPUT_STATE state)
+{
+    ASSERT(phase != NULL);
+    ASSERT(phase->numStates < PATTERN_STATES_MAX);
+
+    ASSERT(!phase->timed);
+
+    phase->states |= (uint32_t)state << phase->numStates;
+    phase->numStates++;
 }
 
-void DigitalPattern_AddState(PatternPhase* phase, InputState state)
+void DigitalPattern_AddTimedState(PatternPhase_t* phase, INPUT_STATE state, uint16_t minDuration,
+                                  uint16_t maxDuration)
 {
     ASSERT(phase != NULL);
-    ASSERT(phase->numStates < MAX_STATES);
+    ASSERT(phase->timed);
+    ASSERT(phase->numStates < phase->maxStates);
+    ASSERT(minDuration <= maxDuration);
 
-    phase->states[phase->numStates] = state;
+    phase->states |= (uint32_t)state << phase->numStates;
+    phase->holds[phase->numStates].minDuration = minDuration;
+    phase->holds[phase->numStates].maxDuration = maxDuration;
     phase->numStates++;
 }
 
@@ -197,3 +406,1149 @@ bool DigitalPattern_Check(DigitalPattern_t* pattern)
     return patternDetected;
 }
 
+void DigitalPattern_EnableCapture(DigitalPattern_t* pattern, PatternEdge_t* buffer, uint8_t size,
+                                  void (* notify)(void* context), void* context)
+{
+    ASSERT(pattern != NULL);
+    ASSERT(buffer != NULL);
+    ASSERT((size > 0) && (size <= MAX_CAPTURE_SIZE) && ((size & (size - 1)) == 0));
+
+    ResetPatternStruct(pattern);
+    pattern->edges = buffer;
+    pattern->edgeMask = size - 1;
+    pattern->edgeHead = 0;
+    pattern->edgeTail = 0;
+    pattern->edgeOverflow = false;
+    pattern->dropCount = 0;
+    pattern->notify = notify;
+    pattern->notifyContext = context;
+}
+
+/* CONTEXT: Executes in interrupt context, the only writer of edgeHead */
+void DigitalPattern_CaptureEdge(DigitalPattern_t* pattern, INPUT_STATE state, TimerTime_t timestamp)
+{
+    ASSERT(pattern->edges != NULL);
+
+    const uint8_t head = pattern->edgeHead;
+
+    if ((uint8_t)(head - pattern->edgeTail) > pattern->edgeMask)
+    {
+        pattern->edgeOverflow = true;
+        ++pattern->dropCount;
+    }
+    else
+    {
+        PatternEdge_t* const edge = &pattern->edges[head & pattern->edgeMask];
+        edge->timestamp = timestamp;
+        edge->state = state;
+        COMPILER_BARRIER();
+        pattern->edgeHead = head + 1;
+    }
+    Notify(pattern);
+}
+
+void OnDigitalPatternEdge(void* context)
+{
+    ASSERT(context != NULL);
+    DigitalPattern_t *pattern = (DigitalPattern_t *) context;
+
+    DigitalPattern_CaptureEdge(pattern, CheckInputState(pattern->inputPin), TimerGetCurrentTime());
+}
+
+void DigitalPattern_EnableDebounce(DigitalPattern_t* pattern, uint32_t stableTime)
+{
+    ASSERT(pattern != NULL);
+    ASSERT(pattern->edges != NULL);
+
+    PatternDebounce_Init(&pattern->debounce, stableTime, CheckInputState(pattern->inputPin));
+    pattern->debounced = true;
+}
+
+/* Edge capture mode: only wakes up the main loop at the next deadline, the debounce one while a level
+ * is pending (the phases cannot move past its first edge until then), else the phase one */
+static void ArmCaptureTimer(DigitalPattern_t* pattern, TimerTime_t now)
+{
+    TimerTime_t deadline = pattern->phaseDeadline;
+    bool running = pattern->phaseRunning;
+    TimerTime_t stableDeadline;
+
+    if (pattern->debounced && PatternDebounce_GetDeadline(&pattern->debounce, &stableDeadline))
+    {
+        deadline = stableDeadline;
+        running = true;
+    }
+
+    TimerStop( &pattern->phaseTimer );
+    if (running && TimerTime_IsBefore(now, deadline))
+    {
+        TimerSetValue( &pattern->phaseTimer, deadline - now );
+        TimerStartWithParam( &pattern->phaseTimer, pattern );
+    }
+}
+
+/* Phases that ended before the edge are evaluated first, as their timer would have done */
+static void ProcessEdge(DigitalPattern_t* pattern, const PatternEdge_t* edge)
+{
+    ExpirePhases(pattern, edge->timestamp);
+    StepPattern(pattern, edge->state, edge->timestamp);
+}
+
+void DigitalPattern_Process(DigitalPattern_t* pattern)
+{
+    ASSERT(pattern != NULL);
+    ASSERT(pattern->edges != NULL);
+
+    PatternEdge_t stable;
+
+    if (pattern->edgeOverflow)
+    {
+        /* The edge sequence is broken, start over from the next edge */
+        LOG_WARN(LOG_MODULE_DIGITAL_PATTERN, (uint8_t)pattern->phaseIndex, PATTERN_LOG_CAPTURE_OVERFLOW,
+                 pattern->dropCount);
+        pattern->edgeTail = pattern->edgeHead;
+        pattern->edgeOverflow = false;
+        ResetPatternStruct(pattern);
+        if (pattern->debounced)
+        {
+            PatternDebounce_Init(&pattern->debounce, pattern->debounce.stableTime,
+                                 CheckInputState(pattern->inputPin));
+        }
+    }
+
+    uint8_t tail = pattern->edgeTail;
+    while (tail != pattern->edgeHead)
+    {
+        COMPILER_BARRIER();
+        const PatternEdge_t edge = pattern->edges[tail & pattern->edgeMask];
+        COMPILER_BARRIER();
+        pattern->edgeTail = ++tail;
+
+        if (!pattern->debounced)
+        {
+            ProcessEdge(pattern, &edge);
+        }
+        else if (PatternDebounce_Edge(&pattern->debounce, edge.state, edge.timestamp, &stable))
+        {
+            ProcessEdge(pattern, &stable);
+        }
+    }
+
+    const TimerTime_t now = TimerGetCurrentTime();
+    TimerTime_t end = now;
+    if (pattern->debounced)
+    {
+        if (PatternDebounce_Expire(&pattern->debounce, now, &stable))
+        {
+            ProcessEdge(pattern, &stable);
+        }
+        if (pattern->debounce.pending)
+        {
+            end = pattern->debounce.since;  /* The pending edge may still come first */
+        }
+    }
+    ExpirePhases(pattern, end);
+    ArmCaptureTimer(pattern, now);
+}
+
+void PatternDebounce_Init(PatternDebounce_t* debounce, uint32_t stableTime, INPUT_STATE state)
+{
+    ASSERT(debounce != NULL);
+
+    debounce->stableTime = stableTime;
+    debounce->state = state;
+    debounce->pendingState = state;
+    debounce->since = 0;
+    debounce->pending = false;
+}
+
+bool PatternDebounce_Expire(PatternDebounce_t* debounce, TimerTime_t time, PatternEdge_t* stable)
+{
+    if (!debounce->pending || ((uint32_t)(time - debounce->since) < debounce->stableTime))
+    {
+        return false;
+    }
+
+    debounce->pending = false;
+    debounce->state = debounce->pendingState;
+    stable->state = debounce->state;
+    stable->timestamp = debounce->since;
+    return true;
+}
+
+bool PatternDebounce_Edge(PatternDebounce_t* debounce, INPUT_STATE state, TimerTime_t timestamp,
+                          PatternEdge_t* stable)
+{
+    const bool passed = PatternDebounce_Expire(debounce, timestamp, stable);
+
+    if (state == debounce->state)
+    {
+        debounce->pending = false;      /* Glitch, back to the stable level */
+    }
+    else if (!debounce->pending || (state != debounce->pendingState))
+    {
+        debounce->pending = true;
+        debounce->pendingState = state;
+        debounce->since = timestamp;
+    }
+    return passed;
+}
+
+bool PatternDebounce_GetDeadline(const PatternDebounce_t* debounce, TimerTime_t* deadline)
+{
+    *deadline = debounce->since + debounce->stableTime;
+    return debounce->pending;
+}
+
+/* Completed candidates are recorded and every candidate starts over, the match consumed the input */
+static void CollectMatches(DigitalPatternSet_t* set)
+{
+    uint8_t matched = 0;
+
+    for (uint8_t i = 0; i < set->numPatterns; i++)
+    {
+        if (set->patterns[i]->patternComplete)
+        {
+            matched |= (uint8_t)(1u << i);
+        }
+    }
+    if (matched != 0)
+    {
+        set->matchedMask |= matched;
+        for (uint8_t i = 0; i < set->numPatterns; i++)
+        {
+            ResetPatternStruct(set->patterns[i]);
+        }
+    }
+}
+
+/* Product table counterpart of CollectMatches(), @p matched by index */
+static void CollectSetMatches(DigitalPatternSet_t* set, uint8_t matched)
+{
+    if (matched != 0)
+    {
+        set->matchedMask |= matched;
+        set->node = 0;
+        set->armedMask = 0;
+    }
+}
+
+/* Applies the flags of the pattern transitions on @p symbol, but of the @p skipped patterns, then moves
+ * to the next product node. Returns the patterns matched, by index. */
+static uint8_t StepSetNode(DigitalPatternSet_t* set, uint8_t symbol, TimerTime_t time, uint8_t skipped)
+{
+    const PatternSetNode_t* const setNode = &set->setNodes[set->node];
+    const uint8_t patternSymbol = (symbol < PATTERN_SET_SYMBOL_TIMEOUT(0)) ? symbol : PATTERN_SYMBOL_TIMEOUT;
+    uint8_t flagged = setNode->flagged[symbol] & (uint8_t)~skipped;
+    uint8_t matched = 0;
+
+    while (flagged != 0)
+    {
+        const uint8_t i = (uint8_t)__builtin_ctz(flagged);
+        const uint8_t bit = (uint8_t)(1u << i);
+        const PatternTransition_t* const transition = &set->tables[i][setNode->nodes[i]].on[patternSymbol];
+
+        if (transition->flags & PATTERN_FLAG_MARK)
+        {
+            set->since[i] = time;
+        }
+        if (transition->flags & PATTERN_FLAG_ARM)
+        {
+            set->deadlines[i] = time + transition->timeout;
+            set->armedMask |= bit;
+        }
+        else if (transition->flags & PATTERN_FLAG_DISARM)
+        {
+            set->armedMask &= (uint8_t)~bit;
+        }
+        if (transition->flags & PATTERN_FLAG_MATCH)
+        {
+            matched |= bit;
+        }
+        flagged &= (uint8_t)(flagged - 1);
+    }
+    set->node = setNode->next[symbol];
+
+    return matched;
+}
+
+/* Product table counterpart of StepEdge(). The patterns the edge comes before their minimum hold time
+ * for take the edge without their flags, then their reset (the early transition of every compiled
+ * node with a hold time), one lookup each. Returns the patterns matched, by index. */
+static uint8_t StepSetEdge(DigitalPatternSet_t* set, INPUT_STATE state, TimerTime_t time)
+{
+    const PatternSetNode_t* const setNode = &set->setNodes[set->node];
+    uint8_t early = 0;
+
+    for (uint8_t timed = setNode->timedMask; timed != 0; timed &= (uint8_t)(timed - 1))
+    {
+        const uint8_t i = (uint8_t)__builtin_ctz(timed);
+
+        if ((uint32_t)(time - set->since[i]) < set->tables[i][setNode->nodes[i]].minHold)
+        {
+            early |= (uint8_t)(1u << i);
+        }
+    }
+
+    const uint8_t matched = StepSetNode(set, state, time, early);
+
+    for (; early != 0; early &= (uint8_t)(early - 1))
+    {
+        const uint8_t i = (uint8_t)__builtin_ctz(early);
+
+        set->armedMask &= (uint8_t)~(1u << i);
+        set->node = set->setNodes[set->node].next[PATTERN_SET_SYMBOL_EARLY(i)];
+    }
+
+    return matched;
+}
+
+/* Nearest phase deadline of all candidates, false if none is running */
+static bool GetSetDeadline(const DigitalPatternSet_t* set, TimerTime_t* deadline)
+{
+    bool running = false;
+
+    for (uint8_t i = 0; i < set->numPatterns; i++)
+    {
+        const DigitalPattern_t* const pattern = set->patterns[i];
+        const bool armed = (set->setNodes != NULL) ? ((set->armedMask & (1u << i)) != 0) : pattern->phaseRunning;
+        const TimerTime_t patternDeadline = (set->setNodes != NULL) ? set->deadlines[i] : pattern->phaseDeadline;
+
+        if (armed && (!running || TimerTime_IsBefore(patternDeadline, *deadline)))
+        {
+            *deadline = patternDeadline;
+            running = true;
+        }
+    }
+    return running;
+}
+
+/* Arms the set timer for the nearest phase deadline of all candidates, if it changed */
+static void ArmSetTimer(DigitalPatternSet_t* set)
+{
+    TimerTime_t deadline = 0;
+
+    if (!GetSetDeadline(set, &deadline))
+    {
+        if (set->timerArmed)
+        {
+            TimerStop( &set->timer );
+            set->timerArmed = false;
+        }
+        return;
+    }
+    if (set->timerArmed && (deadline == set->timerDeadline))
+    {
+        return;
+    }
+
+    const TimerTime_t now = TimerGetCurrentTime();
+    TimerSetValue( &set->timer, TimerTime_IsBefore(now, deadline) ? (deadline - now) : 1 );
+    TimerStartWithParam( &set->timer, set );
+    set->timerDeadline = deadline;
+    set->timerArmed = true;
+}
+
+/* Ends the candidate phases reached at @p time, then rearms the timer */
+static void ExpireSet(DigitalPatternSet_t* set, TimerTime_t time)
+{
+    if (set->setNodes != NULL)
+    {
+        uint8_t matched = 0;
+
+        for (uint8_t i = 0; i < set->numPatterns; i++)
+        {
+            const uint8_t bit = (uint8_t)(1u << i);
+            while ((set->armedMask & bit) && !TimerTime_IsBefore(time, set->deadlines[i]))
+            {
+                set->armedMask &= (uint8_t)~bit;
+                matched |= StepSetNode(set, PATTERN_SET_SYMBOL_TIMEOUT(i), set->deadlines[i], 0);
+            }
+        }
+        CollectSetMatches(set, matched);
+        return;
+    }
+    for (uint8_t i = 0; i < set->numPatterns; i++)
+    {
+        ExpirePhases(set->patterns[i], time);
+    }
+    CollectMatches(set);
+}
+
+static void OnSetTimerEvent(void* context)
+{
+    ASSERT(context != NULL);
+    DigitalPatternSet_t *set = (DigitalPatternSet_t *) context;
+
+    set->timerArmed = false;
+    ExpireSet(set, TimerGetCurrentTime());
+    ArmSetTimer(set);
+}
+
+void DigitalPatternSet_Init(DigitalPatternSet_t* set, Gpio_t* inputPin)
+{
+    ASSERT(set != NULL);
+    ASSERT(inputPin != NULL);
+
+    set->inputPin = inputPin;
+    set->numPatterns = 0;
+    set->matchedMask = 0;
+    set->timerArmed = false;
+    set->timerDeadline = 0;
+    set->setNodes = NULL;
+    set->node = 0;
+    set->armedMask = 0;
+    TimerInit(&set->timer, OnSetTimerEvent);
+    LOG_SET_FORMATTER(LOG_MODULE_DIGITAL_PATTERN, FormatLogRecord);
+}
+
+uint8_t DigitalPatternSet_AddPattern(DigitalPatternSet_t* set, DigitalPattern_t* pattern)
+{
+    ASSERT(set != NULL);
+    ASSERT(pattern != NULL);
+    ASSERT(pattern->edges == NULL);
+    ASSERT(set->numPatterns < PATTERN_SET_MAX);
+
+    TimerStop( &pattern->phaseTimer );
+    pattern->timerShared = true;
+    ResetPatternStruct(pattern);
+    set->patterns[set->numPatterns] = pattern;
+    set->setNodes = NULL;
+
+    return set->numPatterns++;
+}
+
+/* Index of the product node of @p nodes in @p setNodes, adding it if new, false if it is new and the table full */
+static bool FindSetNode(PatternSetNode_t* setNodes, uint16_t* numSetNodes, uint8_t maxSetNodes,
+                        const uint8_t* nodes, uint8_t* index)
+{
+    for (uint16_t n = 0; n < *numSetNodes; n++)
+    {
+        if (memcmp(setNodes[n].nodes, nodes, PATTERN_SET_MAX) == 0)
+        {
+            *index = (uint8_t)n;
+            return true;
+        }
+    }
+    if (*numSetNodes >= maxSetNodes)
+    {
+        return false;
+    }
+    memset(&setNodes[*numSetNodes], 0, sizeof(setNodes[0]));
+    memcpy(setNodes[*numSetNodes].nodes, nodes, PATTERN_SET_MAX);
+    *index = (uint8_t)(*numSetNodes)++;
+
+    return true;
+}
+
+uint8_t DigitalPatternSet_Compile(DigitalPatternSet_t* set, PatternNode_t* nodes, uint16_t maxNodes,
+                                  PatternSetNode_t* setNodes, uint8_t maxSetNodes)
+{
+    ASSERT(set != NULL);
+    ASSERT(nodes != NULL);
+    ASSERT(setNodes != NULL);
+
+    const uint8_t numSymbols = PATTERN_SET_SYMBOL_TIMEOUT(set->numPatterns);
+    const uint8_t idle[PATTERN_SET_MAX] = { 0 };
+    uint16_t numNodes = 0;
+    uint16_t numSetNodes = 0;
+    uint8_t timedPatterns = 0;
+    uint8_t index;
+
+    set->setNodes = NULL;
+    for (uint8_t i = 0; i < set->numPatterns; i++)
+    {
+        const DigitalPattern_t* const pattern = set->patterns[i];
+        const uint8_t count = DigitalPattern_NodeCount(pattern);
+
+        for (uint8_t p = 0; p < pattern->numPhases; p++)
+        {
+            if (pattern->phases[p].timed)
+                timedPatterns |= (uint8_t)(1u << i);
+        }
+        if (numNodes + count > maxNodes)
+            return 0;
+        DigitalPattern_Compile(pattern, &nodes[numNodes], count);
+        set->tables[i] = &nodes[numNodes];
+        numNodes += count;
+    }
+
+    /* Breadth first from the idle node, the nodes found are appended and visited in turn */
+    if (!FindSetNode(setNodes, &numSetNodes, maxSetNodes, idle, &index))
+        return 0;
+    for (uint16_t n = 0; n < numSetNodes; n++)
+    {
+        for (uint8_t i = 0; i < set->numPatterns; i++)
+        {
+            if (set->tables[i][setNodes[n].nodes[i]].minHold != 0)
+            {
+                setNodes[n].timedMask |= (uint8_t)(1u << i);
+            }
+        }
+
+        /* An early edge resets the pattern, the early transition of all the compiled nodes with a hold time */
+        for (uint8_t i = 0; i < set->numPatterns; i++)
+        {
+            uint8_t next[PATTERN_SET_MAX];
+
+            if ((timedPatterns & (1u << i)) == 0)
+                continue;
+            memcpy(next, setNodes[n].nodes, PATTERN_SET_MAX);
+            next[i] = 0;
+            if (!FindSetNode(setNodes, &numSetNodes, maxSetNodes, next, &index))
+                return 0;
+            setNodes[n].next[PATTERN_SET_SYMBOL_EARLY(i)] = index;
+        }
+
+        for (uint8_t symbol = 0; symbol < numSymbols; symbol++)
+        {
+            uint8_t next[PATTERN_SET_MAX];
+            uint8_t flagged = 0;
+
+            memcpy(next, setNodes[n].nodes, PATTERN_SET_MAX);
+            for (uint8_t i = 0; i < set->numPatterns; i++)
+            {
+                /* A deadline only moves its own pattern */
+                if ((symbol >= PATTERN_SET_SYMBOL_TIMEOUT(0)) && (symbol != PATTERN_SET_SYMBOL_TIMEOUT(i)))
+                    continue;
+
+                const uint8_t patternSymbol = (symbol < PATTERN_SET_SYMBOL_TIMEOUT(0)) ? symbol : PATTERN_SYMBOL_TIMEOUT;
+                const PatternTransition_t* const transition = &set->tables[i][next[i]].on[patternSymbol];
+
+                if (transition->flags & (PATTERN_FLAG_ARM | PATTERN_FLAG_DISARM | PATTERN_FLAG_MATCH |
+                                         PATTERN_FLAG_MARK))
+                {
+                    flagged |= (uint8_t)(1u << i);
+                }
+                next[i] = transition->next;
+            }
+
+            if (!FindSetNode(setNodes, &numSetNodes, maxSetNodes, next, &index))
+                return 0;
+            setNodes[n].next[symbol] = index;
+            setNodes[n].flagged[symbol] = flagged;
+        }
+    }
+
+    set->setNodes = setNodes;
+    set->node = 0;
+    set->armedMask = 0;
+    memset(set->since, 0, sizeof(set->since));
+
+    return (uint8_t)numSetNodes;
+}
+
+void DigitalPatternSet_ProcessEdge(DigitalPatternSet_t* set, INPUT_STATE state, TimerTime_t timestamp)
+{
+    ASSERT(set != NULL);
+
+    ExpireSet(set, timestamp);
+    if (set->setNodes != NULL)
+    {
+        CollectSetMatches(set, StepSetEdge(set, state, timestamp));
+    }
+    else
+    {
+        for (uint8_t i = 0; i < set->numPatterns; i++)
+        {
+            StepPattern(set->patterns[i], state, timestamp);
+        }
+        CollectMatches(set);
+    }
+    ArmSetTimer(set);
+}
+
+void OnDigitalPatternSetEvent(DigitalPatternSet_t* set)
+{
+    ASSERT(set != NULL);
+
+    DigitalPatternSet_ProcessEdge(set, CheckInputState(set->inputPin), TimerGetCurrentTime());
+}
+
+int8_t DigitalPatternSet_Check(DigitalPatternSet_t* set)
+{
+    ASSERT(set != NULL);
+
+    int8_t index = -1;
+
+    CRITICAL_SECTION_BEGIN();
+    if (set->matchedMask != 0)
+    {
+        index = (int8_t)__builtin_ctz(set->matchedMask);
+        set->matchedMask &= set->matchedMask - 1;
+    }
+    CRITICAL_SECTION_END();
+
+    return index;
+}
+
+static const PatternTransition_t RESET_TRANSITION = PATTERN_RESET;
+
+/* Number of table nodes of a phase: one per expected state (or one for a phase without states),
+ * plus the completed node of a fixed duration phase, which waits for the phase timeout */
+static uint8_t PhaseNodeCount(const PatternPhase_t* phase)
+{
+    if (phase->timed)
+    {
+        return phase->numStates + 1;    /* Waiting for the first state, then one node per state */
+    }
+    return ((phase->numStates == 0) ? 1 : phase->numStates) + (phase->fixedDuration ? 1 : 0);
+}
+
+/* Transition to the start of phase @p index, whose nodes start at @p first, or the match after the last phase */
+static PatternTransition_t EnterPhase(const DigitalPattern_t* pattern, uint8_t index, uint8_t first)
+{
+    PatternTransition_t transition = PATTERN_MATCH;
+
+    if (index < pattern->numPhases)
+    {
+        transition.next = first;
+        transition.flags = PATTERN_FLAG_ARM;
+        transition.timeout = pattern->phases[index].phaseDuration;
+    }
+    return transition;
+}
+
+/* Transition into timed state @p k of a phase whose nodes start at @p first: the hold time starts,
+ * the deadline is its maximum, or its minimum for the last state, which then ends the phase */
+static PatternTransition_t EnterTimedState(const PatternPhase_t* phase, uint8_t first, uint8_t k)
+{
+    PatternTransition_t transition = PATTERN_MARK(first + 1 + k);
+
+    if (k == phase->numStates - 1)
+    {
+        transition.flags = PATTERN_FLAG_MARK | PATTERN_FLAG_ARM;
+        transition.timeout = phase->holds[k].minDuration;
+    }
+    else if (phase->holds[k].maxDuration != PATTERN_DURATION_ANY)
+    {
+        transition.flags = PATTERN_FLAG_MARK | PATTERN_FLAG_ARM;
+        transition.timeout = phase->holds[k].maxDuration;
+    }
+    return transition;
+}
+
+static void CompileTimedPhase(const PatternPhase_t* phase, PatternNode_t* node, uint8_t first,
+                              PatternTransition_t phaseEnd)
+{
+    ASSERT(phase->numStates > 0);
+
+    /* Waiting for the first state, other input is ignored */
+    node->on[INPUT_HIGH] = (PatternTransition_t)PATTERN_GOTO(first);
+    node->on[INPUT_LOW] = (PatternTransition_t)PATTERN_GOTO(first);
+    node->on[PhaseState(phase, 0)] = EnterTimedState(phase, first, 0);
+    node->on[PATTERN_SYMBOL_TIMEOUT] = RESET_TRANSITION;
+    node->on[PATTERN_SYMBOL_EARLY] = RESET_TRANSITION;
+
+    for (uint8_t k = 0; k < phase->numStates; k++)
+    {
+        const uint8_t current = first + 1 + k;
+        const bool last = (k == phase->numStates - 1);
+
+        ++node;
+        node->minHold = last ? 0 : phase->holds[k].minDuration;
+        node->on[INPUT_HIGH] = last ? RESET_TRANSITION : (PatternTransition_t)PATTERN_GOTO(current);
+        node->on[INPUT_LOW] = node->on[INPUT_HIGH];
+        if (!last)
+        {
+            node->on[PhaseState(phase, k + 1)] = EnterTimedState(phase, first, k + 1);
+        }
+        node->on[PATTERN_SYMBOL_TIMEOUT] = last ? phaseEnd : RESET_TRANSITION;
+        node->on[PATTERN_SYMBOL_EARLY] = RESET_TRANSITION;
+    }
+}
+
+uint8_t DigitalPattern_NodeCount(const DigitalPattern_t* pattern)
+{
+    ASSERT(pattern != NULL);
+
+    uint16_t numNodes = 1;
+
+    for (uint8_t p = 0; p < pattern->numPhases; p++)
+    {
+        numNodes += PhaseNodeCount(&pattern->phases[p]);
+    }
+    ASSERT(numNodes <= UINT8_MAX);      /* Node indexes are uint8_t */
+
+    return (uint8_t)numNodes;
+}
+
+uint8_t DigitalPattern_Compile(const DigitalPattern_t* pattern, PatternNode_t* nodes, uint8_t maxNodes)
+{
+    ASSERT(pattern != NULL);
+    ASSERT(nodes != NULL);
+    ASSERT(pattern->numPhases > 0);
+
+    const uint8_t numNodes = DigitalPattern_NodeCount(pattern);
+    uint8_t first = 1;                  /* First node of phase p */
+
+    ASSERT(numNodes <= maxNodes);
+    memset(nodes, 0, maxNodes * sizeof(*nodes));
+
+    for (uint8_t p = 0; p < pattern->numPhases; first += PhaseNodeCount(&pattern->phases[p]), p++)
+    {
+        const PatternPhase_t* const phase = &pattern->phases[p];
+        const PatternTransition_t phaseEnd = EnterPhase(pattern, p + 1, first + PhaseNodeCount(phase));
+        PatternNode_t* node = &nodes[first];
+
+        if (phase->timed)
+        {
+            CompileTimedPhase(phase, node, first, phaseEnd);
+            continue;
+        }
+        if (phase->numStates == 0)
+        {
+            /* Any input fails the phase, at once or at the timeout of a fixed duration phase */
+            node->on[INPUT_HIGH] = RESET_TRANSITION;
+            if (phase->fixedDuration)
+            {
+                node->on[INPUT_HIGH] = (PatternTransition_t)PATTERN_GOTO(first + 1);
+            }
+            node->on[INPUT_LOW] = node->on[INPUT_HIGH];
+            node->on[PATTERN_SYMBOL_TIMEOUT] = phaseEnd;
+            node->on[PATTERN_SYMBOL_EARLY] = RESET_TRANSITION;
+            if (phase->fixedDuration)
+            {
+                ++node;
+                node->on[INPUT_HIGH] = RESET_TRANSITION;
+                node->on[INPUT_LOW] = RESET_TRANSITION;
+                node->on[PATTERN_SYMBOL_TIMEOUT] = RESET_TRANSITION;
+                node->on[PATTERN_SYMBOL_EARLY] = RESET_TRANSITION;
+            }
+            continue;
+        }
+
+        for (uint8_t k = 0; k < phase->numStates; k++, node++)
+        {
+            const uint8_t current = first + k;
+            PatternTransition_t advance = PATTERN_GOTO(current + 1);
+
+            if ((k == phase->numStates - 1) && !phase->fixedDuration)
+            {
+                advance = phaseEnd;
+            }
+            /* Unexpected input states are ignored, as by the phase state index */
+            node->on[INPUT_HIGH] = (PatternTransition_t)PATTERN_GOTO(current);
+            node->on[INPUT_LOW] = (PatternTransition_t)PATTERN_GOTO(current);
+            node->on[PhaseState(phase, k)] = advance;
+            node->on[PATTERN_SYMBOL_TIMEOUT] = RESET_TRANSITION;
+            node->on[PATTERN_SYMBOL_EARLY] = RESET_TRANSITION;
+        }
+        if (phase->fixedDuration)
+        {
+            /* Completed: more input fails the phase, the timeout ends it */
+            node->on[INPUT_HIGH] = RESET_TRANSITION;
+            node->on[INPUT_LOW] = RESET_TRANSITION;
+            node->on[PATTERN_SYMBOL_TIMEOUT] = phaseEnd;
+            node->on[PATTERN_SYMBOL_EARLY] = RESET_TRANSITION;
+        }
+    }
+
+    /* Idle: the first edge starts the first phase and is its first input. A timed first phase only
+     * starts with its first state, without a bound on the wait. */
+    for (uint8_t symbol = INPUT_HIGH; symbol <= INPUT_LOW; symbol++)
+    {
+        PatternTransition_t start = nodes[1].on[symbol];
+        if (pattern->phases[0].timed && (start.next == 1))
+        {
+            start = (PatternTransition_t)PATTERN_GOTO(0);
+        }
+        else if ((start.flags & (PATTERN_FLAG_ARM | PATTERN_FLAG_DISARM)) == 0)
+        {
+            start.flags = PATTERN_FLAG_ARM;
+            start.timeout = pattern->phases[0].phaseDuration;
+        }
+        nodes[0].on[symbol] = start;
+    }
+    nodes[0].on[PATTERN_SYMBOL_TIMEOUT] = (PatternTransition_t)PATTERN_GOTO(0);
+    nodes[0].on[PATTERN_SYMBOL_EARLY] = (PatternTransition_t)PATTERN_GOTO(0);
+
+    return numNodes;
+}
+
+static void StepMatcher(PatternMatcher_t* matcher, uint8_t symbol, TimerTime_t time)
+{
+    const PatternTransition_t* const transition = &matcher->nodes[matcher->node].on[symbol];
+
+    if (matcher->node != transition->next)
+    {
+        DIGITAL_PATTERN_HOOK_NODE(matcher, transition->next);
+        PATTERN_TRACE(TRACE_PATTERN_NODE, transition->next, 0);
+    }
+    matcher->node = transition->next;
+    if (transition->flags & PATTERN_FLAG_MARK)
+    {
+        matcher->since = time;
+    }
+    if (transition->flags & PATTERN_FLAG_ARM)
+    {
+        matcher->deadline = time + transition->timeout;
+        matcher->deadlineArmed = true;
+    }
+    else if (transition->flags & PATTERN_FLAG_DISARM)
+    {
+        matcher->deadlineArmed = false;
+    }
+    if (transition->flags & PATTERN_FLAG_MATCH)
+    {
+        matcher->matched = true;
+    }
+}
+
+void PatternMatcher_Init(PatternMatcher_t* matcher, const PatternNode_t* nodes)
+{
+    ASSERT(matcher != NULL);
+    ASSERT(nodes != NULL);
+
+    matcher->nodes = nodes;
+    matcher->matched = false;
+    matcher->since = 0;
+    PatternMatcher_Reset(matcher);
+}
+
+void PatternMatcher_Reset(PatternMatcher_t* matcher)
+{
+    matcher->node = 0;
+    matcher->deadlineArmed = false;
+}
+
+void PatternMatcher_Expire(PatternMatcher_t* matcher, TimerTime_t time)
+{
+    while (matcher->deadlineArmed && !TimerTime_IsBefore(time, matcher->deadline))
+    {
+        matcher->deadlineArmed = false;
+        StepMatcher(matcher, PATTERN_SYMBOL_TIMEOUT, matcher->deadline);
+    }
+}
+
+static void StepEdge(PatternMatcher_t* matcher, INPUT_STATE state, TimerTime_t timestamp)
+{
+    const uint32_t minHold = matcher->nodes[matcher->node].minHold;
+
+    if ((minHold != 0) && ((uint32_t)(timestamp - matcher->since) < minHold))
+    {
+        StepMatcher(matcher, PATTERN_SYMBOL_EARLY, timestamp);
+        return;
+    }
+    StepMatcher(matcher, state, timestamp);
+}
+
+void PatternMatcher_Edge(PatternMatcher_t* matcher, INPUT_STATE state, TimerTime_t timestamp)
+{
+    PatternMatcher_Expire(matcher, timestamp);
+    StepEdge(matcher, state, timestamp);
+}
+
+bool PatternMatcher_GetDeadline(const PatternMatcher_t* matcher, TimerTime_t* deadline)
+{
+    *deadline = matcher->deadline;
+    return matcher->deadlineArmed;
+}
+
+bool PatternMatcher_Check(PatternMatcher_t* matcher)
+{
+    const bool matched = matcher->matched;
+
+    matcher->matched = false;
+    return matched;
+}
+
+/* PatternMatcher_Run() keeps the matcher in locals, StepMatcher() on them */
+#define RUN_STEP(symbol, stepTime) \
+    do { \
+        const PatternTransition_t* const transition = &nodes[node].on[(symbol)]; \
+        const uint8_t flags = transition->flags; \
+        if (node != transition->next) \
+        { \
+            DIGITAL_PATTERN_HOOK_NODE(matcher, transition->next); \
+            PATTERN_TRACE(TRACE_PATTERN_NODE, transition->next, 0); \
+        } \
+        node = transition->next; \
+        if (flags & PATTERN_FLAG_MARK) { since = (stepTime); } \
+        if (flags & PATTERN_FLAG_ARM) { deadline = (stepTime) + transition->timeout; deadlineArmed = true; } \
+        else if (flags & PATTERN_FLAG_DISARM) { deadlineArmed = false; } \
+        if (flags & PATTERN_FLAG_MATCH) \
+        { \
+            if (numMatches < maxMatches) \
+            { \
+                matches[numMatches].edge = i; \
+                matches[numMatches].time = (stepTime); \
+            } \
+            ++numMatches; \
+        } \
+    } while (0)
+
+uint32_t PatternMatcher_Run(PatternMatcher_t* matcher, const PatternEdge_t* edges, uint32_t numEdges,
+                            PatternMatch_t* matches, uint32_t maxMatches)
+{
+    ASSERT(matcher != NULL);
+    ASSERT((edges != NULL) || (numEdges == 0));
+    ASSERT((matches != NULL) || (maxMatches == 0));
+
+    const PatternNode_t* const nodes = matcher->nodes;
+    uint8_t node = matcher->node;
+    bool deadlineArmed = matcher->deadlineArmed;
+    TimerTime_t deadline = matcher->deadline;
+    TimerTime_t since = matcher->since;
+    uint32_t numMatches = 0;
+    uint32_t i = 0;
+
+    while (i < numEdges)
+    {
+        const TimerTime_t timestamp = edges[i].timestamp;
+        while (deadlineArmed && !TimerTime_IsBefore(timestamp, deadline))
+        {
+            const TimerTime_t expiry = deadline;
+            deadlineArmed = false;
+            RUN_STEP(PATTERN_SYMBOL_TIMEOUT, expiry);
+        }
+
+        const uint32_t minHold = nodes[node].minHold;
+        const uint8_t symbol = ((minHold != 0) && ((uint32_t)(timestamp - since) < minHold)) ?
+                               PATTERN_SYMBOL_EARLY : edges[i].state;
+        ++i;
+        RUN_STEP(symbol, timestamp);
+    }
+
+    matcher->node = node;
+    matcher->deadlineArmed = deadlineArmed;
+    matcher->deadline = deadline;
+    matcher->since = since;
+    matcher->matched |= (numMatches != 0);
+
+    return numMatches;
+}
+
+#undef RUN_STEP
+
+uint32_t DigitalPattern_Scan(const PatternNode_t* nodes, const PatternEdge_t* edges, uint32_t numEdges,
+                             TimerTime_t end, PatternMatch_t* matches, uint32_t maxMatches)
+{
+    PatternMatcher_t matcher;
+    TimerTime_t deadline;
+
+    PatternMatcher_Init(&matcher, nodes);
+    uint32_t numMatches = PatternMatcher_Run(&matcher, edges, numEdges, matches, maxMatches);
+    (void)PatternMatcher_Check(&matcher);     /* Counted already */
+
+    /* At most one match per deadline step, the matcher is idle after it */
+    while (PatternMatcher_GetDeadline(&matcher, &deadline) && !TimerTime_IsBefore(end, deadline))
+    {
+        PatternMatcher_Expire(&matcher, deadline);
+        if (PatternMatcher_Check(&matcher))
+        {
+            if (numMatches < maxMatches)
+            {
+                matches[numMatches].edge = numEdges;
+                matches[numMatches].time = deadline;
+            }
+            ++numMatches;
+        }
+    }
+
+    return numMatches;
+}
+
+/* Duration in bank ticks, rounded up: a deadline is seen by the first tick at or after it */
+static uint32_t BankTicks(const DigitalPatternBank_t* bank, uint32_t duration)
+{
+    const uint32_t ticks = (duration / bank->tickPeriod) + ((duration % bank->tickPeriod) != 0);
+
+    return (ticks < (1u << PATTERN_BANK_COUNTER_BITS)) ? ticks : ((1u << PATTERN_BANK_COUNTER_BITS) - 1);
+}
+
+/* Sets the counter of the @p channels to @p value */
+static void LoadCounter(uint32_t* planes, uint32_t channels, uint32_t value)
+{
+    for (uint8_t b = 0; b < PATTERN_BANK_COUNTER_BITS; b++)
+    {
+        planes[b] = ((value >> b) & 1) ? (planes[b] | channels) : (planes[b] & ~channels);
+    }
+}
+
+/* Decrements the (non-zero) counters of the @p channels, returns the ones reaching zero */
+static uint32_t CountDown(uint32_t* planes, uint32_t channels)
+{
+    uint32_t borrow = channels;
+    uint32_t nonZero = 0;
+
+    for (uint8_t b = 0; b < PATTERN_BANK_COUNTER_BITS; b++)
+    {
+        const uint32_t plane = planes[b];
+        planes[b] = plane ^ borrow;
+        borrow &= ~plane;
+        nonZero |= planes[b];
+    }
+    return channels & ~nonZero;
+}
+
+/* Increments the counters of the @p channels, saturating */
+static void CountUp(uint32_t* planes, uint32_t channels)
+{
+    uint32_t carry = channels;
+
+    for (uint8_t b = 0; b < PATTERN_BANK_COUNTER_BITS; b++)
+    {
+        carry &= planes[b];             /* Channels at the maximum */
+    }
+    carry = channels & ~carry;
+    for (uint8_t b = 0; (b < PATTERN_BANK_COUNTER_BITS) && (carry != 0); b++)
+    {
+        const uint32_t plane = planes[b];
+        planes[b] = plane ^ carry;
+        carry &= plane;
+    }
+}
+
+/* Returns the @p channels whose counter is below @p value */
+static uint32_t CountBelow(const uint32_t* planes, uint32_t channels, uint32_t value)
+{
+    uint32_t below = 0;
+    uint32_t equal = channels;
+
+    for (uint8_t b = PATTERN_BANK_COUNTER_BITS; b-- > 0;)
+    {
+        if ((value >> b) & 1)
+        {
+            below |= equal & ~planes[b];
+            equal &= planes[b];
+        }
+        else
+        {
+            equal &= ~planes[b];
+        }
+    }
+    return below;
+}
+
+/* StepMatcher() for the @p channels, all in the same node */
+static void StepBankChannels(DigitalPatternBank_t* bank, const PatternTransition_t* transition, uint32_t channels)
+{
+    if (channels == 0)
+    {
+        return;
+    }
+
+    bank->nextInNode[transition->next] |= channels;
+    if (transition->flags & PATTERN_FLAG_MARK)
+    {
+        LoadCounter(bank->elapsed, channels, 0);
+    }
+    if (transition->flags & PATTERN_FLAG_ARM)
+    {
+        /* At least one tick, the deadlines of a tick are evaluated before its edges */
+        const uint32_t ticks = BankTicks(bank, transition->timeout);
+        LoadCounter(bank->remaining, channels, (ticks != 0) ? ticks : 1);
+        bank->armed |= channels;
+    }
+    else if (transition->flags & PATTERN_FLAG_DISARM)
+    {
+        bank->armed &= ~channels;
+    }
+    if (transition->flags & PATTERN_FLAG_MATCH)
+    {
+        bank->matchedMask |= channels;
+    }
+}
+
+/* Steps the @p active channels of every node, with the timeout symbol or with an edge to the
+ * level in @p levels */
+static void StepBank(DigitalPatternBank_t* bank, uint32_t active, bool edge, uint32_t levels)
+{
+    memset(bank->nextInNode, 0, bank->numNodes * sizeof(uint32_t));
+
+    for (uint8_t n = 0; n < bank->numNodes; n++)
+    {
+        const PatternNode_t* const node = &bank->nodes[n];
+        uint32_t channels = bank->inNode[n] & active;
+
+        bank->nextInNode[n] |= bank->inNode[n] & ~active;
+        if (channels == 0)
+        {
+            continue;
+        }
+        if (!edge)
+        {
+            StepBankChannels(bank, &node->on[PATTERN_SYMBOL_TIMEOUT], channels);
+            continue;
+        }
+        if (node->minHold != 0)
+        {
+            const uint32_t early = CountBelow(bank->elapsed, channels, BankTicks(bank, node->minHold));
+            StepBankChannels(bank, &node->on[PATTERN_SYMBOL_EARLY], early);
+            channels &= ~early;
+        }
+        StepBankChannels(bank, &node->on[INPUT_HIGH], channels & levels);
+        StepBankChannels(bank, &node->on[INPUT_LOW], channels & ~levels);
+    }
+
+    uint32_t* const inNode = bank->inNode;
+    bank->inNode = bank->nextInNode;
+    bank->nextInNode = inNode;
+}
+
+void DigitalPatternBank_Init(DigitalPatternBank_t* bank, const PatternNode_t* nodes, uint8_t numNodes,
+                             PatternArena_t* arena, uint32_t tickPeriod, uint32_t channelMask,
+                             uint32_t (* readInputs)(void* context), void* context)
+{
+    ASSERT(bank != NULL);
+    ASSERT(nodes != NULL);
+    ASSERT(numNodes > 0);
+    ASSERT(arena != NULL);
+    ASSERT(tickPeriod > 0);
+
+    memset(bank, 0, sizeof(*bank));
+    bank->nodes = nodes;
+    bank->numNodes = numNodes;
+    bank->tickPeriod = tickPeriod;
+    bank->channelMask = channelMask;
+    bank->readInputs = readInputs;
+    bank->readContext = context;
+    bank->inNode = ArenaAlloc(arena, 2 * numNodes * sizeof(uint32_t), _Alignof(uint32_t));
+    bank->nextInNode = &bank->inNode[numNodes];
+    memset(bank->inNode, 0, 2 * numNodes * sizeof(uint32_t));
+    bank->inNode[0] = channelMask;
+    bank->levels = (readInputs != NULL) ? ((*readInputs)(context) & channelMask) : channelMask;
+}
+
+void DigitalPatternBank_Sample(DigitalPatternBank_t* bank, uint32_t levels)
+{
+    ASSERT(bank != NULL);
+
+    const uint32_t changed = (levels ^ bank->levels) & bank->channelMask;
+
+    CountUp(bank->elapsed, bank->channelMask);
+    if (bank->armed != 0)
+    {
+        const uint32_t expired = CountDown(bank->remaining, bank->armed);
+        if (expired != 0)
+        {
+            bank->armed &= ~expired;
+            StepBank(bank, expired, false, 0);
+        }
+    }
+    if (changed != 0)
+    {
+        bank->levels ^= changed;
+        StepBank(bank, changed, true, levels);
+    }
+}
+
+void OnDigitalPatternBankTick(DigitalPatternBank_t* bank)
+{
+    ASSERT(bank != NULL);
+    ASSERT(bank->readInputs != NULL);
+
+    DigitalPatternBank_Sample(bank, (*(bank->readInputs))(bank->readContext));
+}
+
+uint32_t DigitalPatternBank_Check(DigitalPatternBank_t* bank)
+{
+    ASSERT(bank != NULL);
+
+    CRITICAL_SECTION_BEGIN();
+    const uint32_t matched = bank->matchedMask;
+    bank->matchedMask = 0;
+    CRITICAL_SECTION_END();
+
+    return matched;
+}
@@ -21,20 +21,83 @@
  * input changes state after the phase has already completed, the phase is invalid
  * and the phase is deemed incorrect.
  *
+ * By default the input is sampled with GpioRead() when OnDigitalPatternEvent() runs, which may be
+ * too late for short pulses or bouncing inputs. In edge capture mode (DigitalPattern_EnableCapture())
+ * the interrupt, or a timer input capture / DMA, only records the input state and timestamp of each
+ * edge into a ring buffer, and the main loop runs the matcher with DigitalPattern_Process(). Phase
+ * durations are then evaluated against the edge timestamps rather than the time of processing.
+ *
+ * Contact bounce is best filtered before the matcher, where every extra edge is a step and an edge
+ * after a completed phase resets the pattern. A PatternDebounce_t only passes on the levels held for
+ * a stable time, with the timestamp of the edge that started them. It can be enabled on a pattern
+ * in edge capture mode (DigitalPattern_EnableDebounce()) or used on its own ahead of a pattern set,
+ * a matcher or a recorded stream.
+ *
+ * Several patterns watching the same input (e.g. single, double and long press of a button) can be
+ * grouped in a DigitalPatternSet_t: the input is sampled once per edge and a single timer is armed
+ * for the nearest phase deadline of all of them. The first pattern to complete is reported and all
+ * the patterns start over. By default each edge steps every pattern of the set, so its cost grows
+ * with the number of patterns, up to PATTERN_SET_MAX, and timed phases are not supported.
+ * DigitalPatternSet_Compile() instead builds the product of their compiled tables: one node per
+ * combination of pattern nodes the input can reach, so that an edge is a single lookup whatever the
+ * number of patterns, plus one table lookup for each pattern whose deadline or match changes on that
+ * edge. Patterns holding a timed state (e.g. a long press being held) also cost one hold time check
+ * each, and one more lookup for each of them the edge comes too early for.
+ *
+ * A built pattern can also be compiled (DigitalPattern_Compile()) into a flat transition table of
+ * PatternNode_t, indexed by the current node and the input symbol (INPUT_HIGH, INPUT_LOW or the
+ * phase timeout), which a PatternMatcher_t runs with one table lookup per step. Node 0 is the idle
+ * node, so a reset is a single store. The table is const data: it can be compiled at start-up into
+ * RAM or written out with the PATTERN_* macros below and kept in flash.
+ *
+ * Compiled tables also support timed phases, whose states must each be held for a [min, max] window,
+ * e.g. "held at least 800 ms" (see DigitalPattern_AddTimedState()). The windows are checked against
+ * the edge timestamps, and a matcher only ever has one deadline: the nearest one that can change
+ * the outcome.
+ *
+ * Many inputs running the same table (keypads, DIP switches) are best watched by a DigitalPatternBank_t
+ * of up to 32 channels: a whole GPIO port is read at once on a periodic tick (e.g. an AppEvent timer
+ * calling OnDigitalPatternBankTick()) and all the channels are stepped together, bit-sliced one bit
+ * per channel in each word. The node of each channel is a bit in a mask per node, and the deadline
+ * and hold time counters of all channels are 16 words of bit planes counting in ticks. The worst
+ * case of a tick is bounded by the table, whatever the number of channels: at most one pass over
+ * the nodes for the deadlines and one for the edges, each node taking at most three transitions that
+ * load at most two counters each.
+ * The average cost still grows with the channels, as more ticks see an edge or a deadline and more
+ * nodes hold channels: 3 to 4x per tick from 1 to 32 busy channels in the host benchmark (about 20
+ * to 80 ns), which is still 8x less per channel. Durations are rounded up to the tick period.
+ *
+ * PatternMatcher_* functions and DigitalPattern_Scan() do not use the timer or GPIO HAL, so recorded
+ * edge streams can be replayed through the same tables off-target, e.g. to tune the durations.
+ *
+ * Patterns are built in place: the phases live in a caller-provided PatternArena_t (typically a
+ * static buffer shared by all the patterns of the application), sized for the phases actually used,
+ * and the states of a phase are packed one bit each. There is no heap allocation and nothing is freed.
+ *
+ *     static uint32_t m_patternStorage[PATTERN_ARENA_WORDS(1, 2, 0)];
+ *     PatternArena_t arena;
+ *     DigitalPattern_t doublePress;
+ *
+ *     PatternArena_Init(&arena, m_patternStorage, sizeof(m_patternStorage));
+ *     DigitalPattern_Init(&doublePress, &buttonPin, &arena, 2);
+ *     PatternPhase_t* presses = DigitalPattern_AddPhase(&doublePress, 700, false);
+ *     DigitalPattern_AddState(presses, INPUT_LOW);
+ *     ...
+ *
  * Todo (Implement if needed?)
- *      - Heap memory allocation?
  *      - Functions for removing phases and states.
  * Note: Current implementation is probably convoluted and can be improved upon or
  * redone completely.
  */
 
+#include <stddef.h>
 #include "timer.h"
 #include "gpio.h"
 
-/* Max number of phases in a pattern */
-#define PHASE_MAX      3
-/* Max number of states in a phase */
-#define STATE_MAX      8
+/* Max number of states in a phase, one bit each */
+#define PATTERN_STATES_MAX      32
+/* Max number of patterns in a pattern set */
+#define PATTERN_SET_MAX 8
 
 typedef enum 
 {
@@ -53,26 +116,209 @@ typedef enum
 /* Note: Typically the structs would not be modified outside of
  * the function provided.
  */
+/* No maximum duration of a timed state, see DigitalPattern_AddTimedState() */
+#define PATTERN_DURATION_ANY        0xFFFF
+
+/* Storage the patterns are built in, see PatternArena_Init() */
+typedef struct
+{
+    uint8_t* buffer;
+    size_t size;
+    size_t used;                        /* Bytes allocated so far */
+} PatternArena_t;
+
+/* Hold window of a timed state, ms */
+typedef struct
+{
+    uint16_t minDuration;
+    uint16_t maxDuration;
+} PatternHold_t;
+
 typedef struct 
 {
-    INPUT_STATE states[STATE_MAX];
-    uint8_t numStates;
     uint32_t phaseDuration;
+    uint32_t states;                    /* Bit k is state k, set for INPUT_LOW */
+    PatternHold_t* holds;               /* Timed phases only, maxStates windows in the arena */
+    uint8_t numStates;
+    uint8_t maxStates;                  /* Timed phases only */
     bool fixedDuration;
-    int stateIndex;
-    PHASE_STATE phaseStatus;
+    bool timed;                         /* Created with DigitalPattern_AddTimedPhase() */
+    int8_t stateIndex;
+    uint8_t phaseStatus;                /* PHASE_STATE */
 } PatternPhase_t;
 
+/* Arena bytes for @p numPatterns patterns with @p numPhases phases in total, of which the timed phases
+ * have @p numTimedStates states in total, alignment of each pattern included */
+#define PATTERN_ARENA_SIZE(numPatterns, numPhases, numTimedStates) \
+    (((numPhases) * sizeof(PatternPhase_t)) + ((numTimedStates) * sizeof(PatternHold_t)) + \
+     ((numPatterns) * (_Alignof(PatternPhase_t) - 1)))
+/* Same in words, to declare an aligned static buffer */
+#define PATTERN_ARENA_WORDS(numPatterns, numPhases, numTimedStates) \
+    ((PATTERN_ARENA_SIZE(numPatterns, numPhases, numTimedStates) + sizeof(uint32_t) - 1) / sizeof(uint32_t))
+
+/* Input edge, as recorded by DigitalPattern_CaptureEdge() */
+typedef struct
+{
+    TimerTime_t timestamp;
+    INPUT_STATE state;              /* Input state after the edge */
+} PatternEdge_t;
+
+/* Time based debounce filter, see PatternDebounce_Init() */
+typedef struct
+{
+    uint32_t stableTime;            /* ms */
+    TimerTime_t since;              /* Edge that started the pending level */
+    INPUT_STATE state;              /* Last stable level passed on */
+    INPUT_STATE pendingState;
+    bool pending;
+} PatternDebounce_t;
+
 typedef struct 
 {
     Gpio_t * inputPin;
-    PatternPhase_t phases[PHASE_MAX];
+    PatternArena_t* arena;          /* Storage of the phases */
+    PatternPhase_t* phases;
     uint8_t numPhases;
+    uint8_t maxPhases;
     TimerEvent_t phaseTimer;
-    int phaseIndex;
+    TimerTime_t phaseDeadline;      /* End of the active phase */
+    bool phaseRunning;
+    bool timerShared;               /* Member of a DigitalPatternSet_t, which owns the timer */
+    int8_t phaseIndex;
     bool patternComplete;
+
+    /* Edge capture mode, see DigitalPattern_EnableCapture() */
+    PatternEdge_t* edges;
+    uint8_t edgeMask;
+    volatile uint8_t edgeHead;      /* Written by DigitalPattern_CaptureEdge() */
+    volatile uint8_t edgeTail;      /* Written by DigitalPattern_Process() */
+    volatile bool edgeOverflow;
+    uint32_t dropCount;             /* Edges lost because the buffer was full */
+    void (* notify)(void* context);
+    void* notifyContext;
+    PatternDebounce_t debounce;     /* See DigitalPattern_EnableDebounce() */
+    bool debounced;
 } DigitalPattern_t;
 
+/* Input symbols of a pattern transition table: INPUT_HIGH, INPUT_LOW, the deadline, and any edge
+ * seen before the node minimum hold time */
+#define PATTERN_SYMBOL_TIMEOUT      2
+#define PATTERN_SYMBOL_EARLY        3
+#define PATTERN_NUM_SYMBOLS         4
+
+/* Transition flags */
+#define PATTERN_FLAG_ARM            0x01    /* Deadline = time of the step + timeout */
+#define PATTERN_FLAG_DISARM         0x02    /* No deadline */
+#define PATTERN_FLAG_MATCH          0x04    /* The pattern is complete */
+#define PATTERN_FLAG_MARK           0x08    /* Hold time of the next node counts from the time of the step */
+
+typedef struct
+{
+    uint32_t timeout;               /* ms, with PATTERN_FLAG_ARM */
+    uint8_t next;                   /* Node after the step */
+    uint8_t flags;
+} PatternTransition_t;
+
+typedef struct
+{
+    PatternTransition_t on[PATTERN_NUM_SYMBOLS];
+    uint32_t minHold;               /* ms, edges before it are PATTERN_SYMBOL_EARLY, 0 for none */
+} PatternNode_t;
+
+/*
+ * Hand-written or generated tables, e.g. a press shorter than 300 ms followed by 400 ms without input:
+ *
+ *     static const PatternNode_t m_shortPress[] =
+ *     {
+ *         PATTERN_NODE(PATTERN_GOTO(0), PATTERN_ARM(1, 300), PATTERN_GOTO(0)),    // 0: idle
+ *         PATTERN_NODE(PATTERN_ARM(2, 400), PATTERN_GOTO(1), PATTERN_RESET),      // 1: pressed
+ *         PATTERN_NODE(PATTERN_RESET, PATTERN_RESET, PATTERN_MATCH),              // 2: released
+ *     };
+ */
+#define PATTERN_NODE(high, low, timeout)    { .on = { high, low, timeout, PATTERN_RESET } }
+#define PATTERN_TIMED_NODE(minHold, high, low, timeout, early) \
+                                            { .on = { high, low, timeout, early }, .minHold = (minHold) }
+#define PATTERN_GOTO(node)                  { .next = (node), .flags = 0 }
+#define PATTERN_ARM(node, ms)               { .timeout = (ms), .next = (node), .flags = PATTERN_FLAG_ARM }
+#define PATTERN_MARK(node)                  { .next = (node), .flags = PATTERN_FLAG_MARK | PATTERN_FLAG_DISARM }
+#define PATTERN_MARK_ARM(node, ms)          { .timeout = (ms), .next = (node), .flags = PATTERN_FLAG_MARK | PATTERN_FLAG_ARM }
+#define PATTERN_RESET                       { .next = 0, .flags = PATTERN_FLAG_DISARM }
+#define PATTERN_MATCH                       { .next = 0, .flags = PATTERN_FLAG_MATCH | PATTERN_FLAG_DISARM }
+
+/* Match found by DigitalPattern_Scan()/PatternMatcher_Run() */
+typedef struct
+{
+    uint32_t edge;                  /* Number of edges of the stream consumed when the match was found */
+    TimerTime_t time;               /* Time of the match: edge timestamp or deadline */
+} PatternMatch_t;
+
+/* Run time state of a transition table */
+typedef struct
+{
+    const PatternNode_t* nodes;
+    uint8_t node;
+    bool deadlineArmed;
+    bool matched;
+    TimerTime_t deadline;
+    TimerTime_t since;              /* Time of the last PATTERN_FLAG_MARK step */
+} PatternMatcher_t;
+
+/* Input symbols of a pattern set product table: INPUT_HIGH, INPUT_LOW, the deadline of pattern i, and
+ * the reset of pattern i by an edge before its minimum hold time, which moves pattern i only */
+#define PATTERN_SET_SYMBOL_TIMEOUT(i)   (2 + (i))
+#define PATTERN_SET_SYMBOL_EARLY(i)     (2 + PATTERN_SET_MAX + (i))
+#define PATTERN_SET_NUM_SYMBOLS         (2 + (2 * PATTERN_SET_MAX))
+
+/* Node of a pattern set product table, see DigitalPatternSet_Compile() */
+typedef struct
+{
+    uint8_t next[PATTERN_SET_NUM_SYMBOLS];      /* Product node after the symbol */
+    uint8_t flagged[PATTERN_SET_NUM_SYMBOLS];   /* Patterns whose transition on the symbol has flags, by index */
+    uint8_t nodes[PATTERN_SET_MAX];             /* Node of each pattern table */
+    uint8_t timedMask;                          /* Patterns in a node with a minimum hold time, by index */
+} PatternSetNode_t;
+
+typedef struct
+{
+    Gpio_t * inputPin;
+    DigitalPattern_t* patterns[PATTERN_SET_MAX];
+    uint8_t numPatterns;
+    volatile uint8_t matchedMask;   /* Patterns matched since the last DigitalPatternSet_Check(), by index */
+    TimerEvent_t timer;
+    TimerTime_t timerDeadline;
+    bool timerArmed;
+
+    /* Product table, see DigitalPatternSet_Compile(), NULL to step each pattern */
+    const PatternSetNode_t* setNodes;
+    const PatternNode_t* tables[PATTERN_SET_MAX];
+    uint8_t node;
+    uint8_t armedMask;              /* Patterns with a deadline, by index */
+    TimerTime_t deadlines[PATTERN_SET_MAX];
+    TimerTime_t since[PATTERN_SET_MAX];     /* Time of the last PATTERN_FLAG_MARK step of each pattern */
+} DigitalPatternSet_t;
+
+/* Max number of channels of a pattern bank, one bit each */
+#define PATTERN_BANK_CHANNELS_MAX   32
+/* Width of the bank tick counters, durations are clamped to (2^16 - 1) ticks */
+#define PATTERN_BANK_COUNTER_BITS   16
+
+typedef struct
+{
+    const PatternNode_t* nodes;
+    uint8_t numNodes;
+    uint32_t tickPeriod;            /* ms */
+    uint32_t channelMask;
+    uint32_t (* readInputs)(void* context);
+    void* readContext;
+    uint32_t levels;                /* Input levels of the last tick, bit set for high */
+    uint32_t* inNode;               /* Channels in each node, numNodes masks in the arena */
+    uint32_t* nextInNode;
+    uint32_t armed;                 /* Channels with a deadline */
+    uint32_t remaining[PATTERN_BANK_COUNTER_BITS];  /* Ticks to the deadline, bit planes */
+    uint32_t elapsed[PATTERN_BANK_COUNTER_BITS];    /* Ticks since the last PATTERN_FLAG_MARK step */
+    volatile uint32_t matchedMask;  /* Channels matched since the last DigitalPatternBank_Check() */
+} DigitalPatternBank_t;
+
 /*
  * @brief Checks the state of the input updates the appropriate
  * PatternPhase_t struct
@@ -82,45 +328,79 @@ typedef struct
  *
  * @param   pattern, pointer to struct containing the pattern
  * */
-void OnDigitalPattern_tEvent(DigitalPattern_t* pattern);
+void OnDigitalPatternEvent(DigitalPattern_t* pattern);
 
 /*
- * @brief Initializes a DigitalPattern_t struct
+ * @brief Initializes an arena over a caller-provided buffer
  *
- * @param inputPin, gpio input pin to examine for the pattern
+ * @param arena, pointer to the arena struct
+ * @param buffer, storage of the patterns, must stay valid while they are in use
+ * @param size, size of @p buffer in bytes, see PATTERN_ARENA_SIZE()
+ */
+void PatternArena_Init(PatternArena_t* arena, void* buffer, size_t size);
+
+/*
+ * @brief Initializes a DigitalPattern_t struct in place, with room for @p maxPhases phases
+ * taken from @p arena
  *
- *@return DigitalPattern_t struct
+ * @param pattern, pointer to the pattern struct, must stay at the same address while in use
+ * @param inputPin, gpio input pin to examine for the pattern
+ * @param arena, arena the phases are allocated from, see PatternArena_Init()
+ * @param maxPhases, number of phases that will be added
  */
-DigitalPattern_t DigitalPattern_t_Init(Gpio_t* inputPin);
+void DigitalPattern_Init(DigitalPattern_t* pattern, Gpio_t* inputPin, PatternArena_t* arena, uint8_t maxPhases);
 
 /*
- * @brief Creates a phase struct with the specified duration, to be used in
- * the construction of a DigitalPattern_t
+ * @brief Adds a phase with the specified duration to the pattern
  *
+ * @param pattern, pointer to the pattern struct that will store the phase
  * @param duration, phase duration
  * @param fixedDuration, bool to indicate whether the phase has a fix
  *        Essentially, whether a phase terminates when the phase timer
  *        expires (fixed) or on the last input state (not fixed).
  *
- * @return PatternPhase_t struct
+ * @return pointer to the phase in @p pattern, to add the states to
  */
-PatternPhase_t DigitalPattern_t_CreatePhase(uint32_t duration, bool fixedDuration);
+PatternPhase_t* DigitalPattern_AddPhase(DigitalPattern_t* pattern, uint32_t duration, bool fixedDuration);
 
 /*
- * @brief Adds a pattern phase struct
+ * @brief Adds a phase of timed states (see DigitalPattern_AddTimedState()) to the pattern, the hold
+ * windows of its states are taken from the pattern arena
  *
  * @param pattern, pointer to the pattern struct that will store the phase
- * @param phase, phase struct that will be added to @p pattern
+ * @param duration, phase duration
+ * @param maxStates, number of states that will be added, up to PATTERN_STATES_MAX
+ *
+ * @return pointer to the phase in @p pattern, to add the states to
  */
-void DigitalPattern_t_AddPhase(DigitalPattern_t* pattern, PatternPhase_t phase);
+PatternPhase_t* DigitalPattern_AddTimedPhase(DigitalPattern_t* pattern, uint32_t duration, uint8_t maxStates);
 
 /*
- * @brief Adds a state to the phase struct
+ * @brief Adds a state to the phase struct, up to PATTERN_STATES_MAX
  *
  * @param phase, pointer to phase struct that will store the state
  * @param state, input state to add to @p phase
  */
-void DigitalPattern_t_AddState(PatternPhase_t* phase, INPUT_STATE state);
+void DigitalPattern_AddState(PatternPhase_t* phase, INPUT_STATE state);
+
+/*
+ * @brief Adds a state that must be held for a duration window to a phase created with
+ * DigitalPattern_AddTimedPhase()
+ *
+ * The state starts with the edge into it and ends with the next edge, which must come within
+ * [minDuration, maxDuration]. The last state of the phase ends the phase as soon as it has been
+ * held for minDuration (its maxDuration is not used), e.g. a single LOW state with a minimum of
+ * 800 ms matches a press held for at least 800 ms. The phase duration only bounds the wait for
+ * the first state when the phase is not the first one. Timed phases are matched by compiled
+ * tables only (DigitalPattern_Compile(), DigitalPatternSet_Compile()).
+ *
+ * @param phase, pointer to phase struct that will store the state
+ * @param state, input state to add to @p phase
+ * @param minDuration, minimum time in the state, ms
+ * @param maxDuration, maximum time in the state, ms, or PATTERN_DURATION_ANY
+ */
+void DigitalPattern_AddTimedState(PatternPhase_t* phase, INPUT_STATE state, uint16_t minDuration,
+                                  uint16_t maxDuration);
 
 /*
  * @brief Checks to see if pattern has been successfully performed
@@ -132,7 +412,332 @@ void DigitalPattern_t_AddState(PatternPhase_t* phase, INPUT_STATE state);
  *
  * @return true if the pattern was performed successfully, false if not
  */
-bool DigitalPattern_t_Check(DigitalPattern_t* pattern);
+bool DigitalPattern_Check(DigitalPattern_t* pattern);
+
+/*
+ * @brief Switches the pattern to edge capture mode
+ *
+ * Edges are then recorded by DigitalPattern_CaptureEdge() (or OnDigitalPatternEdge()) and matched
+ * by DigitalPattern_Process(), OnDigitalPatternEvent() must not be used any more. If the buffer
+ * overflows, the edges are dropped and the pattern is reset by the next DigitalPattern_Process().
+ *
+ * @param pattern, pointer to the pattern struct
+ * @param buffer, edge ring buffer, must stay valid while the pattern is in use
+ * @param size, number of edges in @p buffer, a power of two up to 128
+ * @param notify, optional, called from interrupt context whenever DigitalPattern_Process() has
+ *        work to do (edge recorded or phase timer expired), e.g. to trigger an AppEvent
+ * @param context, passed to @p notify
+ */
+void DigitalPattern_EnableCapture(DigitalPattern_t* pattern, PatternEdge_t* buffer, uint8_t size,
+                                  void (* notify)(void* context), void* context);
+
+/*
+ * @brief Records an input edge, to be called from the input interrupt or with the value of a
+ * timer input capture / DMA transfer
+ *
+ * @param pattern, pointer to a pattern struct in edge capture mode
+ * @param state, input state after the edge
+ * @param timestamp, time of the edge
+ */
+void DigitalPattern_CaptureEdge(DigitalPattern_t* pattern, INPUT_STATE state, TimerTime_t timestamp);
+
+/*
+ * @brief Input interrupt handler of the edge capture mode: samples the input and the time on entry
+ * and records the edge
+ *
+ * @param context, pointer to the pattern struct, see GpioMcuSetContext()
+ */
+void OnDigitalPatternEdge(void* context);
+
+/*
+ * @brief Filters the recorded edges of a pattern in edge capture mode with a debounce stage
+ *
+ * Only the levels held for @p stableTime reach the matcher, once they have been held that long
+ * (the phase timer also wakes up the main loop for it), with the timestamp of their first edge.
+ *
+ * @param pattern, pointer to a pattern struct in edge capture mode
+ * @param stableTime, time a level must be held to be passed on, ms
+ */
+void DigitalPattern_EnableDebounce(DigitalPattern_t* pattern, uint32_t stableTime);
+
+/*
+ * @brief Runs the matcher over the recorded edges and the phase deadlines reached so far
+ *
+ * Must be called from the main loop after each notification (see DigitalPattern_EnableCapture()).
+ *
+ * @param pattern, pointer to a pattern struct in edge capture mode
+ */
+void DigitalPattern_Process(DigitalPattern_t* pattern);
+
+/*
+ * @brief Initializes a debounce filter
+ *
+ * @param debounce, pointer to the filter struct
+ * @param stableTime, time a level must be held to be passed on, ms
+ * @param state, current input level
+ */
+void PatternDebounce_Init(PatternDebounce_t* debounce, uint32_t stableTime, INPUT_STATE state);
+
+/*
+ * @brief Feeds a raw input edge to the filter
+ *
+ * A level that changes back within the stable time is dropped together with its edge.
+ *
+ * @param debounce, pointer to the filter struct
+ * @param state, input state after the edge
+ * @param timestamp, time of the edge, not older than the previous one
+ * @param stable, returned edge, when the pending level turned out stable before @p timestamp
+ *
+ * @return true if @p stable was returned
+ */
+bool PatternDebounce_Edge(PatternDebounce_t* debounce, INPUT_STATE state, TimerTime_t timestamp,
+                          PatternEdge_t* stable);
+
+/*
+ * @brief Passes on the pending level if it has been held for the stable time at @p time
+ *
+ * @param debounce, pointer to the filter struct
+ * @param time, current time
+ * @param stable, returned edge
+ *
+ * @return true if @p stable was returned
+ */
+bool PatternDebounce_Expire(PatternDebounce_t* debounce, TimerTime_t time, PatternEdge_t* stable);
+
+/*
+ * @brief Returns the time at which the pending level will be stable, to call PatternDebounce_Expire()
+ *
+ * @param debounce, pointer to the filter struct
+ * @param deadline, returned time
+ *
+ * @return false if no level is pending
+ */
+bool PatternDebounce_GetDeadline(const PatternDebounce_t* debounce, TimerTime_t* deadline);
+
+/*
+ * @brief Initializes a pattern set in place
+ *
+ * @param set, pointer to the set struct, must stay at the same address while in use
+ * @param inputPin, gpio input pin to examine for the patterns
+ */
+void DigitalPatternSet_Init(DigitalPatternSet_t* set, Gpio_t* inputPin);
+
+/*
+ * @brief Adds a pattern built with DigitalPattern_Init()/DigitalPattern_AddPhase() to the set
+ *
+ * The pattern then belongs to the set: its own timer is not used any more and it must not be
+ * passed to the other DigitalPattern_* functions. A product table of the set is dropped, see
+ * DigitalPatternSet_Compile().
+ *
+ * @param set, pointer to the set struct
+ * @param pattern, pointer to the pattern struct, must stay valid while the set is in use
+ *
+ * @return index of the pattern in the set, as reported by DigitalPatternSet_Check()
+ */
+uint8_t DigitalPatternSet_AddPattern(DigitalPatternSet_t* set, DigitalPattern_t* pattern);
+
+/*
+ * @brief Compiles the patterns of the set into a product table, so that each edge advances all of
+ * them with one lookup
+ *
+ * Each pattern is compiled with DigitalPattern_Compile() into @p nodes, and the product table lists the
+ * combinations of their nodes reachable from the idle one. The set then matches from the tables, as it
+ * would by stepping the patterns, and the pattern structs are not updated any more: the
+ * DIGITAL_PATTERN_HOOK_PHASE() calls and the debug logs of their phases are not made. Call it once all
+ * the patterns are added, with the set idle. A set with timed phases (DigitalPattern_AddTimedPhase())
+ * must be compiled, as they are only matched from the tables.
+ *
+ * @param set, pointer to the set struct
+ * @param nodes, storage for the tables of the patterns, must stay valid while the set is in use
+ * @param maxNodes, number of entries of @p nodes, at least the DigitalPattern_NodeCount() of the patterns
+ * @param setNodes, storage for the product table, must stay valid while the set is in use
+ * @param maxSetNodes, number of entries of @p setNodes
+ *
+ * @return number of nodes of the product table, 0 if @p nodes or @p setNodes is too small: the set
+ * keeps stepping each pattern
+ */
+uint8_t DigitalPatternSet_Compile(DigitalPatternSet_t* set, PatternNode_t* nodes, uint16_t maxNodes,
+                                  PatternSetNode_t* setNodes, uint8_t maxSetNodes);
+
+/*
+ * @brief Samples the input once and advances every pattern of the set
+ *
+ * Should typically be invoked by the input interrupt handler (directly or indirectly).
+ *
+ * @param set, pointer to the set struct
+ */
+void OnDigitalPatternSetEvent(DigitalPatternSet_t* set);
+
+/*
+ * @brief Advances every pattern of the set with an input edge recorded elsewhere, e.g. from a
+ * PatternEdge_t capture buffer
+ *
+ * @param set, pointer to the set struct
+ * @param state, input state after the edge
+ * @param timestamp, time of the edge, not older than the previous edge
+ */
+void DigitalPatternSet_ProcessEdge(DigitalPatternSet_t* set, INPUT_STATE state, TimerTime_t timestamp);
+
+/*
+ * @brief Returns a pattern matched by the set since the last call and forgets it
+ *
+ * @param set, pointer to the set struct
+ *
+ * @return index of the matched pattern (see DigitalPatternSet_AddPattern()), -1 if none
+ */
+int8_t DigitalPatternSet_Check(DigitalPatternSet_t* set);
+
+/*
+ * @brief Returns the number of table nodes DigitalPattern_Compile() needs for a pattern
+ *
+ * @param pattern, pointer to the pattern struct
+ *
+ * @return number of nodes, up to 255
+ */
+uint8_t DigitalPattern_NodeCount(const DigitalPattern_t* pattern);
+
+/*
+ * @brief Initializes a pattern bank in place, all the channels idle
+ *
+ * @param bank, pointer to the bank struct
+ * @param nodes, transition table run by every channel, must stay valid while the bank is in use
+ * @param numNodes, number of nodes of @p nodes
+ * @param arena, arena the node masks are allocated from (2 words per node)
+ * @param tickPeriod, period of OnDigitalPatternBankTick(), ms
+ * @param channelMask, channels in use, bit n for channel n
+ * @param readInputs, optional, returns the input levels of all channels (bit set for high), e.g.
+ *        a GPIO port input data register, also read once here. Without it, every channel starts high.
+ * @param context, passed to @p readInputs
+ */
+void DigitalPatternBank_Init(DigitalPatternBank_t* bank, const PatternNode_t* nodes, uint8_t numNodes,
+                             PatternArena_t* arena, uint32_t tickPeriod, uint32_t channelMask,
+                             uint32_t (* readInputs)(void* context), void* context);
+
+/*
+ * @brief Reads the inputs and steps every channel of the bank, to be called every tickPeriod
+ *
+ * @param bank, pointer to a bank struct with a readInputs function
+ */
+void OnDigitalPatternBankTick(DigitalPatternBank_t* bank);
+
+/*
+ * @brief Steps every channel of the bank with input levels sampled elsewhere, one call per tick
+ *
+ * The deadlines reached at the tick are evaluated first, then the channels whose level changed
+ * since the previous tick see an edge.
+ *
+ * @param bank, pointer to the bank struct
+ * @param levels, input levels of all channels, bit set for high
+ */
+void DigitalPatternBank_Sample(DigitalPatternBank_t* bank, uint32_t levels);
+
+/*
+ * @brief Returns the channels matched since the last call and forgets them
+ *
+ * @param bank, pointer to the bank struct
+ *
+ * @return mask of the matched channels, bit n for channel n
+ */
+uint32_t DigitalPatternBank_Check(DigitalPatternBank_t* bank);
+
+/*
+ * @brief Compiles a pattern built with DigitalPattern_AddPhase()/DigitalPattern_AddState() into a
+ * transition table, matching as the pattern itself would
+ *
+ * @param pattern, pointer to the pattern struct, at least one phase
+ * @param nodes, table to fill in
+ * @param maxNodes, number of entries of @p nodes, at least DigitalPattern_NodeCount()
+ *
+ * @return number of nodes of the table
+ */
+uint8_t DigitalPattern_Compile(const DigitalPattern_t* pattern, PatternNode_t* nodes, uint8_t maxNodes);
+
+/*
+ * @brief Initializes a matcher on a transition table, in the idle node
+ *
+ * @param matcher, pointer to the matcher struct
+ * @param nodes, transition table, must stay valid while the matcher is in use
+ */
+void PatternMatcher_Init(PatternMatcher_t* matcher, const PatternNode_t* nodes);
+
+/* @brief Returns the matcher to the idle node */
+void PatternMatcher_Reset(PatternMatcher_t* matcher);
+
+/*
+ * @brief Steps the matcher with an input edge, after the deadlines reached before it
+ *
+ * @param matcher, pointer to the matcher struct
+ * @param state, input state after the edge
+ * @param timestamp, time of the edge, not older than the previous one
+ */
+void PatternMatcher_Edge(PatternMatcher_t* matcher, INPUT_STATE state, TimerTime_t timestamp);
+
+/*
+ * @brief Steps the matcher with the deadlines reached at @p time
+ *
+ * @param matcher, pointer to the matcher struct
+ * @param time, current time, or timestamp of the end of a recorded stream
+ */
+void PatternMatcher_Expire(PatternMatcher_t* matcher, TimerTime_t time);
+
+/*
+ * @brief Returns the time at which the matcher must be stepped with PatternMatcher_Expire(), the
+ * single deadline to arm a timer for
+ *
+ * @param matcher, pointer to the matcher struct
+ * @param deadline, returned deadline
+ *
+ * @return false if the matcher has no deadline
+ */
+bool PatternMatcher_GetDeadline(const PatternMatcher_t* matcher, TimerTime_t* deadline);
+
+/*
+ * @brief Steps the matcher over a recorded edge stream
+ *
+ * Same result as PatternMatcher_Edge() for each edge, with the matcher state kept in registers for
+ * the whole stream: same final state, same DIGITAL_PATTERN_HOOK_NODE() calls and trace points, and a
+ * match is also reported by the next PatternMatcher_Check().
+ *
+ * There is no vectorized path: each step needs the node of the previous one, so a stream has no data
+ * parallelism, and the per-edge work is one table lookup. Across captures, the bit-sliced stepping of
+ * DigitalPatternBank_t costs one pass over the nodes per tick rather than per edge: replaying 32 recorded
+ * button streams through a bank on a 10 ms tick ran 30x slower on the host than this loop over each.
+ *
+ * @param matcher, pointer to the matcher struct
+ * @param edges, edge stream in timestamp order
+ * @param numEdges, number of edges in @p edges
+ * @param matches, returned matches, may be NULL if @p maxMatches is 0
+ * @param maxMatches, number of entries of @p matches
+ *
+ * @return number of matches found, also the ones that did not fit in @p matches
+ */
+uint32_t PatternMatcher_Run(PatternMatcher_t* matcher, const PatternEdge_t* edges, uint32_t numEdges,
+                            PatternMatch_t* matches, uint32_t maxMatches);
+
+/*
+ * @brief Evaluates a transition table over a recorded edge stream from the idle node, then up to
+ * the end of the recording
+ *
+ * @param nodes, transition table
+ * @param edges, edge stream in timestamp order
+ * @param numEdges, number of edges in @p edges
+ * @param end, end time of the recording, deadlines up to it are evaluated
+ * @param matches, returned matches, may be NULL if @p maxMatches is 0
+ * @param maxMatches, number of entries of @p matches
+ *
+ * @return number of matches found, also the ones that did not fit in @p matches
+ */
+uint32_t DigitalPattern_Scan(const PatternNode_t* nodes, const PatternEdge_t* edges, uint32_t numEdges,
+                             TimerTime_t end, PatternMatch_t* matches, uint32_t maxMatches);
+
+/*
+ * @brief Checks to see if the pattern has been matched since the last call
+ *
+ * @param matcher, pointer to the matcher struct
+ *
+ * @return true if the pattern was matched
+ */
+bool PatternMatcher_Check(PatternMatcher_t* matcher);
 
 #endif /* DIGITAL_PATTERN_H */
 
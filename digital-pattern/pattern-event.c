@@ -0,0 +1,147 @@
+#include "assertion.h"
+#include <stddef.h>
+#include "pattern-event.h"
+#include "timer-time.h"
+
+#ifndef APP_EVENT_STATIC_TABLE
+
+/* Arms the timer event for the deadline of the matcher, if it changed */
+static void ArmTimer(DigitalPatternEvent_t* binding)
+{
+    TimerTime_t deadline;
+
+    if (!PatternMatcher_GetDeadline(&binding->matcher, &deadline))
+    {
+        if (binding->timerArmed)
+        {
+            AppEvent_Stop(binding->timerEventId);
+            binding->timerArmed = false;
+        }
+        return;
+    }
+    if (binding->timerArmed && (deadline == binding->timerDeadline))
+    {
+        return;
+    }
+
+    const TimerTime_t now = TimerGetCurrentTime();
+    const uint32_t timeout = TimerTime_IsBefore(now, deadline) ? (deadline - now) : 0;
+
+    /* A late expiry still steps the matcher at the deadline, see PatternMatcher_Expire() */
+    AppEvent_SetTimeout(binding->timerEventId,
+                        (timeout < PATTERN_EVENT_TIMEOUT_MIN) ? PATTERN_EVENT_TIMEOUT_MIN : timeout);
+    AppEvent_Start(binding->timerEventId, true);
+    binding->timerDeadline = deadline;
+    binding->timerArmed = true;
+}
+
+static void CheckMatch(DigitalPatternEvent_t* binding)
+{
+    if (PatternMatcher_Check(&binding->matcher))
+    {
+        AppEvent_TriggerWithPayload(binding->matchEventId, binding->patternId);
+    }
+}
+
+/* Queued records of the interrupt event, the payload is the pin level */
+static void OnEdgeRecord(void* context, const AppEvent_Record_t* record)
+{
+    DigitalPatternEvent_t* const binding = (DigitalPatternEvent_t*)context;
+    const uint32_t dropCount = AppEvent_GetDropCount(binding->edgeEventId);
+
+    if (dropCount != binding->dropCount)
+    {
+        /* Edges were lost to the full queue, after the records still queued: the matcher would step a made up
+         * input, so skip up to the gap and start over from the idle node */
+        binding->dropCount = dropCount;
+        binding->resyncTime = TimerGetCurrentTime();
+        binding->resyncing = true;
+        PatternMatcher_Reset(&binding->matcher);
+    }
+    if (binding->resyncing)
+    {
+        if (!TimerTime_IsBefore(binding->resyncTime, record->timestamp))
+        {
+            ArmTimer(binding);
+            return;
+        }
+        binding->resyncing = false;
+    }
+    PatternMatcher_Edge(&binding->matcher, (record->payload != 0) ? INPUT_HIGH : INPUT_LOW, record->timestamp);
+    CheckMatch(binding);
+    ArmTimer(binding);
+}
+
+/* The edges run at a higher priority, so the ones before the deadline have been stepped already */
+static void OnTimerRecord(void* context, const AppEvent_Record_t* record)
+{
+    DigitalPatternEvent_t* const binding = (DigitalPatternEvent_t*)context;
+
+    binding->timerArmed = false;
+    PatternMatcher_Expire(&binding->matcher, record->timestamp);
+    CheckMatch(binding);
+    ArmTimer(binding);
+}
+
+/* Only the queue callbacks are used */
+static void OnUnusedCallback(void)
+{
+}
+
+bool DigitalPatternEvent_Register(DigitalPatternEvent_t* binding, const char* const name, const PatternNode_t* nodes,
+                                  Gpio_t* gpio, uint8_t matchEventId, uint32_t patternId)
+{
+    ASSERT(binding != NULL);
+    ASSERT(gpio != NULL);
+
+    PatternMatcher_Init(&binding->matcher, nodes);
+    binding->patternId = patternId;
+    binding->matchEventId = matchEventId;
+    binding->timerArmed = false;
+    binding->dropCount = 0;
+    binding->resyncing = false;
+
+    AppEvent_RegisterInterrupt(&binding->edgeEventId, name, OnUnusedCallback, gpio, IRQ_RISING_FALLING_EDGE,
+                               IRQ_HIGH_PRIORITY, APP_EVENT_CONTEXT_MAIN);
+    AppEvent_RegisterTimer(&binding->timerEventId, name, OnUnusedCallback, PATTERN_EVENT_TIMEOUT_MIN,
+                           APP_EVENT_CONTEXT_MAIN);
+    if (!AppEvent_EnableQueue(binding->edgeEventId, binding->edges, PATTERN_EVENT_QUEUE_SIZE, OnEdgeRecord, binding) ||
+        !AppEvent_EnableQueue(binding->timerEventId, &binding->expiry, 1, OnTimerRecord, binding))
+    {
+        DigitalPatternEvent_Unregister(binding);
+        return false;
+    }
+    AppEvent_SetPriority(binding->edgeEventId, APP_EVENT_PRIORITY_HIGH);
+
+    return true;
+}
+
+void DigitalPatternEvent_Unregister(DigitalPatternEvent_t* binding)
+{
+    ASSERT(binding != NULL);
+
+    AppEvent_Unregister(binding->edgeEventId);
+    AppEvent_Unregister(binding->timerEventId);
+    binding->timerArmed = false;
+}
+
+void DigitalPatternEvent_Start(DigitalPatternEvent_t* binding)
+{
+    ASSERT(binding != NULL);
+
+    PatternMatcher_Reset(&binding->matcher);
+    binding->dropCount = AppEvent_GetDropCount(binding->edgeEventId);
+    binding->resyncing = false;
+    AppEvent_Start(binding->edgeEventId, false);
+}
+
+void DigitalPatternEvent_Stop(DigitalPatternEvent_t* binding)
+{
+    ASSERT(binding != NULL);
+
+    AppEvent_Stop(binding->edgeEventId);
+    AppEvent_Stop(binding->timerEventId);
+    binding->timerArmed = false;
+}
+
+#endif /* APP_EVENT_STATIC_TABLE */
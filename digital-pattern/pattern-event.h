@@ -0,0 +1,92 @@
+#ifndef PATTERN_EVENT_H
+#define PATTERN_EVENT_H
+
+/*
+ * Binding of a compiled pattern (see DigitalPattern_Compile()) to the event module.
+ *
+ * The input edges come through an AppEvent interrupt event and the deadline of the matcher through
+ * an AppEvent timer event, both queued (AppEvent_EnableQueue()) so that the matcher runs from the
+ * main loop against the timestamps of the triggers. A completed match triggers an application event
+ * with the pattern id as payload, so nothing needs to poll DigitalPattern_Check() and the main loop
+ * can sleep until something happens:
+ *
+ *     static DigitalPatternEvent_t m_doublePress;
+ *     static uint8_t m_buttonEventId;
+ *
+ *     AppEvent_RegisterEvent(&m_buttonEventId, "button", OnButtonPattern, APP_EVENT_CONTEXT_MAIN);
+ *     DigitalPatternEvent_Register(&m_doublePress, "double press", m_doublePressNodes, &m_buttonGpio,
+ *                                  m_buttonEventId, BUTTON_DOUBLE_PRESS);
+ *     DigitalPatternEvent_Start(&m_doublePress);
+ *
+ * Not available with APP_EVENT_STATIC_TABLE, where the events cannot be registered at runtime.
+ */
+
+#include "digital-pattern.h"
+#include "event.h"
+
+/* Edges queued between two passes of the main loop. When edges are lost to a full queue, the edges
+ * queued before them are skipped and the matcher starts over from the next edge. */
+#ifndef PATTERN_EVENT_QUEUE_SIZE
+#define PATTERN_EVENT_QUEUE_SIZE    16
+#endif
+
+/* Shortest timeout of the deadline timer in ms, the event module recommends no less for main context timers.
+ * A deadline closer than that is served late, the matcher still times out at the deadline itself. */
+#ifndef PATTERN_EVENT_TIMEOUT_MIN
+#define PATTERN_EVENT_TIMEOUT_MIN   6
+#endif
+
+typedef struct
+{
+    PatternMatcher_t matcher;
+    uint32_t patternId;             /* Payload of the match event */
+    uint8_t matchEventId;
+    uint8_t edgeEventId;
+    uint8_t timerEventId;
+    bool timerArmed;
+    TimerTime_t timerDeadline;
+    uint32_t dropCount;             /* Edge drops already handled */
+    bool resyncing;                 /* Skipping the edges queued before a drop */
+    TimerTime_t resyncTime;         /* Edges up to this time are skipped */
+    AppEvent_Record_t edges[PATTERN_EVENT_QUEUE_SIZE];
+    AppEvent_Record_t expiry;
+} DigitalPatternEvent_t;
+
+#ifndef APP_EVENT_STATIC_TABLE
+/*
+ * @brief Registers the interrupt and timer events of a pattern
+ *
+ * @param binding, pointer to the binding struct, must stay valid while it is registered
+ * @param name, name of the events (for debugging purposes)
+ * @param nodes, transition table, must stay valid while the binding is registered
+ * @param gpio, input pin of the pattern
+ * @param matchEventId, event triggered by each match, from the main loop
+ * @param patternId, payload of the match trigger, see AppEvent_TriggerWithPayload()
+ * @return false if the record queues cannot be enabled, the events are unregistered again
+ */
+bool DigitalPatternEvent_Register(DigitalPatternEvent_t* binding, const char* const name, const PatternNode_t* nodes,
+                                  Gpio_t* gpio, uint8_t matchEventId, uint32_t patternId);
+
+/*
+ * @brief Stops the pattern and unregisters its events
+ *
+ * @param binding, pointer to the binding struct
+ */
+void DigitalPatternEvent_Unregister(DigitalPatternEvent_t* binding);
+
+/*
+ * @brief Starts watching the input, from the idle node
+ *
+ * @param binding, pointer to the binding struct
+ */
+void DigitalPatternEvent_Start(DigitalPatternEvent_t* binding);
+
+/*
+ * @brief Stops watching the input
+ *
+ * @param binding, pointer to the binding struct
+ */
+void DigitalPatternEvent_Stop(DigitalPatternEvent_t* binding);
+#endif /* APP_EVENT_STATIC_TABLE */
+
+#endif /* PATTERN_EVENT_H */
@@ -0,0 +1,1153 @@
+/*
+TEST digital-pattern module
+Stress and scaling suite against the host HAL simulation (make test).
+
+Generated button streams of double presses, single presses and long presses, the expected match
+count of each stream known, run through:
+ - 1 to 16 compiled patterns over the same stream, scanned and edge by edge
+ - a pattern bank of 1 to 32 channels
+ - the debounce stage, over a stream with contact bounce on every edge
+ - a set of single and double press patterns on one simulated button
+ - compiled pattern sets against stepping each pattern, and with timed patterns against one matcher each
+ - the edge capture mode, processed late and overflowing, and with the debounce stage enabled
+ - random built patterns against their compiled tables, over the same random edges
+ - 1 to 15 patterns bound to the event module (pattern-event.h), two events and one interrupt line each
+
+Each result is one JSON object per line on stdout, for tracking over time:
+
+    {"suite":"digital-pattern","test":"scan_patterns","patterns":4,...,"scan_edges_per_s":...}
+
+A failed check prints an "error" line and makes the suite exit with 1.
+*/
+#include "AppDebugConfig.h"
+#include "cycle-counter.h"
+#include "digital-pattern.h"
+#include "pattern-event.h"
+#include "sim.h"
+#include "timer-time.h"
+#include <stdio.h>
+
+#define STRESS_GESTURES         20000
+#define STRESS_MAX_EDGES        (STRESS_GESTURES * 12)
+#define STRESS_MAX_PATTERNS     16
+#define STRESS_CHANNELS         32
+#define STRESS_CHANNEL_GESTURES 500
+#define STRESS_BINDINGS         15
+#define STRESS_BINDING_GESTURES 100
+#define STRESS_NODES            16
+#define STRESS_TICK             10      /* ms, bank tick and main loop pass period */
+#define STRESS_STABLE_TIME      5       /* ms, longer than the bounce */
+
+#define CHECK(test, condition) \
+    do { if (!(condition)) { Fail((test), #condition, __LINE__); } } while (0)
+
+typedef struct
+{
+    PatternEdge_t* edges;
+    uint32_t maxEdges;
+    uint32_t numEdges;
+    TimerTime_t end;                /* Idle past the deadlines of the last gesture */
+    uint32_t numDoublePresses;      /* Matches of the double press pattern */
+    uint32_t numLongPresses;        /* Matches of the long press pattern */
+    uint32_t random;
+} Stream_t;
+
+static PatternEdge_t m_edges[STRESS_MAX_EDGES];
+static PatternEdge_t m_channelEdges[STRESS_CHANNELS][STRESS_CHANNEL_GESTURES * 4];
+static Stream_t m_channelStreams[STRESS_CHANNELS];
+static PatternNode_t m_doublePressNodes[STRESS_NODES];
+static PatternNode_t m_longPressNodes[STRESS_NODES];
+static uint8_t m_numDoublePressNodes;
+static uint32_t m_storage[PATTERN_ARENA_WORDS(2, 3, 1) + (2 * STRESS_NODES)];
+static uint32_t m_failures;
+
+static DigitalPatternEvent_t m_bindings[STRESS_BINDINGS];
+static Gpio_t m_bindingPins[STRESS_BINDINGS];
+static uint32_t m_bindingMatches[STRESS_BINDINGS];
+static AppEvent_Record_t m_matchRecords[128];
+static uint32_t m_nodeChanges;
+static uint32_t m_nodeHash;         /* Of the node sequence, see Test_OnPatternNode() */
+
+static void Fail(const char* test, const char* condition, int line)
+{
+    printf("{\"suite\":\"digital-pattern\",\"test\":\"%s\",\"error\":\"%s\",\"line\":%d}\n", test, condition, line);
+    ++m_failures;
+}
+
+/* DIGITAL_PATTERN_HOOK_NODE() of the test build */
+void Test_OnPatternNode(const void* matcher, uint8_t node)
+{
+    (void)matcher;
+    m_nodeHash = (m_nodeHash * 31u) + node + 1;
+    ++m_nodeChanges;
+}
+
+static double PerSecond(uint64_t count, uint32_t ticks)
+{
+    return (ticks > 0) ? ((double)count * 1e9) / ticks : 0.0;
+}
+
+/* xorshift32, so that the streams do not depend on the libc rand() */
+static uint32_t Random(Stream_t* stream, uint32_t range)
+{
+    uint32_t x = stream->random;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    stream->random = x;
+    return x % range;
+}
+
+/* Edge at @p time, with 2 bounces of 1 ms after it if @p bounce */
+static void AddEdge(Stream_t* stream, TimerTime_t time, INPUT_STATE state, bool bounce)
+{
+    const INPUT_STATE other = (state == INPUT_LOW) ? INPUT_HIGH : INPUT_LOW;
+    const uint8_t numEdges = bounce ? 3 : 1;
+
+    if (stream->numEdges + numEdges > stream->maxEdges)
+    {
+        return;
+    }
+    for (uint8_t i = 0; i < numEdges; ++i)
+    {
+        stream->edges[stream->numEdges].timestamp = time + i;
+        stream->edges[stream->numEdges].state = (i == 1) ? other : state;
+        ++stream->numEdges;
+    }
+}
+
+static TimerTime_t AddPress(Stream_t* stream, TimerTime_t time, uint32_t duration, bool bounce)
+{
+    AddEdge(stream, time, INPUT_LOW, bounce);
+    AddEdge(stream, time + duration, INPUT_HIGH, bounce);
+    return time + duration;
+}
+
+/*
+ * Gestures on an input idle high, all times multiples of STRESS_TICK:
+ *  - double press: two presses of 60-110 ms, 100-190 ms apart
+ *  - single press of 100-290 ms
+ *  - long press of 1000-1990 ms
+ * each followed by 1-3 s of idle.
+ */
+static void GenerateStream(Stream_t* stream, PatternEdge_t* edges, uint32_t maxEdges, uint32_t numGestures,
+                           uint32_t seed, bool bounce)
+{
+    TimerTime_t time = 1000;
+
+    stream->edges = edges;
+    stream->maxEdges = maxEdges;
+    stream->numEdges = 0;
+    stream->numDoublePresses = 0;
+    stream->numLongPresses = 0;
+    stream->random = seed;
+
+    for (uint32_t i = 0; i < numGestures; ++i)
+    {
+        switch (Random(stream, 3))
+        {
+            case 0:
+                time = AddPress(stream, time, 60 + (10 * Random(stream, 6)), bounce);
+                time = AddPress(stream, time + 100 + (10 * Random(stream, 10)), 60 + (10 * Random(stream, 6)), bounce);
+                ++stream->numDoublePresses;
+                break;
+            case 1:
+                time = AddPress(stream, time, 100 + (10 * Random(stream, 20)), bounce);
+                break;
+            default:
+                time = AddPress(stream, time, 1000 + (10 * Random(stream, 100)), bounce);
+                ++stream->numLongPresses;
+                break;
+        }
+        time += 1000 + (10 * Random(stream, 200));
+    }
+    stream->end = time;
+}
+
+static uint32_t ExpectedMatches(const Stream_t* stream, const PatternNode_t* nodes)
+{
+    return (nodes == m_doublePressNodes) ? stream->numDoublePresses : stream->numLongPresses;
+}
+
+/* numPatterns matchers, double press and long press in turn, over the same stream */
+static void TestScanPatterns(const Stream_t* stream, uint8_t numPatterns)
+{
+    uint64_t scanMatches = 0;
+    uint64_t edgeMatches = 0;
+    uint32_t expected = 0;
+
+    const uint32_t scanStart = CycleCounter_Get();
+    for (uint8_t i = 0; i < numPatterns; ++i)
+    {
+        const PatternNode_t* const nodes = (i & 1) ? m_longPressNodes : m_doublePressNodes;
+        const uint32_t numMatches = DigitalPattern_Scan(nodes, stream->edges, stream->numEdges, stream->end, NULL, 0);
+
+        CHECK("scan_patterns", numMatches == ExpectedMatches(stream, nodes));
+        scanMatches += numMatches;
+        expected += ExpectedMatches(stream, nodes);
+    }
+    const uint32_t scanElapsed = CycleCounter_Get() - scanStart;
+
+    const uint32_t edgeStart = CycleCounter_Get();
+    for (uint8_t i = 0; i < numPatterns; ++i)
+    {
+        const PatternNode_t* const nodes = (i & 1) ? m_longPressNodes : m_doublePressNodes;
+        PatternMatcher_t matcher;
+
+        PatternMatcher_Init(&matcher, nodes);
+        for (uint32_t j = 0; j < stream->numEdges; ++j)
+        {
+            PatternMatcher_Edge(&matcher, stream->edges[j].state, stream->edges[j].timestamp);
+            edgeMatches += PatternMatcher_Check(&matcher);
+        }
+        PatternMatcher_Expire(&matcher, stream->end);
+        edgeMatches += PatternMatcher_Check(&matcher);
+    }
+    const uint32_t edgeElapsed = CycleCounter_Get() - edgeStart;
+    CHECK("scan_patterns", edgeMatches == expected);
+
+    const uint64_t edges = (uint64_t)numPatterns * stream->numEdges;
+    printf("{\"suite\":\"digital-pattern\",\"test\":\"scan_patterns\",\"patterns\":%u,\"edges\":%llu,"
+           "\"matches\":%llu,\"expected\":%lu,\"scan_edges_per_s\":%.0f,\"edge_edges_per_s\":%.0f}\n",
+           numPatterns, (unsigned long long)edges, (unsigned long long)scanMatches, (unsigned long)expected,
+           PerSecond(edges, scanElapsed), PerSecond(edges, edgeElapsed));
+}
+
+/* numChannels inputs with their own streams, sampled every STRESS_TICK by one bank */
+static void TestBank(PatternArena_t* arena, uint8_t numChannels)
+{
+    const uint32_t channelMask = (numChannels < 32) ? ((1u << numChannels) - 1) : 0xFFFFFFFFu;
+    uint32_t next[STRESS_CHANNELS] = { 0 };
+    uint32_t matches[STRESS_CHANNELS] = { 0 };
+    uint32_t levels = 0xFFFFFFFFu;
+    uint64_t edges = 0;
+    uint64_t ticks = 0;
+    TimerTime_t end = 0;
+    const size_t used = arena->used;
+    DigitalPatternBank_t bank;
+
+    for (uint8_t channel = 0; channel < numChannels; ++channel)
+    {
+        end = (m_channelStreams[channel].end > end) ? m_channelStreams[channel].end : end;
+        edges += m_channelStreams[channel].numEdges;
+    }
+    DigitalPatternBank_Init(&bank, m_doublePressNodes, m_numDoublePressNodes, arena, STRESS_TICK, channelMask,
+                            NULL, NULL);
+
+    const uint32_t start = CycleCounter_Get();
+    for (TimerTime_t time = STRESS_TICK; time <= end; time += STRESS_TICK, ++ticks)
+    {
+        for (uint8_t channel = 0; channel < numChannels; ++channel)
+        {
+            const Stream_t* const stream = &m_channelStreams[channel];
+            while ((next[channel] < stream->numEdges) && (stream->edges[next[channel]].timestamp <= time))
+            {
+                const bool high = stream->edges[next[channel]++].state == INPUT_HIGH;
+                levels = high ? (levels | (1u << channel)) : (levels & ~(1u << channel));
+            }
+        }
+        DigitalPatternBank_Sample(&bank, levels);
+        for (uint32_t matched = DigitalPatternBank_Check(&bank); matched != 0; matched &= matched - 1)
+        {
+            ++matches[__builtin_ctz(matched)];
+        }
+    }
+    const uint32_t elapsed = CycleCounter_Get() - start;
+    arena->used = used;     /* The next bank reuses the node masks */
+
+    uint64_t numMatches = 0;
+    uint64_t expected = 0;
+    for (uint8_t channel = 0; channel < numChannels; ++channel)
+    {
+        CHECK("bank_channels", matches[channel] == m_channelStreams[channel].numDoublePresses);
+        numMatches += matches[channel];
+        expected += m_channelStreams[channel].numDoublePresses;
+    }
+
+    printf("{\"suite\":\"digital-pattern\",\"test\":\"bank_channels\",\"channels\":%u,\"ticks\":%llu,\"edges\":%llu,"
+           "\"matches\":%llu,\"expected\":%llu,\"ticks_per_s\":%.0f,\"edges_per_s\":%.0f}\n",
+           numChannels, (unsigned long long)ticks, (unsigned long long)edges, (unsigned long long)numMatches,
+           (unsigned long long)expected, PerSecond(ticks, elapsed), PerSecond(edges, elapsed));
+}
+
+/* Contact bounce on every edge: the matcher alone misses, behind the debounce stage it does not */
+static void TestDebounce(const Stream_t* stream)
+{
+    PatternDebounce_t debounce;
+    PatternMatcher_t matcher;
+    PatternEdge_t stable;
+    uint32_t numStable = 0;
+    uint32_t numMatches = 0;
+
+    const uint32_t rawMatches = DigitalPattern_Scan(m_doublePressNodes, stream->edges, stream->numEdges, stream->end,
+                                                    NULL, 0);
+
+    PatternDebounce_Init(&debounce, STRESS_STABLE_TIME, INPUT_HIGH);
+    PatternMatcher_Init(&matcher, m_doublePressNodes);
+    const uint32_t start = CycleCounter_Get();
+    for (uint32_t i = 0; i < stream->numEdges; ++i)
+    {
+        if (PatternDebounce_Edge(&debounce, stream->edges[i].state, stream->edges[i].timestamp, &stable))
+        {
+            PatternMatcher_Edge(&matcher, stable.state, stable.timestamp);
+            numMatches += PatternMatcher_Check(&matcher);
+            ++numStable;
+        }
+    }
+    if (PatternDebounce_Expire(&debounce, stream->end, &stable))
+    {
+        PatternMatcher_Edge(&matcher, stable.state, stable.timestamp);
+        ++numStable;
+    }
+    PatternMatcher_Expire(&matcher, stream->end);
+    numMatches += PatternMatcher_Check(&matcher);
+    const uint32_t elapsed = CycleCounter_Get() - start;
+
+    CHECK("debounce", numMatches == stream->numDoublePresses);
+    CHECK("debounce", numStable * 3 == stream->numEdges);
+    CHECK("debounce", rawMatches < stream->numDoublePresses);
+
+    printf("{\"suite\":\"digital-pattern\",\"test\":\"debounce\",\"edges\":%lu,\"stable_edges\":%lu,"
+           "\"raw_matches\":%lu,\"matches\":%lu,\"expected\":%lu,\"edges_per_s\":%.0f}\n",
+           (unsigned long)stream->numEdges, (unsigned long)numStable, (unsigned long)rawMatches,
+           (unsigned long)numMatches, (unsigned long)stream->numDoublePresses, PerSecond(stream->numEdges, elapsed));
+}
+
+static void OnSetEdge(void* context)
+{
+    OnDigitalPatternSetEvent((DigitalPatternSet_t*)context);
+}
+
+/* Press held @p hold ms, then released for @p gap ms */
+static void Press(Gpio_t* pin, uint32_t hold, uint32_t gap)
+{
+    SimGpio_Write(pin, false);
+    SimTimer_Advance(hold);
+    SimGpio_Write(pin, true);
+    SimTimer_Advance(gap);
+}
+
+/* @p numPresses presses within @p window ms, then 400 ms without input */
+static void AddPresses(DigitalPattern_t* pattern, PatternArena_t* arena, Gpio_t* pin, uint8_t numPresses,
+                       uint32_t window)
+{
+    DigitalPattern_Init(pattern, pin, arena, 2);
+    PatternPhase_t* const presses = DigitalPattern_AddPhase(pattern, window, false);
+    for (uint8_t i = 0; i < numPresses; ++i)
+    {
+        DigitalPattern_AddState(presses, INPUT_LOW);
+        DigitalPattern_AddState(presses, INPUT_HIGH);
+    }
+    DigitalPattern_AddPhase(pattern, 400, true);
+}
+
+/* Single and double press of one button in a set: each gesture reports its own pattern only, with the
+ * deadlines of both patterns served by the set timer */
+static void TestPatternSet(void)
+{
+    static uint32_t storage[PATTERN_ARENA_WORDS(2, 4, 0)];
+    static Gpio_t pin;
+    static DigitalPattern_t singlePress;
+    static DigitalPattern_t doublePress;
+    static DigitalPatternSet_t set;
+    PatternArena_t arena;
+
+    SimTimer_Reset();
+    pin = (Gpio_t){ .intNo = 0, .value = true };
+    PatternArena_Init(&arena, storage, sizeof(storage));
+    AddPresses(&singlePress, &arena, &pin, 1, 300);
+    AddPresses(&doublePress, &arena, &pin, 2, 700);
+    DigitalPatternSet_Init(&set, &pin);
+    const uint8_t single = DigitalPatternSet_AddPattern(&set, &singlePress);
+    const uint8_t dual = DigitalPatternSet_AddPattern(&set, &doublePress);
+    GpioMcuSetContext(&pin, &set);
+    GpioSetInterrupt(&pin, IRQ_RISING_FALLING_EDGE, IRQ_HIGH_PRIORITY, OnSetEdge);
+
+    Press(&pin, 80, 1000);
+    const int8_t afterSingle = DigitalPatternSet_Check(&set);
+    CHECK("pattern_set", afterSingle == single);
+    CHECK("pattern_set", DigitalPatternSet_Check(&set) == -1);
+
+    Press(&pin, 80, 150);
+    Press(&pin, 80, 1000);
+    const int8_t afterDouble = DigitalPatternSet_Check(&set);
+    CHECK("pattern_set", afterDouble == dual);
+    CHECK("pattern_set", DigitalPatternSet_Check(&set) == -1);
+
+    /* Too slow for either pattern */
+    Press(&pin, 500, 1000);
+    CHECK("pattern_set", DigitalPatternSet_Check(&set) == -1);
+    CHECK("pattern_set", !set.timerArmed);
+
+    GpioSetInterrupt(&pin, NO_IRQ, IRQ_HIGH_PRIORITY, NULL);
+    printf("{\"suite\":\"digital-pattern\",\"test\":\"pattern_set\",\"patterns\":%u,\"single\":%d,\"double\":%d,"
+           "\"alarm_writes\":%lu}\n", set.numPatterns, afterSingle, afterDouble,
+           (unsigned long)SimTimer_GetAlarmWrites());
+}
+
+/* Single, double and triple presses of random windows, in a set compiled with DigitalPatternSet_Compile()
+ * and in one stepping each pattern: both report the same patterns at every tick of a random input,
+ * deadlines included. The sets of every third trial given no product table storage or one node too few
+ * are not compiled: they keep stepping each pattern, with the same matches. */
+static void TestSetCompile(uint32_t numTrials)
+{
+    static uint32_t storage[PATTERN_ARENA_WORDS(7, 13, 1)];
+    static PatternNode_t nodes[3 * STRESS_NODES];
+    static PatternSetNode_t setNodes[UINT8_MAX];
+    static Gpio_t pin;
+    static DigitalPattern_t patterns[2][3];
+    static DigitalPatternSet_t sets[2];
+    Stream_t random = { .random = 23 };
+    uint32_t mismatches = 0;
+    uint64_t numMatches = 0;
+    uint8_t maxSetNodes = 0;
+    uint8_t numSetNodes = 0;
+
+    for (uint32_t trial = 0; trial < numTrials; ++trial)
+    {
+        uint32_t windows[3];
+        PatternArena_t arena;
+        TimerTime_t quietUntil = 0;
+        bool level = true;
+
+        SimTimer_Reset();
+        pin = (Gpio_t){ .intNo = 0, .value = true };
+        PatternArena_Init(&arena, storage, sizeof(storage));
+        for (uint8_t i = 0; i < 3; ++i)
+        {
+            windows[i] = 10 * (10 + Random(&random, 60));
+        }
+        for (uint8_t s = 0; s < 2; ++s)
+        {
+            DigitalPatternSet_Init(&sets[s], &pin);
+            for (uint8_t i = 0; i < 3; ++i)
+            {
+                AddPresses(&patterns[s][i], &arena, &pin, 1 + i, windows[i]);
+                DigitalPatternSet_AddPattern(&sets[s], &patterns[s][i]);
+            }
+        }
+        numSetNodes = DigitalPatternSet_Compile(&sets[1], nodes, sizeof(nodes) / sizeof(nodes[0]), setNodes,
+                                                sizeof(setNodes) / sizeof(setNodes[0]));
+        CHECK("set_compile", numSetNodes > 0);
+        maxSetNodes = (numSetNodes > maxSetNodes) ? numSetNodes : maxSetNodes;
+        if ((trial % 3) != 0)
+        {
+            const uint8_t tooFew = (trial % 3 == 1) ? 0 : numSetNodes - 1;
+            CHECK("set_compile", DigitalPatternSet_Compile(&sets[1], nodes, sizeof(nodes) / sizeof(nodes[0]),
+                                                           setNodes, tooFew) == 0);
+            CHECK("set_compile", sets[1].setNodes == NULL);
+        }
+
+        for (uint32_t t = 0; t < 5000; ++t)
+        {
+            SimTimer_Advance(1);
+            /* Bursts of edges about 40 ms apart, released bursts sometimes followed by a pause */
+            if (TimerTime_IsBefore(quietUntil, TimerGetCurrentTime()) && (Random(&random, 40) == 0))
+            {
+                level = !level;
+                if (level && (Random(&random, 3) == 0))
+                {
+                    quietUntil = TimerGetCurrentTime() + 300 + Random(&random, 700);
+                }
+                for (uint8_t s = 0; s < 2; ++s)
+                {
+                    DigitalPatternSet_ProcessEdge(&sets[s], level ? INPUT_HIGH : INPUT_LOW, TimerGetCurrentTime());
+                }
+            }
+            for (int8_t index = DigitalPatternSet_Check(&sets[0]); index >= 0; index = DigitalPatternSet_Check(&sets[0]))
+            {
+                mismatches += (DigitalPatternSet_Check(&sets[1]) != index);
+                ++numMatches;
+            }
+            mismatches += (DigitalPatternSet_Check(&sets[1]) != -1);
+        }
+        for (uint8_t s = 0; s < 2; ++s)
+        {
+            TimerStop(&sets[s].timer);
+        }
+    }
+
+    CHECK("set_compile", mismatches == 0);
+    CHECK("set_compile", numMatches > 0);
+    printf("{\"suite\":\"digital-pattern\",\"test\":\"set_compile\",\"sets\":%lu,\"max_set_nodes\":%u,"
+           "\"matches\":%llu,\"mismatches\":%lu}\n", (unsigned long)numTrials, maxSetNodes,
+           (unsigned long long)numMatches, (unsigned long)mismatches);
+}
+
+/* A hold of @p state for [@p minDuration, @p maxDuration] ms, then of @p next for @p nextDuration ms if
+ * @p nextDuration is not 0 */
+static void AddHolds(DigitalPattern_t* pattern, PatternArena_t* arena, Gpio_t* pin, INPUT_STATE state,
+                     uint16_t minDuration, uint16_t maxDuration, INPUT_STATE next, uint16_t nextDuration)
+{
+    DigitalPattern_Init(pattern, pin, arena, 1);
+    PatternPhase_t* const holds = DigitalPattern_AddTimedPhase(pattern, 0, (nextDuration != 0) ? 2 : 1);
+    DigitalPattern_AddTimedState(holds, state, minDuration, maxDuration);
+    if (nextDuration != 0)
+    {
+        DigitalPattern_AddTimedState(holds, next, nextDuration, PATTERN_DURATION_ANY);
+    }
+}
+
+/* Matchers matched since the last call, by index, all reset if any matched as the patterns of a set are */
+static uint8_t CollectMatchers(PatternMatcher_t* matchers, uint8_t numMatchers)
+{
+    uint8_t matched = 0;
+
+    for (uint8_t i = 0; i < numMatchers; ++i)
+    {
+        matched |= (uint8_t)(PatternMatcher_Check(&matchers[i]) << i);
+    }
+    for (uint8_t i = 0; (i < numMatchers) && (matched != 0); ++i)
+    {
+        PatternMatcher_Reset(&matchers[i]);
+    }
+    return matched;
+}
+
+/* A single press, a long press, a long release and a press released in a window then left released,
+ * of random durations, in a compiled set: at every tick of a random input it reports the matches of one
+ * matcher per pattern table. Releases often come early for both presses held. */
+static void TestTimedSetCompile(uint32_t numTrials)
+{
+    static uint32_t storage[PATTERN_ARENA_WORDS(4, 5, 4)];
+    static PatternNode_t nodes[4 * STRESS_NODES];
+    static PatternSetNode_t setNodes[UINT8_MAX];
+    static Gpio_t pin;
+    static DigitalPattern_t patterns[4];
+    static DigitalPatternSet_t set;
+    Stream_t random = { .random = 29 };
+    uint32_t patternMatches[4] = { 0 };
+    uint32_t mismatches = 0;
+    uint8_t maxSetNodes = 0;
+
+    for (uint32_t trial = 0; trial < numTrials; ++trial)
+    {
+        PatternMatcher_t matchers[4];
+        PatternArena_t arena;
+        TimerTime_t nextEdge = 0;
+        bool level = true;
+
+        SimTimer_Reset();
+        pin = (Gpio_t){ .intNo = 0, .value = true };
+        PatternArena_Init(&arena, storage, sizeof(storage));
+        const uint16_t longHold = (uint16_t)(10 * (10 + Random(&random, 30)));
+        const uint16_t press = (uint16_t)(10 * (3 + Random(&random, 10)));
+        AddPresses(&patterns[0], &arena, &pin, 1, 10 * (10 + Random(&random, 60)));
+        AddHolds(&patterns[1], &arena, &pin, INPUT_LOW, longHold, PATTERN_DURATION_ANY, INPUT_HIGH, 0);
+        AddHolds(&patterns[2], &arena, &pin, INPUT_HIGH, (uint16_t)(10 * (20 + Random(&random, 40))),
+                 PATTERN_DURATION_ANY, INPUT_HIGH, 0);
+        AddHolds(&patterns[3], &arena, &pin, INPUT_LOW, press, (uint16_t)(press + (10 * (2 + Random(&random, 20)))),
+                 INPUT_HIGH, (uint16_t)(10 * (5 + Random(&random, 20))));
+        DigitalPatternSet_Init(&set, &pin);
+        for (uint8_t i = 0; i < 4; ++i)
+        {
+            DigitalPatternSet_AddPattern(&set, &patterns[i]);
+        }
+        const uint8_t numSetNodes = DigitalPatternSet_Compile(&set, nodes, sizeof(nodes) / sizeof(nodes[0]),
+                                                              setNodes, sizeof(setNodes) / sizeof(setNodes[0]));
+        CHECK("timed_set_compile", numSetNodes > 0);
+        maxSetNodes = (numSetNodes > maxSetNodes) ? numSetNodes : maxSetNodes;
+        for (uint8_t i = 0; i < 4; ++i)
+        {
+            PatternMatcher_Init(&matchers[i], set.tables[i]);
+        }
+
+        for (uint32_t t = 0; t < 5000; ++t)
+        {
+            const bool edge = !TimerTime_IsBefore(TimerGetCurrentTime() + 1, nextEdge);
+            uint8_t expected = 0;
+            uint8_t reported = 0;
+
+            SimTimer_Advance(1);
+            const TimerTime_t now = TimerGetCurrentTime();
+            for (uint8_t i = 0; i < 4; ++i)
+            {
+                PatternMatcher_Expire(&matchers[i], now);
+            }
+            expected |= CollectMatchers(matchers, 4);
+            if (edge)
+            {
+                level = !level;
+                nextEdge = now + 10 * (1 + Random(&random, 60));
+                DigitalPatternSet_ProcessEdge(&set, level ? INPUT_HIGH : INPUT_LOW, now);
+                for (uint8_t i = 0; i < 4; ++i)
+                {
+                    PatternMatcher_Edge(&matchers[i], level ? INPUT_HIGH : INPUT_LOW, now);
+                }
+                expected |= CollectMatchers(matchers, 4);
+            }
+            for (int8_t index = DigitalPatternSet_Check(&set); index >= 0; index = DigitalPatternSet_Check(&set))
+            {
+                reported |= (uint8_t)(1u << index);
+                ++patternMatches[index];
+            }
+            mismatches += (reported != expected);
+        }
+        TimerStop(&set.timer);
+    }
+
+    CHECK("timed_set_compile", mismatches == 0);
+    for (uint8_t i = 0; i < 4; ++i)
+    {
+        CHECK("timed_set_compile", patternMatches[i] > 0);
+    }
+    printf("{\"suite\":\"digital-pattern\",\"test\":\"timed_set_compile\",\"sets\":%lu,\"max_set_nodes\":%u,"
+           "\"matches\":[%lu,%lu,%lu,%lu],\"mismatches\":%lu}\n", (unsigned long)numTrials, maxSetNodes,
+           (unsigned long)patternMatches[0], (unsigned long)patternMatches[1], (unsigned long)patternMatches[2],
+           (unsigned long)patternMatches[3], (unsigned long)mismatches);
+}
+
+static uint32_t m_notifications;
+
+static void OnCaptureNotify(void* context)
+{
+    (void)context;
+    ++m_notifications;
+}
+
+/* Edge capture mode with the main loop late: a double press is matched from the edge timestamps once
+ * processed 1 s after it, a too slow one is not, and a buffer overflow drops the edges past its size
+ * and resets the pattern */
+static void TestCapture(void)
+{
+    static uint32_t storage[PATTERN_ARENA_WORDS(1, 2, 0)];
+    static PatternEdge_t edges[16];
+    static Gpio_t pin;
+    static DigitalPattern_t pattern;
+    PatternArena_t arena;
+
+    SimTimer_Reset();
+    m_notifications = 0;
+    pin = (Gpio_t){ .intNo = 0, .value = true };
+    PatternArena_Init(&arena, storage, sizeof(storage));
+    AddPresses(&pattern, &arena, &pin, 2, 700);
+    DigitalPattern_EnableCapture(&pattern, edges, 16, OnCaptureNotify, NULL);
+    GpioMcuSetContext(&pin, &pattern);
+    GpioSetInterrupt(&pin, IRQ_RISING_FALLING_EDGE, IRQ_HIGH_PRIORITY, OnDigitalPatternEdge);
+
+    Press(&pin, 50, 50);
+    Press(&pin, 50, 1000);
+    DigitalPattern_Process(&pattern);
+    const bool late = DigitalPattern_Check(&pattern);
+    CHECK("capture", late);
+    CHECK("capture", m_notifications >= 4);
+
+    Press(&pin, 50, 800);
+    Press(&pin, 50, 1000);
+    DigitalPattern_Process(&pattern);
+    const bool slow = DigitalPattern_Check(&pattern);
+    CHECK("capture", !slow);
+
+    for (uint8_t i = 0; i < 40; ++i)
+    {
+        SimGpio_Write(&pin, (i & 1) != 0);
+    }
+    DigitalPattern_Process(&pattern);
+    CHECK("capture", pattern.dropCount == 40 - 16);
+    CHECK("capture", !DigitalPattern_Check(&pattern));
+
+    /* Matching again after the overflow */
+    SimTimer_Advance(1000);
+    Press(&pin, 50, 50);
+    Press(&pin, 50, 1000);
+    DigitalPattern_Process(&pattern);
+    const bool recovered = DigitalPattern_Check(&pattern);
+    CHECK("capture", recovered);
+
+    GpioSetInterrupt(&pin, NO_IRQ, IRQ_HIGH_PRIORITY, NULL);
+    printf("{\"suite\":\"digital-pattern\",\"test\":\"capture\",\"late\":%d,\"slow\":%d,\"drops\":%lu,"
+           "\"recovered\":%d,\"notifications\":%lu}\n", late, slow, (unsigned long)pattern.dropCount, recovered,
+           (unsigned long)m_notifications);
+}
+
+/* Random patterns, each run as a built pattern in edge capture mode and as its compiled table over the
+ * same random edges, 1 ms per main loop pass: both match the same number of times */
+static void TestCompileEquivalence(uint32_t numTrials)
+{
+    static uint32_t storage[PATTERN_ARENA_WORDS(1, 5, 0)];
+    static PatternNode_t nodes[255];
+    static PatternEdge_t edges[8];
+    static Gpio_t pin;
+    static DigitalPattern_t pattern;
+    Stream_t random = { .random = 19 };
+    uint32_t mismatches = 0;
+    uint64_t numMatches = 0;
+
+    for (uint32_t trial = 0; trial < numTrials; ++trial)
+    {
+        const uint8_t numPhases = 1 + Random(&random, 5);
+        PatternArena_t arena;
+        PatternMatcher_t matcher;
+        bool level = true;
+        uint32_t structMatches = 0;
+        uint32_t tableMatches = 0;
+
+        SimTimer_Reset();
+        pin = (Gpio_t){ .intNo = 0, .value = true };
+        PatternArena_Init(&arena, storage, sizeof(storage));
+        DigitalPattern_Init(&pattern, &pin, &arena, numPhases);
+        for (uint8_t p = 0; p < numPhases; ++p)
+        {
+            /* Even durations, the edges come at odd times */
+            PatternPhase_t* const phase = DigitalPattern_AddPhase(&pattern, 2 * (10 + Random(&random, 40)),
+                                                                  Random(&random, 2) != 0);
+            const uint8_t numStates = ((p == 0) ? 1 : 0) + Random(&random, 12);
+
+            for (uint8_t s = 0; s < numStates; ++s)
+            {
+                DigitalPattern_AddState(phase, (Random(&random, 2) != 0) ? INPUT_HIGH : INPUT_LOW);
+            }
+        }
+        DigitalPattern_Compile(&pattern, nodes, DigitalPattern_NodeCount(&pattern));
+        PatternMatcher_Init(&matcher, nodes);
+        DigitalPattern_EnableCapture(&pattern, edges, 8, NULL, NULL);
+
+        for (uint32_t t = 0; t < 2000; ++t)
+        {
+            SimTimer_Advance(1);
+
+            const TimerTime_t now = TimerGetCurrentTime();
+            TimerTime_t deadline;
+            /* An edge at a deadline is ordered differently by the timer and by the matcher */
+            const bool atDeadline = PatternMatcher_GetDeadline(&matcher, &deadline) && (deadline == now);
+
+            if ((now & 1) && (Random(&random, 12) == 0) && !atDeadline)
+            {
+                if (Random(&random, 3) != 0)
+                {
+                    level = !level;
+                }
+
+                const INPUT_STATE state = level ? INPUT_HIGH : INPUT_LOW;
+
+                DigitalPattern_CaptureEdge(&pattern, state, now);
+                PatternMatcher_Edge(&matcher, state, now);
+            }
+            DigitalPattern_Process(&pattern);
+            PatternMatcher_Expire(&matcher, now);
+            structMatches += DigitalPattern_Check(&pattern);
+            tableMatches += PatternMatcher_Check(&matcher);
+        }
+        mismatches += (structMatches != tableMatches);
+        numMatches += structMatches;
+    }
+    TimerStop(&pattern.phaseTimer);
+
+    CHECK("compile_equivalence", mismatches == 0);
+    CHECK("compile_equivalence", numMatches > 0);
+    printf("{\"suite\":\"digital-pattern\",\"test\":\"compile_equivalence\",\"patterns\":%lu,\"matches\":%llu,"
+           "\"mismatching_patterns\":%lu}\n", (unsigned long)numTrials, (unsigned long long)numMatches,
+           (unsigned long)mismatches);
+}
+
+static void WriteBouncy(Gpio_t* pin, bool level)
+{
+    for (uint8_t i = 0; i < 3; ++i)
+    {
+        SimGpio_Write(pin, !level);
+        SimTimer_Advance(1);
+        SimGpio_Write(pin, level);
+        SimTimer_Advance(1);
+    }
+}
+
+/* Double presses with 3 bounces on every edge, processed on each notification: only matched with
+ * DigitalPattern_EnableDebounce() */
+static uint32_t RunBouncyPresses(bool debounce)
+{
+    static uint32_t storage[PATTERN_ARENA_WORDS(1, 2, 0)];
+    static PatternEdge_t edges[32];
+    static Gpio_t pin;
+    static DigitalPattern_t pattern;
+    PatternArena_t arena;
+    uint32_t numMatches = 0;
+
+    SimTimer_Reset();
+    pin = (Gpio_t){ .intNo = 0, .value = true };
+    PatternArena_Init(&arena, storage, sizeof(storage));
+    AddPresses(&pattern, &arena, &pin, 2, 700);
+    DigitalPattern_EnableCapture(&pattern, edges, 32, OnCaptureNotify, NULL);
+    if (debounce)
+    {
+        DigitalPattern_EnableDebounce(&pattern, 10);
+    }
+    GpioMcuSetContext(&pin, &pattern);
+    GpioSetInterrupt(&pin, IRQ_RISING_FALLING_EDGE, IRQ_HIGH_PRIORITY, OnDigitalPatternEdge);
+
+    for (uint8_t gesture = 0; gesture < 5; ++gesture)
+    {
+        WriteBouncy(&pin, false);
+        SimTimer_Advance(60);
+        WriteBouncy(&pin, true);
+        SimTimer_Advance(60);
+        WriteBouncy(&pin, false);
+        SimTimer_Advance(60);
+        WriteBouncy(&pin, true);
+        for (uint32_t t = 0; t < 1500; ++t)
+        {
+            SimTimer_Advance(1);
+            if (m_notifications != 0)
+            {
+                m_notifications = 0;
+                DigitalPattern_Process(&pattern);
+            }
+            numMatches += DigitalPattern_Check(&pattern);
+        }
+    }
+    GpioSetInterrupt(&pin, NO_IRQ, IRQ_HIGH_PRIORITY, NULL);
+    TimerStop(&pattern.phaseTimer);
+    return numMatches;
+}
+
+static void TestEnableDebounce(void)
+{
+    m_notifications = 0;
+    const uint32_t raw = RunBouncyPresses(false);
+    const uint32_t debounced = RunBouncyPresses(true);
+
+    CHECK("enable_debounce", raw < 5);
+    CHECK("enable_debounce", debounced == 5);
+    printf("{\"suite\":\"digital-pattern\",\"test\":\"enable_debounce\",\"gestures\":5,\"raw_matches\":%lu,"
+           "\"matches\":%lu}\n", (unsigned long)raw, (unsigned long)debounced);
+}
+
+#define TEST_RUN_MATCHES        64
+
+/* Steps @p matcher over one chunk of edges with PatternMatcher_Edge(), the deadlines one at a time, and
+ * returns the number of matches that are not the same as @p matches of PatternMatcher_Run() */
+static uint32_t CompareEdgeSteps(PatternMatcher_t* matcher, const PatternEdge_t* edges, uint32_t numEdges,
+                                 const PatternMatch_t* matches, uint32_t numMatches)
+{
+    uint32_t n = 0;
+    uint32_t mismatches = 0;
+    TimerTime_t deadline;
+
+    for (uint32_t j = 0; j < numEdges; ++j)
+    {
+        while (PatternMatcher_GetDeadline(matcher, &deadline) && !TimerTime_IsBefore(edges[j].timestamp, deadline))
+        {
+            PatternMatcher_Expire(matcher, deadline);
+            if (PatternMatcher_Check(matcher))
+            {
+                mismatches += (n >= numMatches) || (matches[n].edge != j) || (matches[n].time != deadline);
+                ++n;
+            }
+        }
+        PatternMatcher_Edge(matcher, edges[j].state, edges[j].timestamp);
+        if (PatternMatcher_Check(matcher))
+        {
+            mismatches += (n >= numMatches) || (matches[n].edge != j + 1) ||
+                          (matches[n].time != edges[j].timestamp);
+            ++n;
+        }
+    }
+    return mismatches + (n != numMatches);
+}
+
+/* Channel streams cut in chunks of random lengths, PatternMatcher_Run() on each chunk against
+ * PatternMatcher_Edge() on each edge: same matches, same node changes, and the same matcher state after
+ * every chunk */
+static void TestRunEquivalence(uint8_t numChannels)
+{
+    static PatternMatch_t matches[TEST_RUN_MATCHES];
+    Stream_t random = { .random = 23 };
+    uint32_t mismatches = 0;
+    uint32_t numChunks = 0;
+    uint64_t numMatches = 0;
+    uint64_t numNodeChanges = 0;
+
+    for (uint8_t channel = 0; channel < numChannels; ++channel)
+    {
+        for (uint8_t table = 0; table < 2; ++table)
+        {
+            const Stream_t* const stream = &m_channelStreams[channel];
+            const PatternNode_t* const nodes = (table != 0) ? m_longPressNodes : m_doublePressNodes;
+            PatternMatcher_t run;
+            PatternMatcher_t edge;
+
+            PatternMatcher_Init(&run, nodes);
+            PatternMatcher_Init(&edge, nodes);
+            for (uint32_t first = 0; first < stream->numEdges; ++numChunks)
+            {
+                const uint32_t left = stream->numEdges - first;
+                const uint32_t count = 1 + Random(&random, 40);
+                const uint32_t numEdges = (count < left) ? count : left;
+
+                m_nodeChanges = 0;
+                m_nodeHash = 0;
+                const uint32_t runMatches = PatternMatcher_Run(&run, &stream->edges[first], numEdges, matches,
+                                                               TEST_RUN_MATCHES);
+                const uint32_t runChanges = m_nodeChanges;
+                const uint32_t runHash = m_nodeHash;
+
+                m_nodeChanges = 0;
+                m_nodeHash = 0;
+                mismatches += CompareEdgeSteps(&edge, &stream->edges[first], numEdges, matches, runMatches);
+                mismatches += (m_nodeChanges != runChanges) || (m_nodeHash != runHash);
+                mismatches += PatternMatcher_Check(&run) != (runMatches != 0);
+                mismatches += (run.node != edge.node) || (run.deadlineArmed != edge.deadlineArmed) ||
+                              (run.deadlineArmed && (run.deadline != edge.deadline)) || (run.since != edge.since);
+                numMatches += runMatches;
+                numNodeChanges += runChanges;
+                first += numEdges;
+            }
+        }
+    }
+
+    CHECK("run_equivalence", mismatches == 0);
+    CHECK("run_equivalence", (numMatches != 0) && (numNodeChanges != 0));
+    printf("{\"suite\":\"digital-pattern\",\"test\":\"run_equivalence\",\"channels\":%u,\"chunks\":%lu,"
+           "\"matches\":%llu,\"node_changes\":%llu,\"mismatches\":%lu}\n", numChannels, (unsigned long)numChunks,
+           (unsigned long long)numMatches, (unsigned long long)numNodeChanges, (unsigned long)mismatches);
+}
+
+static void OnMatch(void)
+{
+}
+
+static void OnMatchRecord(void* context, const AppEvent_Record_t* record)
+{
+    (void)context;
+    ++m_bindingMatches[record->payload];
+}
+
+/* numBindings double press bindings, each on its own interrupt line and stream, main loop passes
+ * every STRESS_TICK of simulated time */
+static void TestEventBindings(uint8_t numBindings)
+{
+    uint32_t next[STRESS_BINDINGS] = { 0 };
+    uint64_t edges = 0;
+    TimerTime_t end = 0;
+    uint8_t matchEventId;
+
+    AppEvent_DeInit();
+    SimTimer_Reset();
+    AppEvent_Init();
+    AppEvent_RegisterEvent(&matchEventId, "match", OnMatch, APP_EVENT_CONTEXT_MAIN);
+    AppEvent_EnableQueue(matchEventId, m_matchRecords, 128, OnMatchRecord, NULL);
+    for (uint8_t i = 0; i < numBindings; ++i)
+    {
+        m_bindingPins[i] = (Gpio_t){ .intNo = i, .value = true };
+        m_bindingMatches[i] = 0;
+        DigitalPatternEvent_Register(&m_bindings[i], "double press", m_doublePressNodes, &m_bindingPins[i],
+                                     matchEventId, i);
+        DigitalPatternEvent_Start(&m_bindings[i]);
+        end = (m_channelStreams[i].end > end) ? m_channelStreams[i].end : end;
+    }
+
+    const uint32_t start = CycleCounter_Get();
+    for (TimerTime_t time = STRESS_TICK; time <= end; time += STRESS_TICK)
+    {
+        SimTimer_Advance(STRESS_TICK);
+        for (uint8_t i = 0; i < numBindings; ++i)
+        {
+            const Stream_t* const stream = &m_channelStreams[i];
+            while ((next[i] < stream->numEdges) && (stream->edges[next[i]].timestamp <= time))
+            {
+                SimGpio_Write(&m_bindingPins[i], stream->edges[next[i]++].state == INPUT_HIGH);
+                ++edges;
+            }
+        }
+        AppEvent_ProcessMainEvents();
+    }
+    const uint32_t elapsed = CycleCounter_Get() - start;
+
+    uint64_t numMatches = 0;
+    uint64_t expected = 0;
+    for (uint8_t i = 0; i < numBindings; ++i)
+    {
+        CHECK("event_bindings", m_bindingMatches[i] == m_channelStreams[i].numDoublePresses);
+        numMatches += m_bindingMatches[i];
+        expected += m_channelStreams[i].numDoublePresses;
+        DigitalPatternEvent_Unregister(&m_bindings[i]);
+    }
+
+    printf("{\"suite\":\"digital-pattern\",\"test\":\"event_bindings\",\"bindings\":%u,\"events\":%u,"
+           "\"simulated_ms\":%lu,\"edges\":%llu,\"matches\":%llu,\"expected\":%llu,\"edges_per_s\":%.0f}\n",
+           numBindings, (2 * numBindings) + 1, (unsigned long)end, (unsigned long long)edges,
+           (unsigned long long)numMatches, (unsigned long long)expected, PerSecond(edges, elapsed));
+}
+
+/* Single presses, then a double press and a third press before the next main loop pass: the edges of
+ * the third press are lost to the full queue of the binding. The queued edges before the gap are skipped
+ * rather than matched as a double press, and the next double press matches. */
+static void TestBindingOverflow(void)
+{
+    uint8_t matchEventId;
+
+    AppEvent_DeInit();
+    SimTimer_Reset();
+    AppEvent_Init();
+    AppEvent_RegisterEvent(&matchEventId, "match", OnMatch, APP_EVENT_CONTEXT_MAIN);
+    AppEvent_EnableQueue(matchEventId, m_matchRecords, 128, OnMatchRecord, NULL);
+    m_bindingPins[0] = (Gpio_t){ .intNo = 0, .value = true };
+    m_bindingMatches[0] = 0;
+    CHECK("binding_overflow", DigitalPatternEvent_Register(&m_bindings[0], "double press", m_doublePressNodes,
+                                                           &m_bindingPins[0], matchEventId, 0));
+    DigitalPatternEvent_Start(&m_bindings[0]);
+
+    for (uint8_t i = 0; i < (PATTERN_EVENT_QUEUE_SIZE / 2) - 2; ++i)
+    {
+        Press(&m_bindingPins[0], 50, 800);
+    }
+    for (uint8_t i = 0; i < 3; ++i)
+    {
+        Press(&m_bindingPins[0], 50, 50);
+    }
+    for (uint32_t t = 0; t < 1000; t += STRESS_TICK)
+    {
+        SimTimer_Advance(STRESS_TICK);
+        AppEvent_ProcessMainEvents();
+    }
+    const uint32_t burstMatches = m_bindingMatches[0];
+    const uint32_t drops = AppEvent_GetDropCount(m_bindings[0].edgeEventId);
+
+    Press(&m_bindingPins[0], 50, 50);
+    AppEvent_ProcessMainEvents();
+    Press(&m_bindingPins[0], 50, 50);
+    for (uint32_t t = 0; t < 1000; t += STRESS_TICK)
+    {
+        SimTimer_Advance(STRESS_TICK);
+        AppEvent_ProcessMainEvents();
+    }
+    CHECK("binding_overflow", drops == 2);
+    CHECK("binding_overflow", burstMatches == 0);
+    CHECK("binding_overflow", m_bindingMatches[0] == 1);
+    DigitalPatternEvent_Unregister(&m_bindings[0]);
+
+    printf("{\"suite\":\"digital-pattern\",\"test\":\"binding_overflow\",\"dropped\":%lu,\"burst_matches\":%lu,"
+           "\"matches\":%lu}\n", (unsigned long)drops, (unsigned long)burstMatches,
+           (unsigned long)(m_bindingMatches[0] - burstMatches));
+}
+
+static TimerTime_t m_matchTime;
+
+static void OnMatchTime(void* context, const AppEvent_Record_t* record)
+{
+    (void)context;
+    m_matchTime = record->timestamp;
+}
+
+/* Level @p level written at @p time, with a main loop pass every ms up to then */
+static void WriteAt(Gpio_t* pin, TimerTime_t time, bool level)
+{
+    while (TimerTime_IsBefore(TimerGetCurrentTime(), time))
+    {
+        SimTimer_Advance(1);
+        AppEvent_ProcessMainEvents();
+    }
+    SimGpio_Write(pin, level);
+}
+
+/* A press whose window expires while the main loop is held, with the next press landing in the same
+ * pass as the expiry: the edge re-arms the timer first and the expiry still queued is discarded, so the
+ * double press that follows matches at its deadline without drops */
+static void TestBindingSamePass(void)
+{
+    uint8_t matchEventId;
+
+    AppEvent_DeInit();
+    SimTimer_Reset();
+    AppEvent_Init();
+    AppEvent_RegisterEvent(&matchEventId, "match", OnMatch, APP_EVENT_CONTEXT_MAIN);
+    AppEvent_EnableQueue(matchEventId, m_matchRecords, 128, OnMatchTime, NULL);
+    m_bindingPins[0] = (Gpio_t){ .intNo = 0, .value = true };
+    m_matchTime = 0;
+    DigitalPatternEvent_Register(&m_bindings[0], "double press", m_doublePressNodes, &m_bindingPins[0],
+                                 matchEventId, 0);
+    DigitalPatternEvent_Start(&m_bindings[0]);
+
+    WriteAt(&m_bindingPins[0], 0, false);
+    WriteAt(&m_bindingPins[0], 50, true);
+    AppEvent_ProcessMainEvents();
+    SimTimer_Advance(710 - 50);
+    SimGpio_Write(&m_bindingPins[0], false);
+    AppEvent_ProcessMainEvents();
+    WriteAt(&m_bindingPins[0], 760, true);
+    WriteAt(&m_bindingPins[0], 850, false);
+    WriteAt(&m_bindingPins[0], 900, true);
+    WriteAt(&m_bindingPins[0], 2000, true);
+
+    const uint32_t drops = AppEvent_GetDropCount(m_bindings[0].timerEventId);
+    CHECK("binding_same_pass", m_matchTime == 900 + 400);
+    CHECK("binding_same_pass", drops == 0);
+    DigitalPatternEvent_Unregister(&m_bindings[0]);
+
+    printf("{\"suite\":\"digital-pattern\",\"test\":\"binding_same_pass\",\"match_ms\":%lu,"
+           "\"timer_drops\":%lu}\n", (unsigned long)m_matchTime, (unsigned long)drops);
+}
+
+/* Double press: two presses within 700 ms, then 400 ms without input. Long press: held 800 ms. */
+static void CompilePatterns(PatternArena_t* arena)
+{
+    Gpio_t pin = { 0 };
+    DigitalPattern_t doublePress;
+    DigitalPattern_t longPress;
+
+    DigitalPattern_Init(&doublePress, &pin, arena, 2);
+    PatternPhase_t* presses = DigitalPattern_AddPhase(&doublePress, 700, false);
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        DigitalPattern_AddState(presses, INPUT_LOW);
+        DigitalPattern_AddState(presses, INPUT_HIGH);
+    }
+    DigitalPattern_AddPhase(&doublePress, 400, true);
+    m_numDoublePressNodes = DigitalPattern_Compile(&doublePress, m_doublePressNodes, STRESS_NODES);
+
+    DigitalPattern_Init(&longPress, &pin, arena, 1);
+    PatternPhase_t* hold = DigitalPattern_AddTimedPhase(&longPress, 0, 1);
+    DigitalPattern_AddTimedState(hold, INPUT_LOW, 800, PATTERN_DURATION_ANY);
+    DigitalPattern_Compile(&longPress, m_longPressNodes, STRESS_NODES);
+}
+
+int main (int argc, char* argv[])
+{
+    static const uint8_t patternCounts[] = { 1, 2, 4, 8, STRESS_MAX_PATTERNS };
+    static const uint8_t channelCounts[] = { 1, 2, 4, 8, 16, STRESS_CHANNELS };
+    static const uint8_t bindingCounts[] = { 1, 2, 4, 8, STRESS_BINDINGS };
+    PatternArena_t arena;
+    Stream_t stream;
+    (void)argc;
+    (void)argv;
+
+    CycleCounter_Init();
+    PatternArena_Init(&arena, m_storage, sizeof(m_storage));
+    CompilePatterns(&arena);
+
+    GenerateStream(&stream, m_edges, STRESS_MAX_EDGES, STRESS_GESTURES, 1, false);
+    for (uint8_t i = 0; i < sizeof(patternCounts); ++i)
+    {
+        TestScanPatterns(&stream, patternCounts[i]);
+    }
+
+    for (uint8_t channel = 0; channel < STRESS_CHANNELS; ++channel)
+    {
+        GenerateStream(&m_channelStreams[channel], m_channelEdges[channel], STRESS_CHANNEL_GESTURES * 4,
+                       STRESS_CHANNEL_GESTURES, 100 + channel, false);
+    }
+    for (uint8_t i = 0; i < sizeof(channelCounts); ++i)
+    {
+        TestBank(&arena, channelCounts[i]);
+    }
+    TestRunEquivalence(4);
+
+    GenerateStream(&stream, m_edges, STRESS_MAX_EDGES, STRESS_GESTURES, 2, true);
+    TestDebounce(&stream);
+    TestPatternSet();
+    TestSetCompile(200);
+    TestTimedSetCompile(200);
+    TestCapture();
+    TestCompileEquivalence(1000);
+    TestEnableDebounce();
+
+    for (uint8_t i = 0; i < sizeof(bindingCounts); ++i)
+    {
+        TestEventBindings(bindingCounts[i]);
+    }
+    TestBindingOverflow();
+    TestBindingSamePass();
+
+    printf("{\"suite\":\"digital-pattern\",\"failures\":%lu}\n", (unsigned long)m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+/*
+ * Free running 32-bit counter for short duration measurements, read with CycleCounter_Get().
+ *
+ * On Cortex-M3/M4/M7/M33 this is the DWT cycle counter (CPU clock cycles). Other platforms provide
+ * CycleCounter_Init()/CycleCounter_Get() themselves; the host simulation (sim/cycle-counter.c) counts
+ * nanoseconds of the monotonic clock. Differences of two readings are valid across a counter wrap.
+ */
+
+#include <stdint.h>
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+
+#define CYCLE_COUNTER_DEMCR         (*(volatile uint32_t*)0xE000EDFCu)
+#define CYCLE_COUNTER_DWT_CTRL      (*(volatile uint32_t*)0xE0001000u)
+#define CYCLE_COUNTER_DWT_CYCCNT    (*(volatile uint32_t*)0xE0001004u)
+
+static inline void CycleCounter_Init(void)
+{
+    CYCLE_COUNTER_DEMCR |= (1u << 24);          /* TRCENA */
+    CYCLE_COUNTER_DWT_CYCCNT = 0;
+    CYCLE_COUNTER_DWT_CTRL |= 1u;               /* CYCCNTENA */
+}
+
+static inline uint32_t CycleCounter_Get(void)
+{
+    return CYCLE_COUNTER_DWT_CYCCNT;
+}
+
+#else
+
+void CycleCounter_Init(void);
+
+uint32_t CycleCounter_Get(void);
+
+#endif
+
+#endif /* CYCLE_COUNTER_H */
@@ -1,19 +1,134 @@
-#include "AppEvent.h"
+#include "AppDebugConfig.h"
+
+#define LOG_LEVEL        DEBUG_APP_EVENT
+
+#include "event.h"
 #include "SerialConsole.h"
+#include "log.h"
 #include "timer.h"
+#include "timer-time.h"
+#include "utilities.h"
 
 #include "gpio.h"
+#ifdef APP_EVENT_HISTOGRAMS
+#include "cycle-counter.h"
+#endif
+#ifdef APP_EVENT_TRACE
+#include "trace.h"
+#endif
 
 #include "assertion.h"
+#ifdef APP_EVENT_ATOMIC
+#include <stdatomic.h>
+#endif
 #include <stdint.h>
-#include <stdlib.h>
 #include <string.h>
 
-#include "AppDebugConfig.h"
+#ifdef APP_EVENT_STATIC_TABLE
+#define MAX_EVENTS          APP_EVENT_COUNT
+#else
+#define MAX_EVENTS          32
+/* Number of registered events that can be timer events */
+#ifndef MAX_TIMER_EVENTS
+#define MAX_TIMER_EVENTS    MAX_EVENTS
+#endif
+#endif
 
-#define LOG_LEVEL        DEBUG_APP_EVENT
+#define MAX_IRQ_LINES       16
+#define TIMER_NOT_QUEUED    0xFF
+#define MAX_QUEUE_SIZE      128
 
-#define MAX_EVENTS          32
+/* Number of events that can batch with a window, see AppEvent_EnableBatching() */
+#ifndef APP_EVENT_BATCH_WINDOWS
+#define APP_EVENT_BATCH_WINDOWS     4
+#endif
+
+/* Number of groups created at the same time, see AppEvent_GroupCreate() */
+#ifndef APP_EVENT_MAX_GROUPS
+#define APP_EVENT_MAX_GROUPS        8
+#endif
+
+/* Timer heap nodes: one per timer event slot, followed by the batch window nodes */
+#define NUM_TIMER_NODES             (MAX_TIMER_EVENTS + APP_EVENT_BATCH_WINDOWS)
+#define IS_BATCH_NODE(slot)         ((slot) >= MAX_TIMER_EVENTS)
+
+/* Keeps the compiler from moving record stores past the queue index update */
+#define COMPILER_BARRIER()  __asm volatile ("" ::: "memory")
+
+/*
+ * Concurrency model.
+ *
+ * By default the masks shared between interrupts and the main loop are updated in short critical
+ * sections, which is enough on a single core. APP_EVENT_ATOMIC builds them on C11 atomics instead
+ * (LDREX/STREX on Cortex-M3 and above) so that the trigger path, AppEvent_Trigger() included, is
+ * lock-free and safe from any task or core:
+ *  - triggering sets the pending bit with a release fetch-or, after the record queue entry and the
+ *    statistics of the trigger are written;
+ *  - a loop claims a pending event with an acquire fetch-and (exchange-and-clear) before running its
+ *    callback, so a trigger arriving during the callback is kept for the next pass and never lost;
+ *  - other mask updates and the counters are relaxed, they only need to be atomic;
+ *  - record queue indexes are published with release stores and read with acquire loads.
+ * Timer start/stop and the timer heap still run in critical sections and must stay on one core.
+ */
+#ifdef APP_EVENT_ATOMIC
+typedef _Atomic uint32_t EventMask_t;
+typedef _Atomic uint32_t EventCounter_t;
+typedef _Atomic uint8_t QueueIndex_t;
+#define COUNTER_INCREMENT(counter)      atomic_fetch_add_explicit(&(counter), 1, memory_order_relaxed)
+#define COUNTER_READ(counter)           atomic_load_explicit(&(counter), memory_order_relaxed)
+#define COUNTER_RESET(counter)          atomic_store_explicit(&(counter), 0, memory_order_relaxed)
+#define COUNTER_STORE(counter, value)   atomic_store_explicit(&(counter), (value), memory_order_relaxed)
+#define COUNTER_EXCHANGE(counter, value) atomic_exchange_explicit(&(counter), (value), memory_order_relaxed)
+#define QUEUE_INDEX_LOAD(index)         atomic_load_explicit(&(index), memory_order_acquire)
+#define QUEUE_INDEX_STORE(index, value) atomic_store_explicit(&(index), (value), memory_order_release)
+#else
+typedef volatile uint32_t EventMask_t;
+typedef uint32_t EventCounter_t;
+typedef volatile uint8_t QueueIndex_t;
+#define COUNTER_INCREMENT(counter)      (++(counter))
+#define COUNTER_READ(counter)           (counter)
+#define COUNTER_RESET(counter)          ((counter) = 0)
+#define COUNTER_STORE(counter, value)   ((counter) = (value))
+#define QUEUE_INDEX_LOAD(index)         (index)
+#define QUEUE_INDEX_STORE(index, value) do { COMPILER_BARRIER(); (index) = (value); } while (0)
+#endif
+
+/* Maximum number of callbacks run by one AppEvent_ProcessMainEvents pass */
+#ifndef APP_EVENT_DISPATCH_BUDGET
+#define APP_EVENT_DISPATCH_BUDGET   MAX_EVENTS
+#endif
+
+_Static_assert(MAX_EVENTS <= 32, "MAX_EVENTS must fit in the 32-bit pending/paused event masks");
+_Static_assert(APP_EVENT_BATCH_WINDOWS <= 8, "APP_EVENT_BATCH_WINDOWS must fit in the batch window mask");
+_Static_assert(APP_EVENT_MAX_GROUPS <= 32, "APP_EVENT_MAX_GROUPS must fit in the group handles and mask");
+
+/* Event identifiers handed to the application hold the event slot index in the low bits and the
+ * generation of the slot above it. AppEvent_Unregister() bumps the generation, so identifiers kept
+ * from before are rejected.
+ * Limit: the generation has 3 bits to keep identifiers 8-bit. It wraps around after 8 re-registrations
+ * of the same slot, and an identifier kept across 8 of them is taken for the current registration. */
+#define EVENT_INDEX_BITS            5
+#define EVENT_INDEX(id)             ((uint8_t)((id) & ((1u << EVENT_INDEX_BITS) - 1)))
+#define EVENT_GENERATION(id)        ((uint8_t)((id) >> EVENT_INDEX_BITS))
+#define EVENT_GENERATION_MASK       ((uint8_t)(0xFF >> EVENT_INDEX_BITS))
+/* Identifier of the current registration of an event slot */
+#ifdef APP_EVENT_STATIC_TABLE
+#define EVENT_ID(index)             (index)
+#else
+#define EVENT_ID(index)             ((uint8_t)((index) | (m_generations[index] << EVENT_INDEX_BITS)))
+#endif
+
+/* Group handles have the same layout: the group table index and the generation of the entry */
+#define GROUP_ID(index)             ((AppEvent_Group_t)((index) | (m_groupGenerations[index] << EVENT_INDEX_BITS)))
+
+#define EVENT_BIT(id)               ((uint32_t)1 << (id))
+#define ALL_EVENTS_MASK             ((uint32_t)(((uint64_t)1 << MAX_EVENTS) - 1))
+#define ALL_TIMER_SLOTS_MASK        ((uint32_t)(((uint64_t)1 << MAX_TIMER_EVENTS) - 1))
+#define ALL_BATCH_WINDOWS_MASK      ((uint8_t)((1u << APP_EVENT_BATCH_WINDOWS) - 1))
+/* Index of the lowest set bit; GCC/Clang lower this to RBIT+CLZ on Cortex-M3 and above */
+#define LOWEST_BIT_INDEX(mask)      ((uint8_t)__builtin_ctz(mask))
+/* Default randomizer seed of an event, distinct per event and never 0 */
+#define RANDOM_SEED(id)             (0x9E3779B9u * ((uint32_t)(id) + 1))
 
 #if 1
 /* TO INVESTIGATE:
@@ -21,7 +136,8 @@
  * This was reproducible when we configured a 1 to 5ms timer, then printed a debug message just entering LpmEnterLowPower().
  * Tracing the code showed that HAL_RTC_SetAlarm_IT() to setup the timer, but TimerIrqHandler() never fires once the
  * system is in any of the sleep modes.  Unfortunately, we were unable to determine the root cause.
- * Recommended practice is to use timer values under EVENT_TIMEOUT_MIN for timers defined in the MAIN context. */
+ * Recommended practice is to use timer values under EVENT_TIMEOUT_MIN for timers defined in the MAIN context.
+ * The event module itself no longer prints from the timer paths, its messages are deferred to Log_Flush(). */
 static const uint32_t EVENT_TIMEOUT_MIN = 6;  /* ms */
 #endif
 
@@ -32,398 +148,1916 @@ typedef enum
     EVENT_TYPE_INTERRUPT
 } EVENT_TYPES;
 
+/* Immutable event configuration, const (flash) with APP_EVENT_STATIC_TABLE.
+ * Nothing in here is read by the main loop dispatch, which only uses the event masks and m_callbacks. */
 typedef struct
 {
-    bool debugEnable;
-    TimerTime_t startTime;
-    uint16_t triggerCount;
-    uint16_t processCount;
-} EventDiagnostics_t;
-
-typedef struct
-{
-    /* General fields */
     const char* name;
     APP_EVENT_CONTEXTS context;
-    AppEvent_Callback callback;
-    volatile bool triggered;
-    volatile bool paused;
-    bool single;
-    uint8_t id;
     EVENT_TYPES type;
 
     /* Timer event fields */
-    TimerEvent_t timer;
-    uint32_t timeout;
+    uint8_t timerSlot;          /* Index of the event state in m_timers */
     uint32_t timeoutRandomizer;
 
     /* Interrupt event fields */
     Gpio_t* irqGpio;
     IrqModes irqMode;
     IrqPriorities irqPriority;
+} EventConfig_t;
 
-    EventDiagnostics_t diagnostics;
-} AppEvent_t;
+typedef struct
+{
+    TimerTime_t startTime;
+    EventCounter_t triggerCount;
+    EventCounter_t processCount;
+    uint32_t overrunCount;      /* Only written by the timer interrupt */
+    uint32_t dropCount;         /* Only written by the queue producer */
+#ifdef APP_EVENT_HISTOGRAMS
+    AppEvent_Histogram_t latency;
+    AppEvent_Histogram_t execution;
+#endif
+} EventDiagnostics_t;
 
-static uint8_t m_numEvents;
-static AppEvent_t m_events[MAX_EVENTS];
-static bool m_initialized = false;
+/* Single producer (the triggering context) / single consumer (the main loop) record queue */
+typedef struct
+{
+    AppEvent_Record_t* buffer;
+    AppEvent_RecordCallback callback;
+    void* context;
+    uint8_t mask;
+    QueueIndex_t head;          /* Only written by the producer */
+    QueueIndex_t tail;          /* Only written by the consumer */
+} EventQueue_t;
+
+/* Trigger batching state, see AppEvent_EnableBatching() */
+typedef struct
+{
+    AppEvent_BatchCallback callback;
+    void* context;
+    uint32_t window;            /* Minimum ms between two callbacks, 0 for once per main loop pass */
+    TimerTime_t holdUntil;      /* End of the window started by the last callback */
+    uint8_t node;               /* Timer heap node of the window */
+    EventCounter_t count;
+    EventCounter_t first;
+    EventCounter_t last;
+} EventBatch_t;
+
+/* Mutable state of timer events only */
+typedef struct
+{
+    TimerTime_t deadline;
+    TimerTime_t periodEnd;      /* Deadline of the current period before randomization */
+    uint32_t timeout;
+    uint32_t slack;
+    uint32_t randomState;       /* xorshift32 state of the randomizer jitter, never 0 */
+    uint8_t eventId;
+    uint8_t heapIndex;
+    APP_EVENT_SCHEDULES schedule;
+} EventTimer_t;
 
-static void OnEvent( void* context );
-static void OnInterruptEvent( void* context );
+#ifdef APP_EVENT_STATIC_TABLE
 
-static const char* GetEventName(const AppEvent_t* const event)
+/* Timer slots are numbered over the timer entries of the table only */
+enum
+{
+#define APP_EVENT_GENERAL(...)
+#define APP_EVENT_TIMER(id, ...)                TIMER_SLOT_##id,
+#define APP_EVENT_INTERRUPT(...)
+    APP_EVENT_TABLE
+#undef APP_EVENT_GENERAL
+#undef APP_EVENT_TIMER
+#undef APP_EVENT_INTERRUPT
+    NUM_TIMER_SLOTS
+};
+#define MAX_TIMER_EVENTS    ((NUM_TIMER_SLOTS > 0) ? NUM_TIMER_SLOTS : 1)
+
+static const EventConfig_t m_eventConfig[MAX_EVENTS] =
+{
+#define APP_EVENT_GENERAL(id, cb, ctx) \
+    [APP_EVENT_ID_##id] = { .name = #id, .context = (ctx), .type = EVENT_TYPE_GENERAL, .irqMode = NO_IRQ },
+#define APP_EVENT_TIMER(id, cb, tmo, rnd, ctx) \
+    [APP_EVENT_ID_##id] = { .name = #id, .context = (ctx), .type = EVENT_TYPE_TIMER, \
+                            .timerSlot = TIMER_SLOT_##id, .timeoutRandomizer = (rnd), .irqMode = NO_IRQ },
+#define APP_EVENT_INTERRUPT(id, cb, gpio, mode, prio, ctx) \
+    [APP_EVENT_ID_##id] = { .name = #id, .context = (ctx), .type = EVENT_TYPE_INTERRUPT, \
+                            .irqGpio = (gpio), .irqMode = (mode), .irqPriority = (prio) },
+    APP_EVENT_TABLE
+#undef APP_EVENT_GENERAL
+#undef APP_EVENT_TIMER
+#undef APP_EVENT_INTERRUPT
+};
+
+static const AppEvent_Callback m_callbacks[MAX_EVENTS] =
+{
+#define APP_EVENT_GENERAL(id, cb, ...)          [APP_EVENT_ID_##id] = (cb),
+#define APP_EVENT_TIMER(id, cb, ...)            [APP_EVENT_ID_##id] = (cb),
+#define APP_EVENT_INTERRUPT(id, cb, ...)        [APP_EVENT_ID_##id] = (cb),
+    APP_EVENT_TABLE
+#undef APP_EVENT_GENERAL
+#undef APP_EVENT_TIMER
+#undef APP_EVENT_INTERRUPT
+};
+
+/* The mutable state is set up by the C runtime data initialization, no registration is needed */
+static EventTimer_t m_timers[NUM_TIMER_NODES] =
+{
+#define APP_EVENT_GENERAL(...)
+#define APP_EVENT_TIMER(id, cb, tmo, ...) \
+    [TIMER_SLOT_##id] = { .timeout = (tmo), .randomState = RANDOM_SEED(APP_EVENT_ID_##id), \
+                          .eventId = APP_EVENT_ID_##id, .heapIndex = TIMER_NOT_QUEUED },
+#define APP_EVENT_INTERRUPT(...)
+    APP_EVENT_TABLE
+#undef APP_EVENT_GENERAL
+#undef APP_EVENT_TIMER
+#undef APP_EVENT_INTERRUPT
+};
+
+static const uint32_t m_usedMask = ALL_EVENTS_MASK;
+
+#define APP_EVENT_GENERAL(id, cb, ctx)          | (((ctx) == APP_EVENT_CONTEXT_IMMEDIATE) ? EVENT_BIT(APP_EVENT_ID_##id) : 0)
+#define APP_EVENT_TIMER(id, cb, tmo, rnd, ctx)  | (((ctx) == APP_EVENT_CONTEXT_IMMEDIATE) ? EVENT_BIT(APP_EVENT_ID_##id) : 0)
+#define APP_EVENT_INTERRUPT(id, cb, gpio, mode, prio, ctx) \
+                                                | (((ctx) == APP_EVENT_CONTEXT_IMMEDIATE) ? EVENT_BIT(APP_EVENT_ID_##id) : 0)
+static const uint32_t m_immediateMask = 0 APP_EVENT_TABLE;
+#undef APP_EVENT_GENERAL
+#undef APP_EVENT_TIMER
+#undef APP_EVENT_INTERRUPT
+
+#define APP_EVENT_GENERAL(...)
+#define APP_EVENT_TIMER(id, ...)                | EVENT_BIT(APP_EVENT_ID_##id)
+#define APP_EVENT_INTERRUPT(...)
+static const uint32_t m_timerMask = 0 APP_EVENT_TABLE;
+#undef APP_EVENT_GENERAL
+#undef APP_EVENT_TIMER
+#undef APP_EVENT_INTERRUPT
+
+/* Registered events per priority level and per event loop, as masks of event ids */
+static uint32_t m_priorityMasks[APP_EVENT_NUM_PRIORITIES] = { [APP_EVENT_PRIORITY_NORMAL] = ALL_EVENTS_MASK };
+static uint32_t m_loopMasks[APP_EVENT_NUM_LOOPS] = { [APP_EVENT_LOOP_DEFAULT] = ALL_EVENTS_MASK };
+static uint32_t m_debugMask = ALL_EVENTS_MASK;
+
+#else
+
+static EventConfig_t m_eventConfig[MAX_EVENTS];
+static AppEvent_Callback m_callbacks[MAX_EVENTS];
+static EventTimer_t m_timers[NUM_TIMER_NODES];
+
+/* Slot allocators: a set bit is a slot in use, allocation takes the lowest clear bit */
+static uint32_t m_usedMask;                 /* Registered events */
+static uint32_t m_usedTimerSlots;           /* m_timers slots of timer events */
+static uint8_t m_generations[MAX_EVENTS];   /* Generation of each event slot, see EVENT_INDEX_BITS */
+
+static uint32_t m_immediateMask;            /* APP_EVENT_CONTEXT_IMMEDIATE events */
+static uint32_t m_timerMask;                /* EVENT_TYPE_TIMER events */
+
+/* Registered events per priority level and per event loop, as masks of event ids */
+static uint32_t m_priorityMasks[APP_EVENT_NUM_PRIORITIES];
+static uint32_t m_loopMasks[APP_EVENT_NUM_LOOPS];
+static uint32_t m_debugMask;                /* Events with debug logging enabled */
+
+#endif /* APP_EVENT_STATIC_TABLE */
+
+/* Cold per-event state, only touched when an event is actually triggered, processed or inspected */
+static EventQueue_t m_queues[MAX_EVENTS];
+static EventBatch_t m_batches[MAX_EVENTS];
+static uint8_t m_usedBatchWindows;          /* Batch window timer nodes in use, bit n is node MAX_TIMER_EVENTS + n */
+static EventDiagnostics_t m_diagnostics[MAX_EVENTS];
+/* Events of each group, indexed by the group handle, so that AppEvent_Unregister() can remove an event from
+ * all of them */
+static uint32_t m_groupMasks[APP_EVENT_MAX_GROUPS];
+static uint8_t m_groupGenerations[APP_EVENT_MAX_GROUPS];
+static uint32_t m_usedGroups;
+
+#ifdef APP_EVENT_HISTOGRAMS
+/* Cycle counter at the oldest unprocessed trigger of each pending main context event */
+static uint32_t m_triggerTicks[MAX_EVENTS];
+
+static void RecordSample(AppEvent_Histogram_t* const histogram, uint32_t ticks)
 {
-    static char genericName[16];
+    const uint32_t sample = ticks >> APP_EVENT_HISTOGRAM_SHIFT;
+    const uint8_t bucket = (sample == 0) ? 0 : (uint8_t)(32 - __builtin_clz(sample));
 
-    if (event->name != NULL)
+    if (bucket < APP_EVENT_HISTOGRAM_BUCKETS)
     {
-        return event->name;
+        ++histogram->buckets[bucket];
     }
+    else
+    {
+        ++histogram->overflow;
+    }
+    if ((histogram->count == 0) || (ticks < histogram->min))
+    {
+        histogram->min = ticks;
+    }
+    if (ticks > histogram->max)
+    {
+        histogram->max = ticks;
+    }
+    ++histogram->count;
+}
+
+#define STATS_DISPATCH(id, triggerTicks) \
+    const uint32_t execStart = CycleCounter_Get(); \
+    RecordSample(&m_diagnostics[id].latency, execStart - (triggerTicks))
+#define STATS_EXECUTE_BEGIN()   const uint32_t execStart = CycleCounter_Get()
+#define STATS_EXECUTE_END(id)   RecordSample(&m_diagnostics[id].execution, CycleCounter_Get() - execStart)
+#else
+#define STATS_DISPATCH(id, triggerTicks)
+#define STATS_EXECUTE_BEGIN()
+#define STATS_EXECUTE_END(id)
+#endif
+
+/* Called around each callback with the event index, e.g. to mark the dispatch on a debug gpio line.
+ * Defined in AppDebugConfig.h, see debug-gpio.h. */
+#ifndef APP_EVENT_HOOK_DISPATCH_BEGIN
+#define APP_EVENT_HOOK_DISPATCH_BEGIN(id)   ((void)0)
+#endif
+#ifndef APP_EVENT_HOOK_DISPATCH_END
+#define APP_EVENT_HOOK_DISPATCH_END(id)     ((void)0)
+#endif
+
+/* Trace points, compiled in with APP_EVENT_TRACE, see trace.h */
+#ifdef APP_EVENT_TRACE
+#define EVENT_TRACE(code, id, arg)          Trace_Write((code), (id), (uint16_t)(arg))
+#else
+#define EVENT_TRACE(code, id, arg)          ((void)0)
+#endif
+
+static bool m_initialized = false;
+
+/* One bit per event id. Pending bits are set by DoTrigger for MAIN context events
+ * and cleared by the main loop, so the loop only visits events that actually fired. */
+static EventMask_t m_pendingMask;
+static EventMask_t m_pausedMask;
+
+/* Hot per-event flags, packed so that a main loop pass reads a handful of words */
+static uint32_t m_singleMask;               /* Events started as single trigger events */
+static uint32_t m_queuedMask;               /* Events with a record queue, see AppEvent_EnableQueue */
+static uint32_t m_batchedMask;              /* Batching events, see AppEvent_EnableBatching */
+static EventMask_t m_heldMask;              /* Batching events triggered within their window */
+static EventMask_t m_runningMask;           /* Timer events currently in the timer heap */
+
+/* Started interrupt events per interrupt line (intNo), as a mask of event ids */
+static EventMask_t m_irqSubscribers[MAX_IRQ_LINES];
+
+/* Running timer events, as a binary min-heap of timer slots ordered by latest expiry (deadline + slack).
+ * The single hardware timer is armed for the root only. When it fires, every queued event whose
+ * deadline has been reached is expired in the same pass, wherever it sits in the heap, so events with
+ * overlapping slack windows share one wakeup and the alarm is reprogrammed once per batch rather than
+ * once per event. */
+static uint8_t m_timerHeap[NUM_TIMER_NODES];
+static uint8_t m_timerHeapSize;
+static TimerEvent_t m_timer;
+static TimerTime_t m_timerExpiry;          /* Alarm time programmed in m_timer */
+static bool m_timerArmed;
+static bool m_timerExpiring;
+static uint32_t m_expiringMask;            /* Timer events of the batch not handled yet, see OnTimerExpired */
+
+/* Sleep states of the application, ordered from shallowest to deepest, see AppEvent_SetSleepStates() */
+static const AppEvent_SleepState_t* m_sleepStates;
+static uint8_t m_numSleepStates;
+/* Wake-up latency of the selected sleep state: the alarm fires this much early, until the next expiry */
+static uint32_t m_wakeupAdvance;
+
+static void OnEvent( uint8_t id );
+static void OnInterruptEvent( void* context );
 
-    sprintf(genericName, "EVENT%u", event->id);
-    return genericName;
+static bool IsValidEvent(uint8_t id)
+{
+#ifdef APP_EVENT_STATIC_TABLE
+    return id < MAX_EVENTS;
+#else
+    return ((m_usedMask & EVENT_BIT(EVENT_INDEX(id))) != 0) &&
+           (EVENT_GENERATION(id) == m_generations[EVENT_INDEX(id)]);
+#endif
 }
 
-static void StartEvent(AppEvent_t* const event)
+/* Maps an event identifier of the API to the event slot index used by all the internal state. Identifiers
+ * of unregistered events, stale ones included (see AppEvent_Unregister()), make the calling API function
+ * return @p error. */
+#define GET_EVENT_INDEX(id, error) \
+    do { if (!IsValidEvent(id)) { return error; } (id) = EVENT_INDEX(id); } while (0)
+
+static bool IsValidGroup(AppEvent_Group_t group)
 {
-    if (event->irqMode == NO_IRQ)
-    {
-        if (event->diagnostics.debugEnable)
-        {
-            DEBUG_PRINTF("Event %s start (%lums, %s)\r\n", GetEventName(event), event->timeout,
-                         event->single ? "single" : "continuous");
+    return (EVENT_INDEX(group) < APP_EVENT_MAX_GROUPS) && ((m_usedGroups & EVENT_BIT(EVENT_INDEX(group))) != 0) &&
+           (EVENT_GENERATION(group) == m_groupGenerations[EVENT_INDEX(group)]);
+}
 
-            if (event->timeout < EVENT_TIMEOUT_MIN)
-            {
-                PRINTF("#WARN: %s timeout set below minimum recommended threshold of %lu ms\r\n", event->name, EVENT_TIMEOUT_MIN );
-                PRINTF("#WARN: There is evidence timer may fail to trigger with extensive debug logging under this value.\r\n");
-            }
-        }
-        if (event->timeoutRandomizer > 0)
-        {
-            const uint16_t randomOffset = (uint16_t)( ( rand() / (double)RAND_MAX ) * event->timeoutRandomizer );
-            TimerSetValue( &event->timer, event->timeout + randomOffset );
-        }
-        TimerStartWithParam( &event->timer, event );
+/* Events of a group, none for a deleted or invalid handle */
+static uint32_t GetGroupEvents(AppEvent_Group_t group)
+{
+    return IsValidGroup(group) ? (m_groupMasks[EVENT_INDEX(group)] & m_usedMask) : 0;
+}
+
+static EventTimer_t* GetTimer(uint8_t id)
+{
+    ASSERT(m_eventConfig[id].type == EVENT_TYPE_TIMER);   /* Only valid for timer events */
+    return &m_timers[m_eventConfig[id].timerSlot];
+}
+
+/* Log message codes, see FormatLogRecord() */
+typedef enum
+{
+    EVENT_LOG_REGISTERED,           /* arg: EVENT_TYPES */
+    EVENT_LOG_START_SINGLE,         /* arg: timeout */
+    EVENT_LOG_START_CONTINUOUS,     /* arg: timeout */
+    EVENT_LOG_TIMEOUT_BELOW_MIN,    /* arg: timeout */
+    EVENT_LOG_ACTIVATED,            /* arg: interrupt line */
+    EVENT_LOG_STOP,
+    EVENT_LOG_SET_TIMEOUT,          /* arg: timeout */
+    EVENT_LOG_PROCESS,
+    EVENT_LOG_DEBUG_ENABLED,
+    EVENT_LOG_DEBUG_DISABLED,
+    EVENT_LOG_UNREGISTERED,
+} EVENT_LOG_CODES;
+
+/* Per event debug records, filtered at run time by AppEvent_EnableDebug()/AppEvent_DisableDebug().
+ * Records carry the event identifier rather than the slot index, see FormatLogRecord(). */
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define EVENT_LOG_DEBUG(id, code, arg) \
+    do { if ((m_debugMask & EVENT_BIT(id)) != 0) { LOG_DEBUG(LOG_MODULE_APP_EVENT, EVENT_ID(id), (code), (arg)); } } while (0)
+#else
+#define EVENT_LOG_DEBUG(id, code, arg)  ((void)0)
+#endif
+
+static const char* GetEventName(uint8_t id)
+{
+    return (m_eventConfig[id].name != NULL) ? m_eventConfig[id].name : "EVENT";
+}
+
+#if LOG_LEVEL > LOG_LEVEL_NONE
+static void FormatLogRecord(const Log_Record_t* record)
+{
+    static const char* const typeNames[] = { "general", "timer", "interrupt" };
+
+    const uint8_t index = EVENT_INDEX(record->id);
+
+    /* Records are formatted long after they were written: the name is only printed while the slot still
+     * holds the registration that wrote the record, not that of a later owner of the slot */
+    if (IsValidEvent(record->id))
+    {
+        PRINTF("Event %s[%u] ", GetEventName(index), index);
     }
     else
     {
-        GpioSetInterrupt( event->irqGpio, event->irqMode, event->irqPriority, &OnInterruptEvent );
-        GpioMcuSetContext( event->irqGpio, (uint8_t*)&event->irqGpio->intNo );
-        if (event->diagnostics.debugEnable)
-        {
-            DEBUG_PRINTF("Event %s activated (irq %u)\r\n", GetEventName(event), event->irqGpio->intNo);
-        }
+        PRINTF("Event [%u, generation %u] ", index, EVENT_GENERATION(record->id));
+    }
+    switch (record->code)
+    {
+        case EVENT_LOG_REGISTERED:
+            PRINTF("registered (%s)\r\n", (record->arg < 3) ? typeNames[record->arg] : "?");
+            break;
+        case EVENT_LOG_START_SINGLE:
+            PRINTF("start (%lums, single)\r\n", (unsigned long)record->arg);
+            break;
+        case EVENT_LOG_START_CONTINUOUS:
+            PRINTF("start (%lums, continuous)\r\n", (unsigned long)record->arg);
+            break;
+        case EVENT_LOG_TIMEOUT_BELOW_MIN:
+            PRINTF("timeout %lums below minimum recommended threshold of %lu ms\r\n", (unsigned long)record->arg,
+                   (unsigned long)EVENT_TIMEOUT_MIN);
+            break;
+        case EVENT_LOG_ACTIVATED:
+            PRINTF("activated (irq %lu)\r\n", (unsigned long)record->arg);
+            break;
+        case EVENT_LOG_STOP:
+            PRINTF("stop\r\n");
+            break;
+        case EVENT_LOG_SET_TIMEOUT:
+            PRINTF("set timeout (%lums)\r\n", (unsigned long)record->arg);
+            break;
+        case EVENT_LOG_PROCESS:
+            PRINTF("process\r\n");
+            break;
+        case EVENT_LOG_DEBUG_ENABLED:
+            PRINTF("debug logging enabled\r\n");
+            break;
+        case EVENT_LOG_DEBUG_DISABLED:
+            PRINTF("debug logging disabled\r\n");
+            break;
+        case EVENT_LOG_UNREGISTERED:
+            PRINTF("unregistered\r\n");
+            break;
+        default:
+            PRINTF("code %u arg %lu\r\n", record->code, (unsigned long)record->arg);
+            break;
     }
 }
+#endif
 
+static uint32_t LoadEventBits(EventMask_t* const eventMask)
+{
+#ifdef APP_EVENT_ATOMIC
+    return atomic_load_explicit(eventMask, memory_order_relaxed);
+#else
+    return *eventMask;
+#endif
+}
 
+static void SetEventBits(EventMask_t* const eventMask, uint32_t bits)
+{
+#ifdef APP_EVENT_ATOMIC
+    atomic_fetch_or_explicit(eventMask, bits, memory_order_release);
+#else
+    CRITICAL_SECTION_BEGIN();
+    *eventMask |= bits;
+    CRITICAL_SECTION_END();
+#endif
+}
 
-static void DoTrigger( AppEvent_t* event )
+/* Clears the bits and returns those of them that were set, so that only one caller claims each bit */
+static uint32_t TakeEventBits(EventMask_t* const eventMask, uint32_t bits)
 {
-    switch (event->context)
-    {
-    case APP_EVENT_CONTEXT_MAIN:
-        event->triggered = true;
-        ++event->diagnostics.triggerCount;
-        break;
+#ifdef APP_EVENT_ATOMIC
+    return atomic_fetch_and_explicit(eventMask, ~bits, memory_order_acquire) & bits;
+#else
+    uint32_t taken;
 
-    case APP_EVENT_CONTEXT_IMMEDIATE:
-        ++event->diagnostics.triggerCount;
-        ++event->diagnostics.processCount;
-        if (event->callback != NULL)
-        {
-            (*(event->callback))();
-        }
-        break;
-    }
+    CRITICAL_SECTION_BEGIN();
+    taken = *eventMask & bits;
+    *eventMask &= ~bits;
+    CRITICAL_SECTION_END();
+
+    return taken;
+#endif
 }
 
-/* CONTEXT: Executes in the RTCC timer interrupt context with interrupts disabled */
-static void OnEvent( void *context )
+static void ClearEventBits(EventMask_t* const eventMask, uint32_t bits)
 {
-    AppEvent_t* event = (AppEvent_t*)context;
+#ifdef APP_EVENT_ATOMIC
+    atomic_fetch_and_explicit(eventMask, ~bits, memory_order_relaxed);
+#else
+    CRITICAL_SECTION_BEGIN();
+    *eventMask &= ~bits;
+    CRITICAL_SECTION_END();
+#endif
+}
 
-    DoTrigger(event);
+/* Pending bit updates of the triggers and of the dispatch. With APP_EVENT_HISTOGRAMS the first trigger
+ * of an event is stamped together with its pending bit, and the dispatch takes the bit together with the
+ * stamp, in critical sections (also with APP_EVENT_ATOMIC): a trigger racing the dispatch stamps the next
+ * run of the event, never the one being dispatched. */
+static void SetPendingBits(uint32_t bits)
+{
+#ifdef APP_EVENT_HISTOGRAMS
+    const uint32_t now = CycleCounter_Get();
 
-    if (!event->single)
+    CRITICAL_SECTION_BEGIN();
+    for (uint32_t first = bits & ~LoadEventBits(&m_pendingMask); first != 0; first &= first - 1)
     {
-        StartEvent(event);
+        m_triggerTicks[LOWEST_BIT_INDEX(first)] = now;
     }
+    SetEventBits(&m_pendingMask, bits);
+    CRITICAL_SECTION_END();
+#else
+    SetEventBits(&m_pendingMask, bits);
+#endif
 }
-/* CONTEXT: Executes in the interrupt context */
-static void OnInterruptEvent( void* context )
+
+/* Pends an event again for the rest of a run held back by the dispatch, a queue drain out of budget or a
+ * batch window, stamped now: the latency of the rest counts from there, not from a trigger already served
+ * or the window */
+static void RepeatPendingBit(uint8_t id)
 {
-    uint8_t intNo = *((uint8_t*)context);
+#ifdef APP_EVENT_HISTOGRAMS
+    CRITICAL_SECTION_BEGIN();
+    m_triggerTicks[id] = CycleCounter_Get();
+    SetEventBits(&m_pendingMask, EVENT_BIT(id));
+    CRITICAL_SECTION_END();
+#else
+    SetEventBits(&m_pendingMask, EVENT_BIT(id));
+#endif
+}
 
-    for (uint8_t i = 0; i < m_numEvents; ++i)
-    {
-        AppEvent_t* event = &m_events[i];
-        if (event->irqMode != NO_IRQ && event->irqGpio->intNo == intNo)
-        {
-            DoTrigger(event);
+static bool TakePendingBit(uint8_t id, uint32_t* const triggerTicks)
+{
+#ifdef APP_EVENT_HISTOGRAMS
+    bool taken;
+
+    CRITICAL_SECTION_BEGIN();
+    *triggerTicks = m_triggerTicks[id];
+    taken = (TakeEventBits(&m_pendingMask, EVENT_BIT(id)) != 0);
+    CRITICAL_SECTION_END();
+
+    return taken;
+#else
+    (void)triggerTicks;
+    return TakeEventBits(&m_pendingMask, EVENT_BIT(id)) != 0;
+#endif
+}
 
-            if (event->single)
-            {
-                GpioRemoveInterrupt( event->irqGpio );
-            }
+static TimerTime_t GetLatestExpiry(uint8_t slot)
+{
+    return m_timers[slot].deadline + m_timers[slot].slack;
+}
 
-            break;;
-        }
-    }
+static void PlaceInHeap(uint8_t position, uint8_t slot)
+{
+    m_timerHeap[position] = slot;
+    m_timers[slot].heapIndex = position;
 }
 
-void AppEvent_Trigger( uint8_t id )
+static void SiftUp(uint8_t position)
 {
-    for (uint8_t i = 0; i < m_numEvents; ++i)
+    const uint8_t slot = m_timerHeap[position];
+    const TimerTime_t expiry = GetLatestExpiry(slot);
+
+    while (position > 0)
     {
-        AppEvent_t* event = &m_events[i];
-        if (event->id == id)
+        const uint8_t parent = (position - 1) / 2;
+        if (!TimerTime_IsBefore(expiry, GetLatestExpiry(m_timerHeap[parent])))
         {
-            DoTrigger(event);
+            break;
         }
+        PlaceInHeap(position, m_timerHeap[parent]);
+        position = parent;
     }
+    PlaceInHeap(position, slot);
 }
 
-void AppEvent_Init(void)
+static void SiftDown(uint8_t position)
 {
-    if (m_initialized)
-        return;
+    const uint8_t slot = m_timerHeap[position];
+    const TimerTime_t expiry = GetLatestExpiry(slot);
 
-    m_numEvents = 0;
-    m_initialized = true;
+    for (;;)
+    {
+        uint8_t child = 2 * position + 1;
+        if (child >= m_timerHeapSize)
+        {
+            break;
+        }
+        if ((child + 1 < m_timerHeapSize)
+            && TimerTime_IsBefore(GetLatestExpiry(m_timerHeap[child + 1]),
+                                  GetLatestExpiry(m_timerHeap[child])))
+        {
+            ++child;
+        }
+        if (!TimerTime_IsBefore(GetLatestExpiry(m_timerHeap[child]), expiry))
+        {
+            break;
+        }
+        PlaceInHeap(position, m_timerHeap[child]);
+        position = child;
+    }
+    PlaceInHeap(position, slot);
 }
 
-AppEvent_t* CreateEvent(const char* const name, AppEvent_Callback callback, APP_EVENT_CONTEXTS context)
+/* Heap updates run with interrupts disabled (critical section or timer interrupt context) */
+static void InsertInHeap(EventTimer_t* const timer)
 {
-    uint8_t id = m_numEvents++;
-    AppEvent_t* event = &m_events[id];
-    event->id = id;
-    event->triggered = false;
-    event->context = context;
-    event->callback = callback;
-    event->irqMode = NO_IRQ;
-    event->diagnostics.debugEnable = true;
-    event->diagnostics.triggerCount = 0;
-    event->diagnostics.processCount = 0;
-    event->type = EVENT_TYPE_GENERAL;
-    event->paused = false;
-    if (name != NULL)
+    const uint8_t slot = (uint8_t)(timer - m_timers);
+
+    PlaceInHeap(m_timerHeapSize++, slot);
+    SiftUp(timer->heapIndex);
+    if (!IS_BATCH_NODE(slot))
     {
-        event->name = name;
+        m_runningMask |= EVENT_BIT(timer->eventId);
     }
-
-    return event;
 }
 
-void AppEvent_RegisterEvent(uint8_t* const eventId, const char* const name, AppEvent_Callback callback,
-                            APP_EVENT_CONTEXTS context)
+static void RemoveFromHeap(EventTimer_t* const timer)
 {
-    ASSERT(m_initialized);
-    ASSERT(m_numEvents < MAX_EVENTS);
-    ASSERT(eventId != NULL);
-    ASSERT(callback != NULL);
-
-    AppEvent_t* event = CreateEvent(name, callback, context);
-
-    DEBUG_PRINTF("Event %s[%u] registered (general)\r\n", GetEventName(event), event->id);
-
-    *eventId = event->id;
+    const uint8_t position = timer->heapIndex;
 
+    timer->heapIndex = TIMER_NOT_QUEUED;
+    if (!IS_BATCH_NODE(timer - m_timers))
+    {
+        m_runningMask &= ~EVENT_BIT(timer->eventId);
+    }
+    if (position < --m_timerHeapSize)
+    {
+        const uint8_t moved = m_timerHeap[m_timerHeapSize];
+        PlaceInHeap(position, moved);
+        if ((position > 0)
+            && TimerTime_IsBefore(GetLatestExpiry(moved), GetLatestExpiry(m_timerHeap[(position - 1) / 2])))
+        {
+            SiftUp(position);
+        }
+        else
+        {
+            SiftDown(position);
+        }
+    }
 }
 
-void AppEvent_RegisterTimerWithRandomizer(uint8_t* const eventId, const char* const name, AppEvent_Callback callback,
-                                          uint32_t timeout, uint32_t timeoutRandomizer, APP_EVENT_CONTEXTS context)
+/* Program the hardware timer for the heap root, leaving it untouched if the root expiry did not change */
+static void ArmTimer(void)
 {
-    ASSERT(m_initialized);
-    ASSERT(m_numEvents < MAX_EVENTS);
-    ASSERT(eventId != NULL);
-    ASSERT(callback != NULL);
+    if (m_timerExpiring)
+    {
+        return;     /* OnTimerExpired re-arms once the whole batch has been handled */
+    }
 
-    AppEvent_t* event = CreateEvent(name, callback, context);
-    TimerInit( &event->timer, OnEvent );
-    TimerSetValue( &event->timer, timeout );
-    event->timeout = timeout;
-    event->timeoutRandomizer = timeoutRandomizer;
-    event->type = EVENT_TYPE_TIMER;
+    if (m_timerHeapSize == 0)
+    {
+        if (m_timerArmed)
+        {
+            TimerStop( &m_timer );
+            m_timerArmed = false;
+        }
+        return;
+    }
 
-    DEBUG_PRINTF("Event %s[%u] registered (timer)\r\n", GetEventName(event), event->id);
+    const TimerTime_t alarm = GetLatestExpiry(m_timerHeap[0]) - m_wakeupAdvance;
+    if (m_timerArmed && (alarm == m_timerExpiry))
+    {
+        return;
+    }
 
-    *eventId = event->id;
+    const TimerTime_t now = TimerGetCurrentTime();
+    m_timerExpiry = alarm;
+    m_timerArmed = true;
+    TimerSetValue( &m_timer, TimerTime_IsBefore(now, alarm) ? (alarm - now) : 0 );
+    TimerStart( &m_timer );
 }
 
-void AppEvent_RegisterTimer(uint8_t* const id, const char* const name, AppEvent_Callback callback,
-                            uint32_t timeout, APP_EVENT_CONTEXTS context)
+/* A timer rescheduled or cancelled while its expiry batch is being handled is not expired any more */
+static void DropExpiry(const EventTimer_t* const timer)
 {
-    ASSERT(m_initialized);
-    AppEvent_RegisterTimerWithRandomizer(id, name, callback, timeout, 0, context);
+    if (!IS_BATCH_NODE(timer - m_timers))
+    {
+        m_expiringMask &= ~EVENT_BIT(timer->eventId);
+    }
 }
 
-void AppEvent_RegisterInterrupt( uint8_t* const eventId, const char* const name, AppEvent_Callback callback,
-                                 Gpio_t* gpio, IrqModes irqMode, IrqPriorities irqPriority, APP_EVENT_CONTEXTS context)
+static void ScheduleTimer(EventTimer_t* const timer, TimerTime_t deadline)
 {
-    ASSERT(m_initialized);
-    ASSERT(m_numEvents < MAX_EVENTS);
-    ASSERT(eventId != NULL);
-    ASSERT(callback != NULL);
-
-    AppEvent_t* event = CreateEvent(name, callback, context);
-    event->irqGpio = gpio;
-    event->irqMode = irqMode;
-    event->irqPriority = irqPriority;
-    event->type = EVENT_TYPE_INTERRUPT;
-
-    DEBUG_PRINTF("Event %s[%u] registered (interrupt)\r\n", GetEventName(event), event->id);
+    CRITICAL_SECTION_BEGIN();
+    DropExpiry(timer);
+    if (timer->heapIndex != TIMER_NOT_QUEUED)
+    {
+        RemoveFromHeap(timer);
+    }
+    timer->deadline = deadline;
+    InsertInHeap(timer);
+    ArmTimer();
+    CRITICAL_SECTION_END();
+}
 
-    *eventId = event->id;
+static void CancelTimer(EventTimer_t* const timer)
+{
+    CRITICAL_SECTION_BEGIN();
+    DropExpiry(timer);
+    if (timer->heapIndex != TIMER_NOT_QUEUED)
+    {
+        RemoveFromHeap(timer);
+        ArmTimer();
+    }
+    CRITICAL_SECTION_END();
 }
 
-/* In the current simple implementation, we cannot unregister an event. */
-/* More complex work with identifying the events would need to be done in order to */
-/* be able to support unregistering events. */
-#if 0
-void AppEvent_Unregister(uint8_t id)
+/* The CPU did not sleep, or was woken up by something else than the alarm: the alarm goes back to the
+ * deadline, otherwise every later re-arm would wake the CPU early for a sleep that is not happening */
+static void EndWakeupAdvance(void)
 {
+    if (m_wakeupAdvance != 0)
+    {
+        CRITICAL_SECTION_BEGIN();
+        m_wakeupAdvance = 0;
+        ArmTimer();
+        CRITICAL_SECTION_END();
+    }
 }
-#endif
 
-void AppEvent_Start(uint8_t id, bool single)
+/* Jitter in [0, timeoutRandomizer] from the per-event xorshift32 generator: integer only, reentrant,
+ * and the multiply-shift maps the 32-bit random value onto the range without a division */
+static uint32_t GetRandomOffset(uint8_t id)
 {
-    AppEvent_t* event = &m_events[id];
+    const uint32_t timeoutRandomizer = m_eventConfig[id].timeoutRandomizer;
 
-    event->triggered = false;
-    event->single = single;
-    event->diagnostics.startTime = TimerGetCurrentTime();
+    if (timeoutRandomizer == 0)
+    {
+        return 0;
+    }
 
-    StartEvent(event);
+    EventTimer_t* const timer = GetTimer(id);
+    uint32_t x = timer->randomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    timer->randomState = x;
+    return (uint32_t)(((uint64_t)x * ((uint64_t)timeoutRandomizer + 1)) >> 32);
 }
 
-void AppEvent_Stop(uint8_t id)
+/* Re-arm a continuous APP_EVENT_SCHEDULE_ABSOLUTE event one period after its previous deadline */
+static void RestartPeriod(uint8_t id)
 {
-    AppEvent_t* event = &m_events[id];
+    EventTimer_t* const timer = GetTimer(id);
+    /* The period may fire as late as its random offset plus the slack, that delay is not an overrun: judge
+     * it from the time it fired minus that allowance */
+    const TimerTime_t due = TimerGetCurrentTime() - ((timer->deadline - timer->periodEnd) + timer->slack);
+
+    timer->periodEnd += timer->timeout;
+    if (TimerTime_IsBefore(timer->periodEnd, due))
+    {
+        /* Overrun: skip the periods already missed rather than firing a burst to catch up, a period
+         * ending exactly now is still due and fires right away */
+        const uint32_t missed = (timer->timeout > 0) ? ((due - timer->periodEnd - 1) / timer->timeout) + 1 : 1;
+        timer->periodEnd += missed * timer->timeout;
+        m_diagnostics[id].overrunCount += missed;
+    }
+    ScheduleTimer(timer, timer->periodEnd + GetRandomOffset(id));
+}
 
-    if (event->diagnostics.debugEnable)
+/* Once per timeout setting, StartEvent() re-arms far too often to log it */
+static void WarnShortTimeout(uint8_t id, uint32_t timeout)
+{
+    (void)id;
+    if (timeout < EVENT_TIMEOUT_MIN)
     {
-        DEBUG_PRINTF("Event %s stop\r\n", GetEventName(event));
+        LOG_WARN(LOG_MODULE_APP_EVENT, EVENT_ID(id), EVENT_LOG_TIMEOUT_BELOW_MIN, timeout);
     }
-    if (event->irqMode == NO_IRQ)
+}
+
+static void StartEvent(uint8_t id)
+{
+    const EventConfig_t* const config = &m_eventConfig[id];
+
+    if (config->irqMode == NO_IRQ)
     {
-        TimerStop( &event->timer );
+        if (config->type != EVENT_TYPE_TIMER)
+        {
+            return;     /* Nothing to arm for general events */
+        }
+
+        EventTimer_t* const timer = GetTimer(id);
+        EVENT_TRACE(TRACE_EVENT_START, id, timer->timeout);
+        EVENT_LOG_DEBUG(id, (m_singleMask & EVENT_BIT(id)) ? EVENT_LOG_START_SINGLE : EVENT_LOG_START_CONTINUOUS,
+                        timer->timeout);
+        timer->periodEnd = TimerGetCurrentTime() + timer->timeout;
+        ScheduleTimer(timer, timer->periodEnd + GetRandomOffset(id));
     }
     else
     {
-        GpioRemoveInterrupt( event->irqGpio );
+#ifdef APP_EVENT_STATIC_TABLE
+        /* Checked by AppEvent_RegisterInterrupt() otherwise */
+        ASSERT(config->irqGpio->intNo < MAX_IRQ_LINES);
+#endif
+        EVENT_TRACE(TRACE_EVENT_START, id, config->irqGpio->intNo);
+        SetEventBits(&m_irqSubscribers[config->irqGpio->intNo], EVENT_BIT(id));
+        GpioSetInterrupt( config->irqGpio, config->irqMode, config->irqPriority, &OnInterruptEvent );
+        GpioMcuSetContext( config->irqGpio, (uint8_t*)&config->irqGpio->intNo );
+        EVENT_LOG_DEBUG(id, EVENT_LOG_ACTIVATED, config->irqGpio->intNo);
     }
 }
 
-uint32_t AppEvent_GetTimeout(uint8_t id)
+static void StopInterrupt(uint8_t id)
 {
-    AppEvent_t* event = &m_events[id];
-    ASSERT(event->irqGpio == NULL);         /* This function is only valid for timer events */
+    Gpio_t* const gpio = m_eventConfig[id].irqGpio;
+    EventMask_t* const subscribers = &m_irqSubscribers[gpio->intNo];
 
-    return event->timeout;
+    ClearEventBits(subscribers, EVENT_BIT(id));
+
+    /* The line stays armed while other events are still subscribed to it */
+    if (LoadEventBits(subscribers) == 0)
+    {
+        GpioRemoveInterrupt( gpio );
+    }
 }
 
-void AppEvent_SetTimeout(uint8_t id, uint32_t timeout)
+static void EnqueueRecord(uint8_t id, uint32_t payload)
 {
-    AppEvent_t* event = &m_events[id];
-    ASSERT(event->irqGpio == NULL);         /* This function is only valid for timer events */
+    EventQueue_t* const queue = &m_queues[id];
+    const uint8_t head = queue->head;
 
-    if (event->diagnostics.debugEnable)
+    if ((uint8_t)(head - QUEUE_INDEX_LOAD(queue->tail)) > queue->mask)
     {
-        DEBUG_PRINTF("Event %s set timeout (%lums)\r\n", GetEventName(event), timeout);
+        ++m_diagnostics[id].dropCount;
+        return;
     }
-    TimerSetValue(&event->timer, timeout);
-    event->triggered = false;
-    event->timeout = timeout;
-}
 
-uint32_t AppEvent_TimeRemaining(uint8_t id)
-{
-    return TimerTimeRemaining( &m_events[id].timer );
+    AppEvent_Record_t* const record = &queue->buffer[head & queue->mask];
+    record->timestamp = TimerGetCurrentTime();
+    record->payload = payload;
+    QUEUE_INDEX_STORE(queue->head, head + 1);
 }
 
-bool AppEvent_Running(uint8_t id)
+/* Drops the records not yet handed to the record callback, for a timer whose expiries are cancelled */
+static void DiscardRecords(uint8_t id)
 {
-    return TimerRunning( &m_events[id].timer );
+    EventQueue_t* const queue = &m_queues[id];
+
+    CRITICAL_SECTION_BEGIN();
+    QUEUE_INDEX_STORE(queue->tail, QUEUE_INDEX_LOAD(queue->head));
+    CRITICAL_SECTION_END();
 }
 
-void AppEvent_ProcessMainEvents(void)
+/* Hands the queued records to the record callback, including records queued meanwhile, up to one queue
+ * length per pass so that a producer refilling the queue as fast as it is drained cannot hold the loop.
+ * The event stays pending for the records left over. */
+static void DrainQueue(uint8_t id)
 {
-    for (uint8_t id = 0; id < m_numEvents; ++id)
+    EventQueue_t* const queue = &m_queues[id];
+    uint8_t tail = queue->tail;
+
+    for (uint8_t budget = queue->mask + 1; tail != QUEUE_INDEX_LOAD(queue->head); --budget)
     {
-        AppEvent_t* event = &m_events[id];
-        if (event->triggered && !event->paused)
+        if (budget == 0)
         {
-            event->triggered = false;
-            if ((event->irqMode != NO_IRQ)              /* Process all events from interrupt context */
-                || event->single                        /* Process all single trigger events */
-                || TimerRunning(&event->timer)          /* Process continuous timer events that are still active */
-                || event->type == EVENT_TYPE_GENERAL)   /* Process all general events */
-            {
-                if (event->diagnostics.debugEnable)
-                {
-                    DEBUG_PRINTF("Event %s process\r\n", GetEventName(event));
-                }
-                ++event->diagnostics.processCount;
-                if (event->callback != NULL)
-                {
-                    (*(event->callback))();
-                }
-            }
+            RepeatPendingBit(id);
+            return;
         }
+
+        COMPILER_BARRIER();
+        const AppEvent_Record_t record = queue->buffer[tail & queue->mask];
+        QUEUE_INDEX_STORE(queue->tail, ++tail);
+
+        COUNTER_INCREMENT(m_diagnostics[id].processCount);
+        (*(queue->callback))(queue->context, &record);
     }
 }
 
-void AppEvent_Pause(uint8_t id)
+static void CountBatchTrigger(uint8_t id)
 {
-    ASSERT(m_events[id].context == APP_EVENT_CONTEXT_MAIN);
-    m_events[id].paused = true;
+    EventBatch_t* const batch = &m_batches[id];
+    const TimerTime_t now = TimerGetCurrentTime();
+
+#ifdef APP_EVENT_ATOMIC
+    if (atomic_fetch_add_explicit(&batch->count, 1, memory_order_relaxed) == 0)
+    {
+        COUNTER_STORE(batch->first, now);
+    }
+    COUNTER_STORE(batch->last, now);
+#else
+    CRITICAL_SECTION_BEGIN();
+    if (batch->count++ == 0)
+    {
+        batch->first = now;
+    }
+    batch->last = now;
+    CRITICAL_SECTION_END();
+#endif
 }
 
-void AppEvent_Resume(uint8_t id)
+/* Takes the triggers counted so far, the next trigger starts a new batch */
+static void TakeBatch(uint8_t id, AppEvent_Batch_t* const result)
 {
-    ASSERT(m_events[id].context == APP_EVENT_CONTEXT_MAIN);
-    m_events[id].paused = false;
+    EventBatch_t* const batch = &m_batches[id];
+
+#ifdef APP_EVENT_ATOMIC
+    result->first = COUNTER_READ(batch->first);
+    result->last = COUNTER_READ(batch->last);
+    result->count = COUNTER_EXCHANGE(batch->count, 0);
+#else
+    CRITICAL_SECTION_BEGIN();
+    result->first = batch->first;
+    result->last = batch->last;
+    result->count = batch->count;
+    batch->count = 0;
+    CRITICAL_SECTION_END();
+#endif
 }
 
-bool AppEvent_IsIdle(void)
+/* Returns true if the batch must wait for the end of its window, which triggers it again */
+static bool HoldBatch(uint8_t id)
 {
-    for (uint8_t id = 0; id < m_numEvents; ++id)
+    EventBatch_t* const batch = &m_batches[id];
+
+    if ((batch->window == 0) || !TimerTime_IsBefore(TimerGetCurrentTime(), batch->holdUntil))
     {
-        if (m_events[id].triggered)
-            return false;
+        return false;
     }
 
+    SetEventBits(&m_heldMask, EVENT_BIT(id));
+    if (m_timers[batch->node].heapIndex == TIMER_NOT_QUEUED)
+    {
+        ScheduleTimer(&m_timers[batch->node], batch->holdUntil);
+    }
     return true;
 }
 
-void AppEvent_PrintDiagnostics(void)
+static void RunBatch(uint8_t id)
 {
-    DEBUG_PRINTF("--------------------\r\n");
-    DEBUG_PRINTF("AppEvent Diagnostics\r\n");
-    for (uint8_t id = 0; id < m_numEvents; ++id)
+    EventBatch_t* const batch = &m_batches[id];
+    AppEvent_Batch_t result;
+
+    TakeBatch(id, &result);
+    batch->holdUntil = TimerGetCurrentTime() + batch->window;
+    if (result.count != 0)
     {
-        AppEvent_t* event = &m_events[id];
-        DEBUG_PRINTF("%s: triggered=%u, processed=%u, elapsedSinceStart=%.1fs\r\n",
-                     GetEventName(event), event->diagnostics.triggerCount, event->diagnostics.processCount,
-                     TimerGetElapsedTime(event->diagnostics.startTime) / 1000.0);
+        COUNTER_INCREMENT(m_diagnostics[id].processCount);
+        (*(batch->callback))(batch->context, &result);
     }
-    DEBUG_PRINTF("--------------------\r\n");
 }
 
-void AppEvent_EnableDebug(uint8_t id)
+/* CONTEXT: Executes in the RTCC timer interrupt context with interrupts disabled */
+static void OnBatchWindowEnd(uint8_t id)
 {
-    AppEvent_t* event = &m_events[id];
-    event->diagnostics.debugEnable = true;
-    DEBUG_PRINTF("Event %s: Debug logging enabled\r\n", GetEventName(event));
+    if (TakeEventBits(&m_heldMask, EVENT_BIT(id)) != 0)
+    {
+        RepeatPendingBit(id);
+    }
 }
 
-void AppEvent_DisableDebug(uint8_t id )
+static void DoTrigger( uint8_t id, uint32_t payload )
 {
-    AppEvent_t* event = &m_events[id];
-    event->diagnostics.debugEnable = false;
-    DEBUG_PRINTF("Event %s: Debug logging disabled\r\n", GetEventName(event));
+    const uint32_t bit = EVENT_BIT(id);
+
+    EVENT_TRACE(TRACE_EVENT_TRIGGER, id, payload);
+    COUNTER_INCREMENT(m_diagnostics[id].triggerCount);
+    if (m_batchedMask & bit)
+    {
+        CountBatchTrigger(id);
+        /* Held batches are made pending again by OnBatchWindowEnd, with this trigger counted */
+        if ((LoadEventBits(&m_heldMask) & bit) == 0)
+        {
+            SetPendingBits(bit);
+        }
+        return;
+    }
+
+    if ((m_immediateMask & bit) == 0)
+    {
+        if (m_queuedMask & bit)
+        {
+            EnqueueRecord(id, payload);
+        }
+        SetPendingBits(bit);
+        return;
+    }
+
+    COUNTER_INCREMENT(m_diagnostics[id].processCount);
+    STATS_EXECUTE_BEGIN();
+    APP_EVENT_HOOK_DISPATCH_BEGIN(id);
+    EVENT_TRACE(TRACE_EVENT_CALLBACK_BEGIN, id, 0);
+    if (m_queuedMask & bit)
+    {
+        const AppEvent_Record_t record = { .timestamp = TimerGetCurrentTime(), .payload = payload };
+        (*(m_queues[id].callback))(m_queues[id].context, &record);
+    }
+    else if (m_callbacks[id] != NULL)
+    {
+        (*(m_callbacks[id]))();
+    }
+    EVENT_TRACE(TRACE_EVENT_CALLBACK_END, id, 0);
+    APP_EVENT_HOOK_DISPATCH_END(id);
+    STATS_EXECUTE_END(id);
+}
+
+/* CONTEXT: Executes in the RTCC timer interrupt context with interrupts disabled */
+static void OnEvent( uint8_t id )
+{
+    EVENT_TRACE(TRACE_EVENT_TIMER, id, 0);
+    DoTrigger(id, 0);
+
+    if ((m_singleMask & EVENT_BIT(id)) == 0)
+    {
+        if (GetTimer(id)->schedule == APP_EVENT_SCHEDULE_ABSOLUTE)
+        {
+            RestartPeriod(id);
+        }
+        else
+        {
+            StartEvent(id);
+        }
+    }
+}
+
+/* CONTEXT: Executes in the RTCC timer interrupt context with interrupts disabled */
+static void OnTimerExpired( void* context )
+{
+    uint8_t expired[NUM_TIMER_NODES];
+    uint8_t numExpired = 0;
+    const TimerTime_t now = TimerGetCurrentTime();
+
+    (void)context;
+    m_timerArmed = false;
+    /* The CPU is awake again: an early wake-up only expires what is due and re-arms for the real deadline */
+    m_wakeupAdvance = 0;
+
+    /* Collect the whole batch first so that continuous events re-armed by OnEvent are not expired twice.
+     * The heap is ordered by latest expiry, an event with an earlier deadline but a larger slack can sit
+     * below one that is not due yet, so every node is checked against its deadline. */
+    for (uint8_t position = 0; position < m_timerHeapSize; ++position)
+    {
+        if (!TimerTime_IsBefore(now, m_timers[m_timerHeap[position]].deadline))
+        {
+            expired[numExpired++] = m_timerHeap[position];
+        }
+    }
+    for (uint8_t i = 0; i < numExpired; ++i)
+    {
+        RemoveFromHeap(&m_timers[expired[i]]);
+        if (!IS_BATCH_NODE(expired[i]))
+        {
+            m_expiringMask |= EVENT_BIT(m_timers[expired[i]].eventId);
+        }
+    }
+
+    m_timerExpiring = true;
+    for (uint8_t i = 0; i < numExpired; ++i)
+    {
+        const uint8_t id = m_timers[expired[i]].eventId;
+
+        if (IS_BATCH_NODE(expired[i]))
+        {
+            OnBatchWindowEnd(id);
+        }
+        else if ((m_expiringMask & EVENT_BIT(id)) != 0)
+        {
+            /* Skipped when a callback earlier in the batch stopped or restarted the event */
+            m_expiringMask &= ~EVENT_BIT(id);
+            OnEvent(id);
+        }
+    }
+    m_timerExpiring = false;
+
+    ArmTimer();
+}
+
+/* CONTEXT: Executes in the interrupt context */
+static void OnInterruptEvent( void* context )
+{
+    uint8_t intNo = *((uint8_t*)context);
+    uint32_t subscribers = LoadEventBits(&m_irqSubscribers[intNo]);
+
+    EVENT_TRACE(TRACE_EVENT_INTERRUPT, intNo, 0);
+    while (subscribers != 0)
+    {
+        const uint8_t id = LOWEST_BIT_INDEX(subscribers);
+        subscribers &= subscribers - 1;
+
+        /* Queued interrupt events carry the pin level sampled here, so handlers need not read it again */
+        DoTrigger(id, (m_queuedMask & EVENT_BIT(id)) ? GpioRead( m_eventConfig[id].irqGpio ) : 0);
+
+        if (m_singleMask & EVENT_BIT(id))
+        {
+            StopInterrupt(id);
+        }
+        /* An immediate callback may have stopped a later subscriber of the line */
+        subscribers &= LoadEventBits(&m_irqSubscribers[intNo]);
+    }
+}
+
+void AppEvent_Trigger( uint8_t id )
+{
+    if (IsValidEvent(id))
+    {
+        DoTrigger(EVENT_INDEX(id), 0);
+    }
+}
+
+void AppEvent_TriggerWithPayload( uint8_t id, uint32_t payload )
+{
+    if (IsValidEvent(id))
+    {
+        DoTrigger(EVENT_INDEX(id), payload);
+    }
+}
+
+static void StopEvent(uint8_t id)
+{
+    EVENT_LOG_DEBUG(id, EVENT_LOG_STOP, 0);
+    if (m_batchedMask & EVENT_BIT(id))
+    {
+        /* Counted triggers are kept, a held batch runs on the next trigger after a restart */
+        if (m_batches[id].window != 0)
+        {
+            CancelTimer(&m_timers[m_batches[id].node]);
+        }
+        ClearEventBits(&m_heldMask, EVENT_BIT(id));
+    }
+    if (m_eventConfig[id].type == EVENT_TYPE_TIMER)
+    {
+        CancelTimer(GetTimer(id));
+        if (m_queuedMask & EVENT_BIT(id))
+        {
+            DiscardRecords(id);
+        }
+    }
+    else if (m_eventConfig[id].type == EVENT_TYPE_INTERRUPT)
+    {
+        StopInterrupt(id);
+    }
+}
+
+void AppEvent_Init(void)
+{
+    if (m_initialized)
+        return;
+
+#ifndef APP_EVENT_STATIC_TABLE
+    m_usedMask = 0;
+    m_usedTimerSlots = 0;
+    memset(m_generations, 0, sizeof(m_generations));
+    m_immediateMask = 0;
+    m_timerMask = 0;
+    m_debugMask = 0;
+    memset(m_priorityMasks, 0, sizeof(m_priorityMasks));
+    memset(m_loopMasks, 0, sizeof(m_loopMasks));
+#else
+    for (uint32_t timers = m_timerMask; timers != 0; timers &= timers - 1)
+    {
+        WarnShortTimeout(LOWEST_BIT_INDEX(timers), GetTimer(LOWEST_BIT_INDEX(timers))->timeout);
+    }
+#endif
+    m_pendingMask = 0;
+    m_pausedMask = 0;
+    m_singleMask = 0;
+    m_queuedMask = 0;
+    m_batchedMask = 0;
+    m_heldMask = 0;
+    m_usedBatchWindows = 0;
+    m_usedGroups = 0;
+    memset(m_groupMasks, 0, sizeof(m_groupMasks));
+    memset(m_groupGenerations, 0, sizeof(m_groupGenerations));
+    m_runningMask = 0;
+    for (uint8_t line = 0; line < MAX_IRQ_LINES; ++line)
+    {
+        m_irqSubscribers[line] = 0;
+    }
+    m_timerHeapSize = 0;
+    m_timerArmed = false;
+    m_timerExpiring = false;
+    m_expiringMask = 0;
+    m_wakeupAdvance = 0;
+    TimerInit( &m_timer, OnTimerExpired );
+#ifdef APP_EVENT_HISTOGRAMS
+    CycleCounter_Init();
+#endif
+    LOG_SET_FORMATTER(LOG_MODULE_APP_EVENT, FormatLogRecord);
+    m_initialized = true;
+}
+
+void AppEvent_DeInit(void)
+{
+    if (!m_initialized)
+        return;
+
+    for (uint32_t events = m_usedMask; events != 0; events &= events - 1)
+    {
+        StopEvent(LOWEST_BIT_INDEX(events));
+    }
+    TimerStop( &m_timer );
+    m_initialized = false;
+}
+
+#ifndef APP_EVENT_STATIC_TABLE
+
+static uint8_t CreateEvent(const char* const name, AppEvent_Callback callback, APP_EVENT_CONTEXTS context,
+                           EVENT_TYPES type)
+{
+    const uint8_t id = LOWEST_BIT_INDEX(~m_usedMask & ALL_EVENTS_MASK);
+    const uint32_t bit = EVENT_BIT(id);
+    EventConfig_t* const config = &m_eventConfig[id];
+
+    memset(config, 0, sizeof(*config));
+    memset(&m_queues[id], 0, sizeof(m_queues[id]));
+    memset(&m_diagnostics[id], 0, sizeof(m_diagnostics[id]));
+    memset(&m_batches[id], 0, sizeof(m_batches[id]));
+    ClearEventBits(&m_pendingMask, bit);
+    ClearEventBits(&m_pausedMask, bit);
+    m_singleMask &= ~bit;
+    m_queuedMask &= ~bit;
+    m_batchedMask &= ~bit;
+    ClearEventBits(&m_heldMask, bit);
+    for (uint8_t level = 0; level < APP_EVENT_NUM_PRIORITIES; ++level)
+    {
+        m_priorityMasks[level] &= ~bit;
+    }
+    m_priorityMasks[APP_EVENT_PRIORITY_NORMAL] |= bit;
+    for (uint8_t loop = 0; loop < APP_EVENT_NUM_LOOPS; ++loop)
+    {
+        m_loopMasks[loop] &= ~bit;
+    }
+    m_loopMasks[APP_EVENT_LOOP_DEFAULT] |= bit;
+    m_debugMask |= bit;
+    m_immediateMask &= ~bit;
+    m_timerMask &= ~bit;
+    if (context == APP_EVENT_CONTEXT_IMMEDIATE)
+    {
+        m_immediateMask |= bit;
+    }
+    if (type == EVENT_TYPE_TIMER)
+    {
+        m_timerMask |= bit;
+    }
+    m_callbacks[id] = callback;
+    config->name = name;
+    config->context = context;
+    config->type = type;
+    config->irqMode = NO_IRQ;
+    m_usedMask |= bit;
+
+    return id;
+}
+
+void AppEvent_RegisterEvent(uint8_t* const eventId, const char* const name, AppEvent_Callback callback,
+                            APP_EVENT_CONTEXTS context)
+{
+    ASSERT(m_initialized);
+    ASSERT(m_usedMask != ALL_EVENTS_MASK);
+    ASSERT(eventId != NULL);
+    ASSERT(callback != NULL);
+
+    const uint8_t id = CreateEvent(name, callback, context, EVENT_TYPE_GENERAL);
+
+    LOG_INFO(LOG_MODULE_APP_EVENT, EVENT_ID(id), EVENT_LOG_REGISTERED, EVENT_TYPE_GENERAL);
+
+    *eventId = EVENT_ID(id);
+
+}
+
+void AppEvent_RegisterTimerWithRandomizer(uint8_t* const eventId, const char* const name, AppEvent_Callback callback,
+                                          uint32_t timeout, uint32_t timeoutRandomizer, APP_EVENT_CONTEXTS context)
+{
+    ASSERT(m_initialized);
+    ASSERT(m_usedMask != ALL_EVENTS_MASK);
+    ASSERT(m_usedTimerSlots != ALL_TIMER_SLOTS_MASK);
+    ASSERT(eventId != NULL);
+    ASSERT(callback != NULL);
+
+    const uint8_t id = CreateEvent(name, callback, context, EVENT_TYPE_TIMER);
+    const uint8_t slot = LOWEST_BIT_INDEX(~m_usedTimerSlots & ALL_TIMER_SLOTS_MASK);
+    EventTimer_t* const timer = &m_timers[slot];
+
+    m_eventConfig[id].timerSlot = slot;
+    m_eventConfig[id].timeoutRandomizer = timeoutRandomizer;
+    memset(timer, 0, sizeof(*timer));
+    timer->eventId = id;
+    timer->timeout = timeout;
+    timer->randomState = RANDOM_SEED(id);
+    timer->heapIndex = TIMER_NOT_QUEUED;
+    timer->schedule = APP_EVENT_SCHEDULE_RELATIVE;
+    m_usedTimerSlots |= EVENT_BIT(slot);
+
+    LOG_INFO(LOG_MODULE_APP_EVENT, EVENT_ID(id), EVENT_LOG_REGISTERED, EVENT_TYPE_TIMER);
+    WarnShortTimeout(id, timeout);
+
+    *eventId = EVENT_ID(id);
+}
+
+void AppEvent_RegisterTimer(uint8_t* const id, const char* const name, AppEvent_Callback callback,
+                            uint32_t timeout, APP_EVENT_CONTEXTS context)
+{
+    ASSERT(m_initialized);
+    AppEvent_RegisterTimerWithRandomizer(id, name, callback, timeout, 0, context);
+}
+
+void AppEvent_RegisterInterrupt( uint8_t* const eventId, const char* const name, AppEvent_Callback callback,
+                                 Gpio_t* gpio, IrqModes irqMode, IrqPriorities irqPriority, APP_EVENT_CONTEXTS context)
+{
+    ASSERT(m_initialized);
+    ASSERT(m_usedMask != ALL_EVENTS_MASK);
+    ASSERT(eventId != NULL);
+    ASSERT(callback != NULL);
+    ASSERT(gpio != NULL);
+    ASSERT(gpio->intNo < MAX_IRQ_LINES);
+
+    const uint8_t id = CreateEvent(name, callback, context, EVENT_TYPE_INTERRUPT);
+    m_eventConfig[id].irqGpio = gpio;
+    m_eventConfig[id].irqMode = irqMode;
+    m_eventConfig[id].irqPriority = irqPriority;
+
+    LOG_INFO(LOG_MODULE_APP_EVENT, EVENT_ID(id), EVENT_LOG_REGISTERED, EVENT_TYPE_INTERRUPT);
+
+    *eventId = EVENT_ID(id);
+}
+
+bool AppEvent_Unregister(uint8_t id)
+{
+    GET_EVENT_INDEX(id, false);
+
+    const uint32_t bit = EVENT_BIT(id);
+
+    StopEvent(id);
+    LOG_INFO(LOG_MODULE_APP_EVENT, EVENT_ID(id), EVENT_LOG_UNREGISTERED, 0);
+
+    /* A late trigger from an interrupt is dropped, the slot does not belong to any loop or priority any more */
+    CRITICAL_SECTION_BEGIN();
+    m_usedMask &= ~bit;
+    m_generations[id] = (m_generations[id] + 1) & EVENT_GENERATION_MASK;
+    for (uint8_t loop = 0; loop < APP_EVENT_NUM_LOOPS; ++loop)
+    {
+        m_loopMasks[loop] &= ~bit;
+    }
+    for (uint8_t level = 0; level < APP_EVENT_NUM_PRIORITIES; ++level)
+    {
+        m_priorityMasks[level] &= ~bit;
+    }
+    ClearEventBits(&m_pendingMask, bit);
+    CRITICAL_SECTION_END();
+
+    /* The groups would otherwise act on the event registered next in the slot */
+    for (uint8_t i = 0; i < APP_EVENT_MAX_GROUPS; ++i)
+    {
+        m_groupMasks[i] &= ~bit;
+    }
+    if (m_eventConfig[id].type == EVENT_TYPE_TIMER)
+    {
+        m_usedTimerSlots &= ~EVENT_BIT(m_eventConfig[id].timerSlot);
+    }
+    if ((m_batchedMask & bit) && (m_batches[id].window != 0))
+    {
+        m_usedBatchWindows &= (uint8_t)~EVENT_BIT(m_batches[id].node - MAX_TIMER_EVENTS);
+    }
+    m_batchedMask &= ~bit;
+    m_queuedMask &= ~bit;
+
+    return true;
+}
+
+#endif /* APP_EVENT_STATIC_TABLE */
+
+static void StartEventAs(uint8_t id, bool single)
+{
+    ClearEventBits(&m_pendingMask, EVENT_BIT(id));
+    if (single)
+    {
+        m_singleMask |= EVENT_BIT(id);
+    }
+    else
+    {
+        m_singleMask &= ~EVENT_BIT(id);
+    }
+    m_diagnostics[id].startTime = TimerGetCurrentTime();
+
+    StartEvent(id);
+}
+
+bool AppEvent_Start(uint8_t id, bool single)
+{
+    GET_EVENT_INDEX(id, false);
+
+    StartEventAs(id, single);
+
+    return true;
+}
+
+bool AppEvent_Stop(uint8_t id)
+{
+    GET_EVENT_INDEX(id, false);
+
+    StopEvent(id);
+
+    return true;
+}
+
+uint32_t AppEvent_GetTimeout(uint8_t id)
+{
+    GET_EVENT_INDEX(id, 0);
+
+    return GetTimer(id)->timeout;
+}
+
+bool AppEvent_SetTimeout(uint8_t id, uint32_t timeout)
+{
+    GET_EVENT_INDEX(id, false);
+
+    EventTimer_t* const timer = GetTimer(id);
+
+    EVENT_LOG_DEBUG(id, EVENT_LOG_SET_TIMEOUT, timeout);
+    WarnShortTimeout(id, timeout);
+    CancelTimer(timer);
+    ClearEventBits(&m_pendingMask, EVENT_BIT(id));
+    if (m_queuedMask & EVENT_BIT(id))
+    {
+        DiscardRecords(id);
+    }
+    timer->timeout = timeout;
+
+    return true;
+}
+
+bool AppEvent_SetSlack(uint8_t id, uint32_t slack)
+{
+    GET_EVENT_INDEX(id, false);
+
+    GetTimer(id)->slack = slack;
+
+    return true;
+}
+
+bool AppEvent_SeedRandomizer(uint8_t id, uint32_t seed)
+{
+    GET_EVENT_INDEX(id, false);
+
+    CRITICAL_SECTION_BEGIN();
+    GetTimer(id)->randomState = (seed != 0) ? seed : RANDOM_SEED(id);
+    CRITICAL_SECTION_END();
+
+    return true;
+}
+
+bool AppEvent_SetSchedule(uint8_t id, APP_EVENT_SCHEDULES schedule)
+{
+    GET_EVENT_INDEX(id, false);
+
+    GetTimer(id)->schedule = schedule;
+
+    return true;
+}
+
+uint32_t AppEvent_GetOverrunCount(uint8_t id)
+{
+    GET_EVENT_INDEX(id, 0);
+
+    return m_diagnostics[id].overrunCount;
+}
+
+uint32_t AppEvent_GetDropCount(uint8_t id)
+{
+    GET_EVENT_INDEX(id, 0);
+
+    return m_diagnostics[id].dropCount;
+}
+
+bool AppEvent_GetStats(uint8_t id, AppEvent_Stats_t* stats)
+{
+    GET_EVENT_INDEX(id, false);
+    ASSERT(stats != NULL);
+
+    const EventDiagnostics_t* const diagnostics = &m_diagnostics[id];
+
+    CRITICAL_SECTION_BEGIN();
+    stats->startTime = diagnostics->startTime;
+    stats->triggerCount = COUNTER_READ(diagnostics->triggerCount);
+    stats->processCount = COUNTER_READ(diagnostics->processCount);
+    stats->overrunCount = diagnostics->overrunCount;
+    stats->dropCount = diagnostics->dropCount;
+#ifdef APP_EVENT_HISTOGRAMS
+    stats->latency = diagnostics->latency;
+    stats->execution = diagnostics->execution;
+#else
+    memset(&stats->latency, 0, sizeof(stats->latency));
+    memset(&stats->execution, 0, sizeof(stats->execution));
+#endif
+    CRITICAL_SECTION_END();
+
+    return true;
+}
+
+bool AppEvent_ResetStats(uint8_t id)
+{
+    GET_EVENT_INDEX(id, false);
+
+    EventDiagnostics_t* const diagnostics = &m_diagnostics[id];
+
+    CRITICAL_SECTION_BEGIN();
+    COUNTER_RESET(diagnostics->triggerCount);
+    COUNTER_RESET(diagnostics->processCount);
+    diagnostics->overrunCount = 0;
+    diagnostics->dropCount = 0;
+#ifdef APP_EVENT_HISTOGRAMS
+    memset(&diagnostics->latency, 0, sizeof(diagnostics->latency));
+    memset(&diagnostics->execution, 0, sizeof(diagnostics->execution));
+#endif
+    CRITICAL_SECTION_END();
+
+    return true;
+}
+
+uint32_t AppEvent_TimeRemaining(uint8_t id)
+{
+    GET_EVENT_INDEX(id, 0);
+
+    const TimerTime_t now = TimerGetCurrentTime();
+
+    if (((LoadEventBits(&m_runningMask) & EVENT_BIT(id)) == 0)
+        || !TimerTime_IsBefore(now, GetTimer(id)->deadline))
+    {
+        return 0;
+    }
+    return GetTimer(id)->deadline - now;
+}
+
+bool AppEvent_Running(uint8_t id)
+{
+    GET_EVENT_INDEX(id, false);
+
+    return (LoadEventBits(&m_runningMask) & EVENT_BIT(id)) != 0;
+}
+
+static uint32_t GetReadyEvents(uint32_t loopMask, uint32_t served)
+{
+    const uint32_t ready = LoadEventBits(&m_pendingMask) & loopMask & ~LoadEventBits(&m_pausedMask) & ~served;
+
+    if (ready != 0)
+    {
+        for (int8_t priority = APP_EVENT_NUM_PRIORITIES - 1; priority >= 0; --priority)
+        {
+            const uint32_t readyAtPriority = ready & m_priorityMasks[priority];
+            if (readyAtPriority != 0)
+            {
+                return readyAtPriority;
+            }
+        }
+    }
+
+    return 0;
+}
+
+void AppEvent_ProcessMainEvents(void)
+{
+    AppEvent_ProcessLoopEvents(APP_EVENT_LOOP_DEFAULT);
+}
+
+void AppEvent_ProcessLoopEvents(uint8_t loop)
+{
+    ASSERT(loop < APP_EVENT_NUM_LOOPS);
+
+    const uint32_t loopMask = m_loopMasks[loop];
+    uint32_t served = 0;
+
+    EndWakeupAdvance();
+
+    /* Re-evaluate after every callback so that a higher priority event triggered meanwhile runs next.
+     * Each event runs at most once per pass; whatever is left over stays pending for the next pass. */
+    for (uint8_t budget = APP_EVENT_DISPATCH_BUDGET; budget > 0; --budget)
+    {
+        const uint32_t ready = GetReadyEvents(loopMask, served);
+        if (ready == 0)
+        {
+            break;
+        }
+
+        const uint8_t id = LOWEST_BIT_INDEX(ready);
+        const uint32_t bit = EVENT_BIT(id);
+        uint32_t triggerTicks;
+
+        served |= bit;
+        if (!TakePendingBit(id, &triggerTicks))
+        {
+            continue;   /* Cleared meanwhile by AppEvent_Stop/SetTimeout from another context */
+        }
+
+        /* Continuous timer events stopped after they were triggered are dropped; general, interrupt,
+         * single trigger and still running timer events are processed */
+        if ((m_timerMask & ~m_singleMask & ~LoadEventBits(&m_runningMask) & bit) != 0)
+        {
+            continue;
+        }
+
+        if ((m_batchedMask & bit) && HoldBatch(id))
+        {
+            continue;
+        }
+
+        EVENT_LOG_DEBUG(id, EVENT_LOG_PROCESS, 0);
+        STATS_DISPATCH(id, triggerTicks);
+        APP_EVENT_HOOK_DISPATCH_BEGIN(id);
+        EVENT_TRACE(TRACE_EVENT_CALLBACK_BEGIN, id, 0);
+        if (m_queuedMask & bit)
+        {
+            DrainQueue(id);
+        }
+        else if (m_batchedMask & bit)
+        {
+            RunBatch(id);
+        }
+        else
+        {
+            COUNTER_INCREMENT(m_diagnostics[id].processCount);
+            if (m_callbacks[id] != NULL)
+            {
+                (*(m_callbacks[id]))();
+            }
+        }
+        EVENT_TRACE(TRACE_EVENT_CALLBACK_END, id, 0);
+        APP_EVENT_HOOK_DISPATCH_END(id);
+        STATS_EXECUTE_END(id);
+    }
+}
+
+bool AppEvent_EnableQueue(uint8_t id, AppEvent_Record_t* buffer, uint8_t size,
+                          AppEvent_RecordCallback callback, void* context)
+{
+    GET_EVENT_INDEX(id, false);
+    ASSERT(buffer != NULL);
+    ASSERT(callback != NULL);
+    ASSERT((size > 0) && (size <= MAX_QUEUE_SIZE) && ((size & (size - 1)) == 0));
+    ASSERT((m_batchedMask & EVENT_BIT(id)) == 0);
+
+    EventQueue_t* const queue = &m_queues[id];
+    queue->buffer = buffer;
+    queue->mask = size - 1;
+    queue->head = 0;
+    queue->tail = 0;
+    queue->context = context;
+    queue->callback = callback;
+    m_queuedMask |= EVENT_BIT(id);
+
+    return true;
+}
+
+bool AppEvent_EnableBatching(uint8_t id, uint32_t window, AppEvent_BatchCallback callback, void* context)
+{
+    GET_EVENT_INDEX(id, false);
+    ASSERT(callback != NULL);
+    ASSERT((m_queuedMask & EVENT_BIT(id)) == 0);
+    ASSERT((m_batchedMask & EVENT_BIT(id)) == 0);
+
+    EventBatch_t* const batch = &m_batches[id];
+
+    memset(batch, 0, sizeof(*batch));
+    batch->callback = callback;
+    batch->context = context;
+    batch->window = window;
+    batch->holdUntil = TimerGetCurrentTime();
+    batch->node = TIMER_NOT_QUEUED;
+    if (window != 0)
+    {
+        ASSERT(m_usedBatchWindows != ALL_BATCH_WINDOWS_MASK);
+
+        const uint8_t windowNode = LOWEST_BIT_INDEX(~m_usedBatchWindows & ALL_BATCH_WINDOWS_MASK);
+        m_usedBatchWindows |= (uint8_t)EVENT_BIT(windowNode);
+        batch->node = MAX_TIMER_EVENTS + windowNode;
+        EventTimer_t* const node = &m_timers[batch->node];
+        memset(node, 0, sizeof(*node));
+        node->eventId = id;
+        node->timeout = window;
+        node->heapIndex = TIMER_NOT_QUEUED;
+    }
+    m_batchedMask |= EVENT_BIT(id);
+
+    return true;
+}
+
+bool AppEvent_SetPriority(uint8_t id, APP_EVENT_PRIORITIES priority)
+{
+    GET_EVENT_INDEX(id, false);
+    ASSERT(priority < APP_EVENT_NUM_PRIORITIES);
+
+    for (uint8_t level = 0; level < APP_EVENT_NUM_PRIORITIES; ++level)
+    {
+        m_priorityMasks[level] &= ~EVENT_BIT(id);
+    }
+    m_priorityMasks[priority] |= EVENT_BIT(id);
+
+    return true;
+}
+
+bool AppEvent_SetLoop(uint8_t id, uint8_t loop)
+{
+    GET_EVENT_INDEX(id, false);
+    ASSERT(loop < APP_EVENT_NUM_LOOPS);
+
+    CRITICAL_SECTION_BEGIN();
+    for (uint8_t i = 0; i < APP_EVENT_NUM_LOOPS; ++i)
+    {
+        m_loopMasks[i] &= ~EVENT_BIT(id);
+    }
+    m_loopMasks[loop] |= EVENT_BIT(id);
+    CRITICAL_SECTION_END();
+
+    return true;
+}
+
+bool AppEvent_Pause(uint8_t id)
+{
+    GET_EVENT_INDEX(id, false);
+
+    ASSERT(m_eventConfig[id].context == APP_EVENT_CONTEXT_MAIN);
+    SetEventBits(&m_pausedMask, EVENT_BIT(id));
+
+    return true;
+}
+
+bool AppEvent_Resume(uint8_t id)
+{
+    GET_EVENT_INDEX(id, false);
+
+    ASSERT(m_eventConfig[id].context == APP_EVENT_CONTEXT_MAIN);
+    ClearEventBits(&m_pausedMask, EVENT_BIT(id));
+
+    return true;
+}
+
+bool AppEvent_GroupCreate(AppEvent_Group_t* group)
+{
+    ASSERT(group != NULL);
+
+    const uint32_t freeGroups = ~m_usedGroups & (uint32_t)(((uint64_t)1 << APP_EVENT_MAX_GROUPS) - 1);
+    if (freeGroups == 0)
+        return false;
+
+    const uint8_t index = LOWEST_BIT_INDEX(freeGroups);
+    m_groupMasks[index] = 0;
+    m_usedGroups |= EVENT_BIT(index);
+    *group = GROUP_ID(index);
+
+    return true;
+}
+
+bool AppEvent_GroupDelete(AppEvent_Group_t group)
+{
+    if (!IsValidGroup(group))
+        return false;
+
+    const uint8_t index = EVENT_INDEX(group);
+    m_usedGroups &= ~EVENT_BIT(index);
+    m_groupMasks[index] = 0;
+    m_groupGenerations[index] = (m_groupGenerations[index] + 1) & EVENT_GENERATION_MASK;
+
+    return true;
+}
+
+bool AppEvent_GroupAdd(AppEvent_Group_t group, uint8_t id)
+{
+    GET_EVENT_INDEX(id, false);
+    if (!IsValidGroup(group))
+        return false;
+
+    m_groupMasks[EVENT_INDEX(group)] |= EVENT_BIT(id);
+
+    return true;
+}
+
+bool AppEvent_GroupRemove(AppEvent_Group_t group, uint8_t id)
+{
+    GET_EVENT_INDEX(id, false);
+    if (!IsValidGroup(group))
+        return false;
+
+    m_groupMasks[EVENT_INDEX(group)] &= ~EVENT_BIT(id);
+
+    return true;
+}
+
+void AppEvent_TriggerGroup(AppEvent_Group_t group)
+{
+    const uint32_t events = GetGroupEvents(group);
+    /* Events that need more than their pending bit go through DoTrigger */
+    const uint32_t plain = events & ~(m_immediateMask | m_queuedMask | m_batchedMask);
+
+    for (uint32_t bits = plain; bits != 0; bits &= bits - 1)
+    {
+        const uint8_t id = LOWEST_BIT_INDEX(bits);
+
+        EVENT_TRACE(TRACE_EVENT_TRIGGER, id, 0);
+        COUNTER_INCREMENT(m_diagnostics[id].triggerCount);
+    }
+    SetPendingBits(plain);
+
+    for (uint32_t bits = events & ~plain; bits != 0; bits &= bits - 1)
+    {
+        DoTrigger(LOWEST_BIT_INDEX(bits), 0);
+    }
+}
+
+void AppEvent_StartGroup(AppEvent_Group_t group, bool single)
+{
+    for (uint32_t bits = GetGroupEvents(group); bits != 0; bits &= bits - 1)
+    {
+        StartEventAs(LOWEST_BIT_INDEX(bits), single);
+    }
+}
+
+void AppEvent_StopGroup(AppEvent_Group_t group)
+{
+    for (uint32_t bits = GetGroupEvents(group); bits != 0; bits &= bits - 1)
+    {
+        StopEvent(LOWEST_BIT_INDEX(bits));
+    }
+}
+
+void AppEvent_PauseGroup(AppEvent_Group_t group)
+{
+    const uint32_t events = GetGroupEvents(group);
+
+    ASSERT((events & m_immediateMask) == 0);
+    SetEventBits(&m_pausedMask, events);
+}
+
+void AppEvent_ResumeGroup(AppEvent_Group_t group)
+{
+    const uint32_t events = GetGroupEvents(group);
+
+    ASSERT((events & m_immediateMask) == 0);
+    ClearEventBits(&m_pausedMask, events);
+}
+
+bool AppEvent_IsIdle(void)
+{
+    return LoadEventBits(&m_pendingMask) == 0;
+}
+
+bool AppEvent_IsLoopIdle(uint8_t loop)
+{
+    ASSERT(loop < APP_EVENT_NUM_LOOPS);
+
+    return (LoadEventBits(&m_pendingMask) & m_loopMasks[loop]) == 0;
+}
+
+uint32_t AppEvent_NextDeadline(void)
+{
+    uint32_t remaining = APP_EVENT_NO_DEADLINE;
+
+    CRITICAL_SECTION_BEGIN();
+    if (m_timerHeapSize > 0)
+    {
+        const TimerTime_t now = TimerGetCurrentTime();
+        const TimerTime_t expiry = GetLatestExpiry(m_timerHeap[0]);
+        remaining = TimerTime_IsBefore(now, expiry) ? (expiry - now) : 0;
+    }
+    CRITICAL_SECTION_END();
+
+    return remaining;
+}
+
+void AppEvent_SetSleepStates(const AppEvent_SleepState_t* states, uint8_t numStates)
+{
+    ASSERT((states != NULL) || (numStates == 0));
+    ASSERT(numStates < APP_EVENT_NO_SLEEP);
+
+    m_sleepStates = states;
+    m_numSleepStates = numStates;
+}
+
+uint8_t AppEvent_SelectSleepState(void)
+{
+    if ((LoadEventBits(&m_pendingMask) & ~LoadEventBits(&m_pausedMask)) != 0)
+    {
+        EndWakeupAdvance();
+        return APP_EVENT_NO_SLEEP;      /* The main loop has work to do */
+    }
+
+    const uint32_t remaining = AppEvent_NextDeadline();
+    for (uint8_t state = m_numSleepStates; state > 0; --state)
+    {
+        const AppEvent_SleepState_t* const sleepState = &m_sleepStates[state - 1];
+        const uint64_t required = (uint64_t)sleepState->wakeupLatency + sleepState->minResidency;
+
+        if ((remaining == APP_EVENT_NO_DEADLINE) || (required <= remaining))
+        {
+            CRITICAL_SECTION_BEGIN();
+            m_wakeupAdvance = sleepState->wakeupLatency;
+            ArmTimer();
+            CRITICAL_SECTION_END();
+            return state - 1;
+        }
+    }
+
+    EndWakeupAdvance();
+    return APP_EVENT_NO_SLEEP;
+}
+
+#ifdef APP_EVENT_HISTOGRAMS
+static void PrintHistogram(const char* name, const AppEvent_Histogram_t* histogram)
+{
+    if (histogram->count == 0)
+    {
+        return;
+    }
+
+    DEBUG_PRINTF("  %s: n=%lu min=%lu max=%lu |", name, (unsigned long)histogram->count,
+                 (unsigned long)histogram->min, (unsigned long)histogram->max);
+    for (uint8_t bucket = 0; bucket < APP_EVENT_HISTOGRAM_BUCKETS; ++bucket)
+    {
+        if (histogram->buckets[bucket] != 0)
+        {
+            DEBUG_PRINTF(" %u:%lu", bucket, (unsigned long)histogram->buckets[bucket]);
+        }
+    }
+    if (histogram->overflow != 0)
+    {
+        DEBUG_PRINTF(" >:%lu", (unsigned long)histogram->overflow);
+    }
+    DEBUG_PRINTF("\r\n");
+}
+#endif
+
+void AppEvent_PrintDiagnostics(void)
+{
+    DEBUG_PRINTF("--------------------\r\n");
+    DEBUG_PRINTF("AppEvent Diagnostics\r\n");
+    for (uint32_t events = m_usedMask; events != 0; events &= events - 1)
+    {
+        const uint8_t id = LOWEST_BIT_INDEX(events);
+        const EventDiagnostics_t* diagnostics = &m_diagnostics[id];
+        DEBUG_PRINTF("%s[%u]: triggered=%lu, processed=%lu, overruns=%lu, dropped=%lu, elapsedSinceStart=%.1fs\r\n",
+                     GetEventName(id), id, (unsigned long)COUNTER_READ(diagnostics->triggerCount),
+                     (unsigned long)COUNTER_READ(diagnostics->processCount),
+                     (unsigned long)diagnostics->overrunCount, (unsigned long)diagnostics->dropCount,
+                     TimerGetElapsedTime(diagnostics->startTime) / 1000.0);
+#ifdef APP_EVENT_HISTOGRAMS
+        PrintHistogram("latency", &diagnostics->latency);
+        PrintHistogram("exec", &diagnostics->execution);
+#endif
+    }
+    DEBUG_PRINTF("--------------------\r\n");
+}
+
+bool AppEvent_EnableDebug(uint8_t id)
+{
+    GET_EVENT_INDEX(id, false);
+
+    m_debugMask |= EVENT_BIT(id);
+    LOG_INFO(LOG_MODULE_APP_EVENT, EVENT_ID(id), EVENT_LOG_DEBUG_ENABLED, 0);
+
+    return true;
+}
+
+bool AppEvent_DisableDebug(uint8_t id )
+{
+    GET_EVENT_INDEX(id, false);
+
+    m_debugMask &= ~EVENT_BIT(id);
+    LOG_INFO(LOG_MODULE_APP_EVENT, EVENT_ID(id), EVENT_LOG_DEBUG_DISABLED, 0);
+
+    return true;
 }
 
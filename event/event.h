@@ -5,17 +5,155 @@
 #include <stdint.h>
 
 #include "gpio.h"
+#include "timer.h"
 
 typedef void (* AppEvent_Callback)(void);
+
+/* One trigger of a queued event, see AppEvent_EnableQueue() */
+typedef struct
+{
+    TimerTime_t timestamp;         /* Time of the trigger */
+    uint32_t payload;              /* AppEvent_TriggerWithPayload() value, pin level for interrupt events, 0 otherwise */
+} AppEvent_Record_t;
+
+typedef void (* AppEvent_RecordCallback)(void* context, const AppEvent_Record_t* record);
+
+/* Triggers of a batching event since its previous callback, see AppEvent_EnableBatching() */
+typedef struct
+{
+    uint32_t count;                /* Number of triggers */
+    TimerTime_t first;             /* Time of the first trigger */
+    TimerTime_t last;              /* Time of the last trigger */
+} AppEvent_Batch_t;
+
+typedef void (* AppEvent_BatchCallback)(void* context, const AppEvent_Batch_t* batch);
+
+/*
+ * Timing histograms, enabled with APP_EVENT_HISTOGRAMS.
+ *
+ * Samples are cycle counter ticks (see cycle-counter.h), shifted right by APP_EVENT_HISTOGRAM_SHIFT.
+ * buckets[0] counts samples of 0, buckets[i] counts samples in [2^(i-1), 2^i).
+ */
+#ifndef APP_EVENT_HISTOGRAM_BUCKETS
+#define APP_EVENT_HISTOGRAM_BUCKETS     20
+#endif
+
+#ifndef APP_EVENT_HISTOGRAM_SHIFT
+#define APP_EVENT_HISTOGRAM_SHIFT       0
+#endif
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;                  /* Ticks, unshifted */
+    uint32_t max;                  /* Ticks, unshifted */
+    uint32_t overflow;             /* Samples beyond the last bucket */
+    uint32_t buckets[APP_EVENT_HISTOGRAM_BUCKETS];
+} AppEvent_Histogram_t;
+
+typedef struct
+{
+    TimerTime_t startTime;         /* Time of the last AppEvent_Start() */
+    uint32_t triggerCount;
+    uint32_t processCount;
+    uint32_t overrunCount;         /* Periods missed by an APP_EVENT_SCHEDULE_ABSOLUTE event */
+    uint32_t dropCount;            /* Triggers lost to a full record queue */
+    /* Same layout with and without APP_EVENT_HISTOGRAMS, the histograms stay zero without it */
+    AppEvent_Histogram_t latency;  /* Trigger to main loop dispatch, main context events only. Records left
+                                    * over by a queue drain count from the end of that drain, held batches
+                                    * from the end of their window. */
+    AppEvent_Histogram_t execution;/* Callback execution, all records of a queued event count as one */
+} AppEvent_Stats_t;
+
+#ifdef APP_EVENT_STATIC_TABLE
+/*
+ * Compile-time event table.
+ *
+ * With APP_EVENT_STATIC_TABLE defined, the application declares all of its events in "AppEventTable.h"
+ * instead of registering them at runtime:
+ *
+ *     extern Gpio_t m_buttonGpio;
+ *
+ *     #define APP_EVENT_TABLE \
+ *         APP_EVENT_TIMER(LED_BLINK, OnLedBlink, 500, 0, APP_EVENT_CONTEXT_MAIN) \
+ *         APP_EVENT_INTERRUPT(BUTTON, OnButton, &m_buttonGpio, IRQ_FALLING_EDGE, IRQ_LOW_PRIORITY, APP_EVENT_CONTEXT_MAIN) \
+ *         APP_EVENT_GENERAL(RADIO_IDLE, OnRadioIdle, APP_EVENT_CONTEXT_MAIN)
+ *
+ *     APP_EVENT_GENERAL(id, callback, context)
+ *     APP_EVENT_TIMER(id, callback, timeout, timeoutRandomizer, context)
+ *     APP_EVENT_INTERRUPT(id, callback, gpio, irqMode, irqPriority, context)
+ *
+ * Each entry gets the identifier APP_EVENT_ID_<id> and is named "<id>" in the debug output.
+ * The event configuration is placed in flash, MAX_EVENTS is the number of entries and only timer
+ * entries get timer state. AppEvent_Register* are not available in this mode; call AppEvent_Init()
+ * and use the identifiers directly.
+ */
+#include "AppEventTable.h"
+
+enum
+{
+#define APP_EVENT_GENERAL(id, ...)              APP_EVENT_ID_##id,
+#define APP_EVENT_TIMER(id, ...)                APP_EVENT_ID_##id,
+#define APP_EVENT_INTERRUPT(id, ...)            APP_EVENT_ID_##id,
+    APP_EVENT_TABLE
+#undef APP_EVENT_GENERAL
+#undef APP_EVENT_TIMER
+#undef APP_EVENT_INTERRUPT
+    APP_EVENT_COUNT
+};
+#endif /* APP_EVENT_STATIC_TABLE */
 typedef enum
 {
     APP_EVENT_CONTEXT_MAIN,        /* Process in the main event loop */
     APP_EVENT_CONTEXT_IMMEDIATE,   /* Process as soon as event is triggered, could be timer or interrupt context */
 } APP_EVENT_CONTEXTS;
 
+typedef enum
+{
+    APP_EVENT_PRIORITY_LOW,
+    APP_EVENT_PRIORITY_NORMAL,     /* Default priority of a registered event */
+    APP_EVENT_PRIORITY_HIGH,
+    APP_EVENT_PRIORITY_CRITICAL,
+    APP_EVENT_NUM_PRIORITIES
+} APP_EVENT_PRIORITIES;
+
+/* Main context event loops, see AppEvent_SetLoop() */
+#ifndef APP_EVENT_NUM_LOOPS
+#define APP_EVENT_NUM_LOOPS     4
+#endif
+
+#define APP_EVENT_LOOP_DEFAULT  0   /* Loop of a registered event, drained by AppEvent_ProcessMainEvents() */
+
+/* Low power state of the application, see AppEvent_SetSleepStates() */
+typedef struct
+{
+    uint32_t wakeupLatency;        /* ms from the wake-up interrupt until the CPU runs again */
+    uint32_t minResidency;         /* ms the state must last to be worth its entry and exit cost */
+} AppEvent_SleepState_t;
+
+#define APP_EVENT_NO_DEADLINE   UINT32_MAX
+#define APP_EVENT_NO_SLEEP      0xFF
+
+/* Handle of a set of events handled as a unit, see AppEvent_GroupCreate() and AppEvent_TriggerGroup() */
+typedef uint8_t AppEvent_Group_t;
+
+typedef enum
+{
+    APP_EVENT_SCHEDULE_RELATIVE,   /* Next period starts when the event is re-armed (default) */
+    APP_EVENT_SCHEDULE_ABSOLUTE,   /* Next period starts at the previous deadline, no drift */
+} APP_EVENT_SCHEDULES;
+
 
 void AppEvent_Init(void);
 
+/**
+ * @brief Stops every event and releases the hardware timer and interrupt lines.
+ * @notes AppEvent_Init() must be called again before the module is used. Registered events are dropped,
+ * except with APP_EVENT_STATIC_TABLE where the table is kept.
+ */
+void AppEvent_DeInit(void);
+
+#ifndef APP_EVENT_STATIC_TABLE
 /**
  * @brief Register a generic (manually triggered event)
  * @param id: returned identifier of the event if it is successfully registered
@@ -25,13 +163,24 @@ void AppEvent_Init(void);
  */
 void AppEvent_RegisterEvent(uint8_t* const eventId, const char* const name, AppEvent_Callback callback,
                             APP_EVENT_CONTEXTS context);
+#endif /* APP_EVENT_STATIC_TABLE */
 
 /**
  * @brief Manually trigger an event (ie. put it in the event loop)
  * @param id: identifier of the event to be triggered
+ * @notes Identifiers of unregistered events are ignored
  */
 void AppEvent_Trigger( uint8_t eventId );
 
+/**
+ * @brief Manually trigger an event and attach a payload to the trigger
+ * @param id: identifier of the event to be triggered
+ * @param payload: value passed in the record of a queued event (see AppEvent_EnableQueue), ignored otherwise
+ * @notes Identifiers of unregistered events are ignored
+ */
+void AppEvent_TriggerWithPayload( uint8_t eventId, uint32_t payload );
+
+#ifndef APP_EVENT_STATIC_TABLE
 /**
  * @brief Register a timer driven event and use a randomizer to add jitter to the event period
  * @param id: returned identifier of the event if it is successfully registered
@@ -64,26 +213,45 @@ void AppEvent_RegisterTimer(uint8_t* const id, const char* const name, AppEvent_
  * @param irqMode: desired interrupt mode
  * @param irqPriority: desired interrupt priority
  * @param context: context in which the event callback will execute once triggered
+ * @notes Several events may be registered on the same interrupt line; all started ones are triggered
+ *        by the interrupt. The line is configured with the irqMode/irqPriority of the last started event.
  */
 void AppEvent_RegisterInterrupt( uint8_t* const eventId, const char* const name, AppEvent_Callback callback,
                                  Gpio_t* gpio, IrqModes irqMode, IrqPriorities irqPriority, APP_EVENT_CONTEXTS context);
+
+/**
+ * @brief Stop an event and release its slot, timer and batch window for later registrations
+ * @param id: event identifier
+ * @notes The identifier is invalid afterwards: the functions taking it ignore it and return false (or 0),
+ *        also when the slot is registered again (the identifier carries a slot generation, which only
+ *        repeats after 8 re-registrations of the same slot). A pending trigger is dropped.
+ *        The event is removed from its groups, and the record queue buffer given to
+ *        AppEvent_EnableQueue() can be reused once this returns.
+ * @returns false if @p id is not a registered event
+ */
+bool AppEvent_Unregister(uint8_t id);
+#endif /* APP_EVENT_STATIC_TABLE */
+
 /**
  * @brief Start/activate an  event
  * @param id: event identifier
  * @param single: set true for a single trigger event; false for a continuous trigger event
+ * @returns false if @p id is not a registered event
  */
-void AppEvent_Start(uint8_t id, bool single);
+bool AppEvent_Start(uint8_t id, bool single);
 
 /**
  * @brief Stop an event
  * @param id: event identifier
+ * @notes The queued records of a timer event not yet handed to its record callback are discarded.
+ * @returns false if @p id is not a registered event
  */
-void AppEvent_Stop(uint8_t id);
+bool AppEvent_Stop(uint8_t id);
 
 /**
  * @brief Returns the configured timeout value of the event
  * @param id: event identifier
- * @returns timeout in ms
+ * @returns timeout in ms, 0 if @p id is not a registered event
  */
 uint32_t AppEvent_GetTimeout(uint8_t id);
 
@@ -91,68 +259,315 @@ uint32_t AppEvent_GetTimeout(uint8_t id);
  * @brief Sets the configured timeout of the event
  * @param id: event identifier
  * @param timeout: desired timeout value in ms
+ * @notes Stops the timer: a pending expiry and the queued records not yet handed to the record callback
+ *        are discarded.
+ * @returns false if @p id is not a registered event
+ */
+bool AppEvent_SetTimeout(uint8_t id, uint32_t timeout);
+
+/**
+ * @brief Allow a timer event to fire late so that it can share a wakeup with other timer events
+ * @param id: event identifier
+ * @param slack: tolerated delay past the event deadline in ms (0 by default)
+ * @notes All timer events share a single hardware timer. It is programmed for the earliest
+ *        deadline + slack of the running events, and every event whose deadline has been reached
+ *        by then is triggered in the same wakeup. Takes effect from the next start of the event.
+ * @returns false if @p id is not a registered event
+ */
+bool AppEvent_SetSlack(uint8_t id, uint32_t slack);
+
+/**
+ * @brief Seed the randomizer jitter of a timer event, e.g. for reproducible tests
+ * @param id: event identifier
+ * @param seed: state of the event's xorshift32 generator, 0 restores the default seed of the event
+ * @notes Each timer event has its own generator, seeded from its identifier slot at registration, so the
+ *        jitter sequence of an event does not depend on the other events. rand() is not used.
+ * @returns false if @p id is not a registered event
+ */
+bool AppEvent_SeedRandomizer(uint8_t id, uint32_t seed);
+
+/**
+ * @brief Select how a continuous timer event computes its next deadline
+ * @param id: event identifier
+ * @param schedule: APP_EVENT_SCHEDULE_RELATIVE re-arms the timer "timeout" ms after it fired, so
+ *        callback and interrupt latency add up over time. APP_EVENT_SCHEDULE_ABSOLUTE re-arms it
+ *        "timeout" ms after the previous deadline. The randomizer jitter is applied on top of each
+ *        deadline without accumulating. If a deadline has already passed when the event is re-armed,
+ *        the missed periods are skipped and counted as overruns. A period firing late by no more than
+ *        its jitter plus the slack is not an overrun, even when both exceed the timeout.
+ * @returns false if @p id is not a registered event
+ */
+bool AppEvent_SetSchedule(uint8_t id, APP_EVENT_SCHEDULES schedule);
+
+/**
+ * @brief Returns the number of periods missed by an APP_EVENT_SCHEDULE_ABSOLUTE event
+ * @param id: event identifier
+ * @returns missed periods, 0 if @p id is not a registered event
+ */
+uint32_t AppEvent_GetOverrunCount(uint8_t id);
+
+/**
+ * @brief Returns the number of triggers lost to the full record queue of an event, see AppEvent_EnableQueue()
+ * @param id: event identifier
+ * @returns dropped triggers, 0 if @p id is not a registered event
+ */
+uint32_t AppEvent_GetDropCount(uint8_t id);
+
+/**
+ * @brief Returns a snapshot of the statistics of an event
+ * @param id: event identifier
+ * @param stats: filled with the counters and, with APP_EVENT_HISTOGRAMS, the timing histograms (zero without)
+ * @returns false if @p id is not a registered event
  */
-void AppEvent_SetTimeout(uint8_t id, uint32_t timeout);
+bool AppEvent_GetStats(uint8_t id, AppEvent_Stats_t* stats);
+
+/**
+ * @brief Clears the counters and timing histograms of an event
+ * @param id: event identifier
+ * @returns false if @p id is not a registered event
+ */
+bool AppEvent_ResetStats(uint8_t id);
 
 /**
  * @brief Returns the time remaining before the event next triggers
  * @param id: event identifier
- * @returns time remaining in ms
+ * @returns time remaining in ms, 0 if @p id is not a registered event
  */
 uint32_t AppEvent_TimeRemaining(uint8_t id);
 
 /**
  * @brief Check if an event is running
  * @param id: event identifier
- * @returns true if the event is running; false otherwise
+ * @returns true if the event is running; false otherwise, or if @p id is not a registered event
  */
 bool AppEvent_Running(uint8_t id);
 
 /**
  * @brief Process all triggered events
- * @notes This method should be called in the main application loop
+ * @notes This method should be called in the main application loop.
+ *        Pending events run highest priority first; a higher priority event triggered by a callback
+ *        (or an interrupt) runs before the remaining lower priority ones. Each event runs at most once
+ *        per call and at most APP_EVENT_DISPATCH_BUDGET callbacks run per call; anything left over stays
+ *        pending (AppEvent_IsIdle() returns false) until the next call.
  */
 void AppEvent_ProcessMainEvents(void);
 
+/**
+ * @brief Process the triggered events bound to one event loop
+ * @param loop: event loop, below APP_EVENT_NUM_LOOPS
+ * @notes Same as AppEvent_ProcessMainEvents() for the events bound to @p loop. Each loop only claims
+ *        its own pending events, so different tasks of one core can each run one loop without a slow
+ *        callback in one loop delaying the others. A loop must only be run by one task at a time.
+ *        The default critical sections only mask the interrupts of the local core: running loops on
+ *        several cores requires APP_EVENT_ATOMIC, and even then only the triggers and the claims of
+ *        pending events are safe across cores. Starting and stopping events (the timer heap), the
+ *        loop, priority and pause settings and the event configuration must stay on one core.
+ */
+void AppEvent_ProcessLoopEvents(uint8_t loop);
+
+/**
+ * @returns true if none of the events bound to the loop are triggered
+ * @param loop: event loop, below APP_EVENT_NUM_LOOPS
+ */
+bool AppEvent_IsLoopIdle(uint8_t loop);
+
+/**
+ * @brief Record every trigger of an event instead of merging triggers that occur before it is processed
+ * @param id: event identifier
+ * @param buffer: caller provided storage for the queued records
+ * @param size: number of records in @p buffer, a power of two up to 128
+ * @param callback: called once per record, in trigger order, instead of the registered callback
+ * @param context: passed to @p callback
+ * @notes For APP_EVENT_CONTEXT_MAIN events the records are drained in one batch by AppEvent_ProcessMainEvents,
+ *        at most @p size records per pass: records left over are handled in the next pass.
+ *        Triggers arriving while the queue is full are dropped and counted in the diagnostics.
+ *        The queue is lock-free for a single producer: all triggers of the event must come from the same
+ *        context (one interrupt, the timer, or the main loop). APP_EVENT_CONTEXT_IMMEDIATE events call
+ *        @p callback directly with the record of the trigger.
+ * @returns false if @p id is not a registered event
+ */
+bool AppEvent_EnableQueue(uint8_t id, AppEvent_Record_t* buffer, uint8_t size,
+                          AppEvent_RecordCallback callback, void* context);
+
+/**
+ * @brief Coalesce the triggers of an event into one callback that receives the trigger count
+ * @param id: event identifier
+ * @param window: minimum time between two callbacks in ms, 0 to run at most once per main loop pass
+ * @param callback: called with the triggers counted since the previous call, instead of the registered
+ *        callback
+ * @param context: passed to @p callback
+ * @notes Meant for high rate sources (e.g. an encoder interrupt): triggers are only counted, so the main
+ *        loop load is bounded whatever the trigger rate and no trigger is lost. The callback always runs
+ *        from the event loop, also for APP_EVENT_CONTEXT_IMMEDIATE events. Triggers within @p window of
+ *        the previous callback are held and delivered when the window ends, through the shared event
+ *        timer, so sleep states still wake up in time. At most APP_EVENT_BATCH_WINDOWS events can use
+ *        a window. Not combinable with AppEvent_EnableQueue. With APP_EVENT_ATOMIC the count is exact,
+ *        first/last may belong to a neighbouring trigger when a trigger races with the callback.
+ * @returns false if @p id is not a registered event
+ */
+bool AppEvent_EnableBatching(uint8_t id, uint32_t window, AppEvent_BatchCallback callback, void* context);
+
+/**
+ * @brief Set the main loop processing priority of an event
+ * @param id: event identifier
+ * @param priority: desired priority, events are registered with APP_EVENT_PRIORITY_NORMAL
+ * @notes Only applicable to events registered in APP_EVENT_CONTEXT_MAIN
+ * @returns false if @p id is not a registered event
+ */
+bool AppEvent_SetPriority(uint8_t id, APP_EVENT_PRIORITIES priority);
+
+/**
+ * @brief Binds an event to the main context event loop that processes it
+ * @param id: event identifier
+ * @param loop: event loop, below APP_EVENT_NUM_LOOPS; events are registered in APP_EVENT_LOOP_DEFAULT
+ * @notes Only applicable to events registered in APP_EVENT_CONTEXT_MAIN. Bind events before they
+ *        are started; the loop of an event must not change while it may be pending.
+ * @returns false if @p id is not a registered event
+ */
+bool AppEvent_SetLoop(uint8_t id, uint8_t loop);
+
 /**
  * @brief Prevent an event from being processed in the main application loop
  * @notes Only applicable to eventss registered in APP_EVENT_CONTEXT_MAIN
+ * @returns false if @p id is not a registered event
  */
-void AppEvent_Pause(uint8_t id);
+bool AppEvent_Pause(uint8_t id);
 
 /**
  * @brief Allow event to be processed in the main application loop
  * @notes Only applicable to eventss registered in APP_EVENT_CONTEXT_MAIN
+ * @returns false if @p id is not a registered event
+ */
+bool AppEvent_Resume(uint8_t id);
+
+/**
+ * @brief Create an empty group
+ * @param group: set to the handle of the new group
+ * @notes The events of the groups are kept by the module, at most APP_EVENT_MAX_GROUPS groups at the same
+ *        time, so that AppEvent_Unregister() removes an event from all of them
+ * @returns false if APP_EVENT_MAX_GROUPS groups already exist
+ */
+bool AppEvent_GroupCreate(AppEvent_Group_t* group);
+
+/**
+ * @brief Delete a group, its events are left unchanged
+ * @param group: group handle
+ * @notes The handle is rejected by the group functions afterwards, like the identifier of an unregistered
+ *        event, and AppEvent_Init() deletes all the groups
+ * @returns false if @p group is not an existing group
  */
-void AppEvent_Resume(uint8_t id);
+bool AppEvent_GroupDelete(AppEvent_Group_t group);
+
+/**
+ * @brief Add an event to a group
+ * @param group: group handle
+ * @param id: event identifier
+ * @returns false if @p id is not a registered event or @p group is not an existing group, the group is
+ *          left unchanged
+ */
+bool AppEvent_GroupAdd(AppEvent_Group_t group, uint8_t id);
+
+/**
+ * @brief Remove an event from a group
+ * @param group: group handle
+ * @param id: event identifier
+ * @returns false if @p id is not a registered event or @p group is not an existing group
+ */
+bool AppEvent_GroupRemove(AppEvent_Group_t group, uint8_t id);
+
+/**
+ * @brief Trigger every event of a group, nothing for a deleted group
+ * @param group: events to trigger
+ * @notes Same as AppEvent_Trigger() on each event, in any context. The main context events without a
+ *        record queue or batching are made pending with a single OR into the pending mask (atomic with
+ *        APP_EVENT_ATOMIC, one critical section otherwise) and run in the same main loop pass; the others
+ *        are triggered one by one.
+ */
+void AppEvent_TriggerGroup(AppEvent_Group_t group);
+
+/**
+ * @brief Start every event of a group, see AppEvent_Start()
+ * @param group: events to start
+ * @param single: set true for single trigger events; false for continuous trigger events
+ */
+void AppEvent_StartGroup(AppEvent_Group_t group, bool single);
+
+/**
+ * @brief Stop every event of a group, see AppEvent_Stop()
+ * @param group: events to stop
+ */
+void AppEvent_StopGroup(AppEvent_Group_t group);
+
+/**
+ * @brief Pause every event of a group with a single update of the paused mask, see AppEvent_Pause()
+ * @param group: main context events to pause
+ */
+void AppEvent_PauseGroup(AppEvent_Group_t group);
+
+/**
+ * @brief Resume every event of a group with a single update of the paused mask, see AppEvent_Resume()
+ * @param group: main context events to resume
+ */
+void AppEvent_ResumeGroup(AppEvent_Group_t group);
 
 /**
  * @returns true if the event loop is idle, meaning there are no "triggered" events
  */
 bool AppEvent_IsIdle(void);
 
+/**
+ * @brief Returns the time until the next timer event must be handled
+ * @returns time in ms until the earliest timer expiry (its deadline plus slack), 0 if it is already due,
+ *          APP_EVENT_NO_DEADLINE if no timer event is running
+ * @notes Constant time, read from the root of the timer heap.
+ */
+uint32_t AppEvent_NextDeadline(void);
+
+/**
+ * @brief Sets the low power states AppEvent_SelectSleepState() chooses from
+ * @param states: sleep states ordered from the shallowest to the deepest, kept by reference
+ * @param numStates: number of entries in @p states
+ */
+void AppEvent_SetSleepStates(const AppEvent_SleepState_t* states, uint8_t numStates);
+
+/**
+ * @brief Chooses the deepest sleep state that still wakes up in time for the next timer deadline
+ * @returns index in the AppEvent_SetSleepStates() table, or APP_EVENT_NO_SLEEP if events are ready to be
+ *          processed or the next deadline is too close for every state
+ * @notes A state fits if its wakeupLatency plus minResidency does not exceed AppEvent_NextDeadline().
+ *        The hardware alarm is moved earlier by the wakeupLatency of the chosen state, so that the CPU
+ *        is running again at the deadline, until the alarm fires, the next event loop pass runs (e.g.
+ *        after an interrupt wake-up) or APP_EVENT_NO_SLEEP is returned. Call it right before entering
+ *        the state, e.g. in place of the AppEvent_IsIdle() check before LpmEnterLowPower().
+ */
+uint8_t AppEvent_SelectSleepState(void);
+
 /**
  * @brief Print diagnostics information about all registered events
+ * @notes With APP_EVENT_HISTOGRAMS, each event is followed by its latency and execution time
+ *        min/max [ticks] and non-empty histogram buckets as "bucket:count".
  */
 void AppEvent_PrintDiagnostics(void);
 
 /**
  * @brief Enable printing of event diagnostics
  * @param id: event identifier
- * @notes Printing of event debug info is enabled by default. However, serial logging
- *        of high frequency events may disrupt MCU operation. In such case,
- *        the event debug info should be disabled during normal operation.
+ * @notes Event debug records are enabled by default. They are deferred to Log_Flush() and compiled
+ *        out unless DEBUG_APP_EVENT is LOG_LEVEL_DEBUG, but high frequency events can still fill
+ *        the log buffer and push out the records of other events.
+ * @returns false if @p id is not a registered event
  */
-void AppEvent_EnableDebug(uint8_t id);
+bool AppEvent_EnableDebug(uint8_t id);
 
 /**
  * @brief Disable printing of event diagnostics
  * @param id: event identifier
- * @notes Printing of event debug info is enabled by default. However, serial logging
- *        of high frequency events may disrupt MCU operation. In such case,
- *        the event debug info should be disabled during normal operation.
+ * @notes Event debug records are enabled by default. They are deferred to Log_Flush() and compiled
+ *        out unless DEBUG_APP_EVENT is LOG_LEVEL_DEBUG, but high frequency events can still fill
+ *        the log buffer and push out the records of other events.
+ * @returns false if @p id is not a registered event
  */
-void AppEvent_DisableDebug(uint8_t id);
+bool AppEvent_DisableDebug(uint8_t id);
 
 #endif /* EVENT_H */
 
@@ -0,0 +1,252 @@
+/*
+TEST event module, APP_EVENT_HISTOGRAMS build
+Checks the latency and execution histograms of AppEvent_GetStats() against known delays, busy waits on the
+cycle counter, against the host HAL simulation (make test). The host cycle counter counts ns and the build
+sets APP_EVENT_HISTOGRAM_SHIFT to 10, so a bucket i > 0 holds samples of [2^(i-1), 2^i) us, roughly.
+
+Each result is one JSON object per line on stdout:
+
+    {"suite":"event-histograms","test":"execution","count":25,"buckets":[...],"overflow":5}
+
+A failed check prints an "error" line and makes the suite exit with 1.
+*/
+#include "event.h"
+#include "cycle-counter.h"
+#include "sim.h"
+#include <stdio.h>
+
+#define TEST_SAMPLES            20
+#define TEST_LONG_SAMPLES       5
+#define TEST_DELAY_NS           50000u      /* 48 units of 1024 ns: bucket 6, [32, 64) */
+#define TEST_DELAY_BUCKET       6
+#define TEST_LONG_DELAY_NS      300000u     /* Beyond the last bucket */
+
+#define CHECK(test, condition) \
+    do { if (!(condition)) { Fail((test), #condition, __LINE__); } } while (0)
+
+static uint8_t m_id;
+static uint32_t m_busyNs;
+static uint32_t m_failures;
+
+static void Fail(const char* test, const char* condition, int line)
+{
+    printf("{\"suite\":\"event-histograms\",\"test\":\"%s\",\"error\":\"%s\",\"line\":%d}\n", test, condition, line);
+    ++m_failures;
+}
+
+static void BusyWait(uint32_t ns)
+{
+    const uint32_t start = CycleCounter_Get();
+
+    while ((uint32_t)(CycleCounter_Get() - start) < ns)
+    {
+    }
+}
+
+static void OnBusyEvent(void)
+{
+    BusyWait(m_busyNs);
+}
+
+/* Every sample is in exactly one bucket or the overflow */
+static uint32_t GetTotal(const AppEvent_Histogram_t* histogram)
+{
+    uint32_t total = histogram->overflow;
+
+    for (uint8_t bucket = 0; bucket < APP_EVENT_HISTOGRAM_BUCKETS; ++bucket)
+    {
+        total += histogram->buckets[bucket];
+    }
+    return total;
+}
+
+/* A sample may come out late when the host preempts the test, never early */
+static bool IsAtLeast(const AppEvent_Histogram_t* histogram, uint8_t bucket, uint32_t ticks)
+{
+    for (uint8_t i = 0; i < bucket; ++i)
+    {
+        if (histogram->buckets[i] != 0)
+            return false;
+    }
+    return (histogram->count == 0) || (histogram->min >= ticks);
+}
+
+static void PrintHistogram(const char* test, const AppEvent_Histogram_t* histogram)
+{
+    printf("{\"suite\":\"event-histograms\",\"test\":\"%s\",\"count\":%lu,\"min_ns\":%lu,\"max_ns\":%lu,\"buckets\":[",
+           test, (unsigned long)histogram->count, (unsigned long)histogram->min, (unsigned long)histogram->max);
+    for (uint8_t bucket = 0; bucket < APP_EVENT_HISTOGRAM_BUCKETS; ++bucket)
+    {
+        printf("%s%lu", (bucket == 0) ? "" : ",", (unsigned long)histogram->buckets[bucket]);
+    }
+    printf("],\"overflow\":%lu}\n", (unsigned long)histogram->overflow);
+}
+
+static void Setup(APP_EVENT_CONTEXTS context)
+{
+    AppEvent_DeInit();
+    SimTimer_Reset();
+    AppEvent_Init();
+    AppEvent_RegisterEvent(&m_id, "busy", OnBusyEvent, context);
+    AppEvent_DisableDebug(m_id);
+}
+
+/* Callbacks of 50 us, then callbacks longer than the last bucket */
+static void TestExecution(void)
+{
+    AppEvent_Stats_t stats;
+
+    Setup(APP_EVENT_CONTEXT_MAIN);
+    m_busyNs = TEST_DELAY_NS;
+    for (uint32_t i = 0; i < TEST_SAMPLES; ++i)
+    {
+        AppEvent_Trigger(m_id);
+        AppEvent_ProcessMainEvents();
+    }
+    AppEvent_GetStats(m_id, &stats);
+    CHECK("execution", stats.execution.count == TEST_SAMPLES);
+    CHECK("execution", IsAtLeast(&stats.execution, TEST_DELAY_BUCKET, TEST_DELAY_NS));
+    CHECK("execution", stats.execution.buckets[TEST_DELAY_BUCKET] >= TEST_SAMPLES / 2);
+
+    m_busyNs = TEST_LONG_DELAY_NS;
+    for (uint32_t i = 0; i < TEST_LONG_SAMPLES; ++i)
+    {
+        AppEvent_Trigger(m_id);
+        AppEvent_ProcessMainEvents();
+    }
+    AppEvent_GetStats(m_id, &stats);
+    CHECK("execution", stats.execution.count == TEST_SAMPLES + TEST_LONG_SAMPLES);
+    CHECK("execution", stats.execution.overflow >= TEST_LONG_SAMPLES);
+    CHECK("execution", stats.execution.max >= TEST_LONG_DELAY_NS);
+    CHECK("execution", GetTotal(&stats.execution) == stats.execution.count);
+    PrintHistogram("execution", &stats.execution);
+}
+
+/* Main loop passes 50 us after the trigger, then the histograms are cleared */
+static void TestLatency(void)
+{
+    AppEvent_Stats_t stats;
+
+    Setup(APP_EVENT_CONTEXT_MAIN);
+    m_busyNs = 0;
+    for (uint32_t i = 0; i < TEST_SAMPLES; ++i)
+    {
+        AppEvent_Trigger(m_id);
+        /* Only the oldest trigger of a pending event counts */
+        BusyWait(TEST_DELAY_NS / 2);
+        AppEvent_Trigger(m_id);
+        BusyWait(TEST_DELAY_NS / 2);
+        AppEvent_ProcessMainEvents();
+    }
+    AppEvent_GetStats(m_id, &stats);
+    CHECK("latency", stats.latency.count == TEST_SAMPLES);
+    CHECK("latency", IsAtLeast(&stats.latency, TEST_DELAY_BUCKET, TEST_DELAY_NS));
+    CHECK("latency", stats.latency.buckets[TEST_DELAY_BUCKET] >= TEST_SAMPLES / 2);
+    CHECK("latency", GetTotal(&stats.latency) == stats.latency.count);
+    CHECK("latency", stats.execution.count == TEST_SAMPLES);
+    PrintHistogram("latency", &stats.latency);
+
+    AppEvent_ResetStats(m_id);
+    AppEvent_GetStats(m_id, &stats);
+    CHECK("latency", (stats.latency.count == 0) && (stats.latency.max == 0) && (GetTotal(&stats.latency) == 0));
+    CHECK("latency", (stats.execution.count == 0) && (GetTotal(&stats.execution) == 0));
+}
+
+static AppEvent_Record_t m_records[2];
+static uint32_t m_numRecords;
+
+/* The first record triggers the event again and takes longer than the last bucket, the second one triggers
+ * it once more, which is left over for the next pass */
+static void OnBusyRecord(void* context, const AppEvent_Record_t* record)
+{
+    (void)context;
+    (void)record;
+    if (++m_numRecords <= 2)
+    {
+        AppEvent_Trigger(m_id);
+    }
+    BusyWait((m_numRecords == 1) ? TEST_LONG_DELAY_NS : 0);
+}
+
+/* The records left over by a drain are not timed from a trigger served by that drain */
+static void TestQueueLeftover(void)
+{
+    AppEvent_Stats_t stats;
+
+    Setup(APP_EVENT_CONTEXT_MAIN);
+    AppEvent_EnableQueue(m_id, m_records, 2, OnBusyRecord, NULL);
+    m_numRecords = 0;
+    AppEvent_Trigger(m_id);
+    AppEvent_ProcessMainEvents();
+    AppEvent_ProcessMainEvents();
+    AppEvent_GetStats(m_id, &stats);
+    CHECK("queue_leftover", m_numRecords == 3);
+    CHECK("queue_leftover", stats.latency.count == 2);
+    CHECK("queue_leftover", stats.latency.overflow == 0);
+    PrintHistogram("queue_leftover", &stats.latency);
+}
+
+static void OnBusyBatch(void* context, const AppEvent_Batch_t* batch)
+{
+    (void)context;
+    (void)batch;
+}
+
+/* A trigger held by the batch window is timed from the end of the window */
+static void TestHeldBatch(void)
+{
+    AppEvent_Stats_t stats;
+
+    Setup(APP_EVENT_CONTEXT_MAIN);
+    AppEvent_EnableBatching(m_id, 10, OnBusyBatch, NULL);
+    AppEvent_Trigger(m_id);
+    AppEvent_ProcessMainEvents();
+    for (uint32_t i = 0; i < TEST_LONG_SAMPLES; ++i)
+    {
+        AppEvent_Trigger(m_id);
+        AppEvent_ProcessMainEvents();
+        BusyWait(TEST_LONG_DELAY_NS);
+        SimTimer_Advance(10);
+        AppEvent_ProcessMainEvents();
+    }
+    AppEvent_GetStats(m_id, &stats);
+    CHECK("held_batch", stats.latency.count == 1 + TEST_LONG_SAMPLES);
+    CHECK("held_batch", stats.latency.overflow == 0);
+    PrintHistogram("held_batch", &stats.latency);
+}
+
+/* Immediate events run in the triggering context: execution samples only */
+static void TestImmediate(void)
+{
+    AppEvent_Stats_t stats;
+
+    Setup(APP_EVENT_CONTEXT_IMMEDIATE);
+    m_busyNs = TEST_DELAY_NS;
+    for (uint32_t i = 0; i < TEST_SAMPLES; ++i)
+    {
+        AppEvent_Trigger(m_id);
+    }
+    AppEvent_GetStats(m_id, &stats);
+    CHECK("immediate", stats.latency.count == 0);
+    CHECK("immediate", stats.execution.count == TEST_SAMPLES);
+    CHECK("immediate", IsAtLeast(&stats.execution, TEST_DELAY_BUCKET, TEST_DELAY_NS));
+    CHECK("immediate", stats.execution.buckets[TEST_DELAY_BUCKET] >= TEST_SAMPLES / 2);
+    PrintHistogram("immediate", &stats.execution);
+}
+
+int main (int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    CycleCounter_Init();
+    TestExecution();
+    TestLatency();
+    TestImmediate();
+    TestQueueLeftover();
+    TestHeldBatch();
+    AppEvent_DeInit();
+
+    printf("{\"suite\":\"event-histograms\",\"failures\":%lu}\n", (unsigned long)m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
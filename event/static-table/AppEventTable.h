@@ -0,0 +1,19 @@
+#ifndef APP_EVENT_TABLE_H
+#define APP_EVENT_TABLE_H
+
+/* Event table of the APP_EVENT_STATIC_TABLE test, see event/static-table/test.c */
+
+#include "gpio.h"
+
+extern Gpio_t m_buttonGpio;
+
+void OnBlink(void);
+void OnButton(void);
+void OnIdle(void);
+
+#define APP_EVENT_TABLE \
+    APP_EVENT_TIMER(BLINK, OnBlink, 100, 0, APP_EVENT_CONTEXT_IMMEDIATE) \
+    APP_EVENT_INTERRUPT(BUTTON, OnButton, &m_buttonGpio, IRQ_FALLING_EDGE, IRQ_LOW_PRIORITY, APP_EVENT_CONTEXT_MAIN) \
+    APP_EVENT_GENERAL(IDLE, OnIdle, APP_EVENT_CONTEXT_MAIN)
+
+#endif /* APP_EVENT_TABLE_H */
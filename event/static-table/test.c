@@ -0,0 +1,98 @@
+/*
+TEST event module, APP_EVENT_STATIC_TABLE build
+Runs the compile-time event table of AppEventTable.h (a timer, an interrupt and a general event)
+against the host HAL simulation (make test).
+
+Each result is one JSON object per line on stdout:
+
+    {"suite":"event-static","test":"table","events":3,...}
+
+A failed check prints an "error" line and makes the suite exit with 1.
+*/
+#include "event.h"
+#include "sim.h"
+#include <stdio.h>
+
+#define CHECK(test, condition) \
+    do { if (!(condition)) { Fail((test), #condition, __LINE__); } } while (0)
+
+Gpio_t m_buttonGpio = { .intNo = 2, .value = true };
+
+static uint32_t m_blinks;
+static uint32_t m_presses;
+static uint32_t m_idles;
+static uint32_t m_failures;
+
+static void Fail(const char* test, const char* condition, int line)
+{
+    printf("{\"suite\":\"event-static\",\"test\":\"%s\",\"error\":\"%s\",\"line\":%d}\n", test, condition, line);
+    ++m_failures;
+}
+
+void OnBlink(void)
+{
+    ++m_blinks;
+}
+
+void OnButton(void)
+{
+    ++m_presses;
+}
+
+void OnIdle(void)
+{
+    ++m_idles;
+}
+
+/* The table events run without registration, and are kept across AppEvent_DeInit() */
+static void TestTable(void)
+{
+    AppEvent_Group_t group;
+
+    SimTimer_Reset();
+    AppEvent_Init();
+    CHECK("table", AppEvent_GetTimeout(APP_EVENT_ID_BLINK) == 100);
+
+    AppEvent_Start(APP_EVENT_ID_BLINK, false);
+    AppEvent_Start(APP_EVENT_ID_BUTTON, false);
+    SimTimer_Advance(1000);
+    CHECK("table", m_blinks == 10);
+
+    SimGpio_Write(&m_buttonGpio, false);
+    SimGpio_Write(&m_buttonGpio, true);
+    AppEvent_Trigger(APP_EVENT_ID_IDLE);
+    AppEvent_ProcessMainEvents();
+    CHECK("table", m_presses == 1);
+    CHECK("table", m_idles == 1);
+    CHECK("table", AppEvent_IsIdle());
+
+    CHECK("table", AppEvent_GroupCreate(&group));
+    AppEvent_GroupAdd(group, APP_EVENT_ID_BUTTON);
+    AppEvent_GroupAdd(group, APP_EVENT_ID_IDLE);
+    AppEvent_TriggerGroup(group);
+    AppEvent_ProcessMainEvents();
+    CHECK("table", (m_presses == 2) && (m_idles == 2));
+
+    AppEvent_DeInit();
+    CHECK("table", !AppEvent_Running(APP_EVENT_ID_BLINK));
+    AppEvent_Init();
+    AppEvent_Start(APP_EVENT_ID_BLINK, true);
+    SimTimer_Advance(1000);
+    CHECK("table", m_blinks == 11);
+    AppEvent_DeInit();
+
+    printf("{\"suite\":\"event-static\",\"test\":\"table\",\"events\":%u,\"blinks\":%lu,\"presses\":%lu,"
+           "\"idles\":%lu}\n", APP_EVENT_COUNT, (unsigned long)m_blinks, (unsigned long)m_presses,
+           (unsigned long)m_idles);
+}
+
+int main (int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    TestTable();
+
+    printf("{\"suite\":\"event-static\",\"failures\":%lu}\n", (unsigned long)m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -1,12 +1,957 @@
 /*
-TEST src-0
+TEST event module
+Stress and scaling suite against the host HAL simulation (make test).
+
+Sweeps the number of registered events, the interrupt rate against the main loop, the main loop pass
+period, the group broadcast size and the slot reuse past MAX_EVENTS registrations, followed by regression
+checks of the timer batching. Each result is one JSON object per line on
+stdout, for tracking over time:
+
+    {"suite":"event","test":"scale_events","events":8,...,"triggers_per_s":...,"p99_ns":...}
+
+Latencies are cycle counter ticks (nanoseconds on the host, see cycle-counter.h) from the first
+trigger of an event to its callback, or simulated ms for the timer tests. A failed check prints an
+"error" line and makes the suite exit with 1.
 */
+#include "cycle-counter.h"
 #include "event.h"
+#include "sim.h"
 #include <stdio.h>
+#include <stdlib.h>
 
-int main (int argc, char* argv[])
+#define STRESS_EVENTS           32      /* Registered at most, the MAX_EVENTS of the host build */
+#define STRESS_ROUNDS           4000
+#define STRESS_MAX_SAMPLES      (STRESS_EVENTS * STRESS_ROUNDS)
+#define STRESS_QUEUE_SIZE       16
+
+#define CHECK(test, condition) \
+    do { if (!(condition)) { Fail((test), #condition, __LINE__); } } while (0)
+
+typedef struct
+{
+    uint32_t p50;
+    uint32_t p99;
+    uint32_t p999;
+    uint32_t max;
+} Percentiles_t;
+
+static uint8_t m_ids[STRESS_EVENTS];
+static char m_names[STRESS_EVENTS][8];
+static uint32_t m_triggerTicks[STRESS_EVENTS];
+static bool m_pending[STRESS_EVENTS];
+static uint32_t m_callbackCounts[STRESS_EVENTS];
+static uint32_t m_samples[STRESS_MAX_SAMPLES];
+static uint32_t m_numSamples;
+static uint32_t m_failures;
+static AppEvent_Record_t m_records[STRESS_QUEUE_SIZE];
+
+static void Fail(const char* test, const char* condition, int line)
+{
+    printf("{\"suite\":\"event\",\"test\":\"%s\",\"error\":\"%s\",\"line\":%d}\n", test, condition, line);
+    ++m_failures;
+}
+
+static void AddSample(uint32_t sample)
+{
+    if (m_numSamples < STRESS_MAX_SAMPLES)
+    {
+        m_samples[m_numSamples++] = sample;
+    }
+}
+
+static int CompareSamples(const void* a, const void* b)
+{
+    const uint32_t x = *(const uint32_t*)a;
+    const uint32_t y = *(const uint32_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+static Percentiles_t GetPercentiles(void)
+{
+    Percentiles_t result = { 0 };
+
+    if (m_numSamples > 0)
+    {
+        qsort(m_samples, m_numSamples, sizeof(m_samples[0]), CompareSamples);
+        result.p50 = m_samples[(m_numSamples * 50ull) / 100];
+        result.p99 = m_samples[(m_numSamples * 99ull) / 100];
+        result.p999 = m_samples[(m_numSamples * 999ull) / 1000];
+        result.max = m_samples[m_numSamples - 1];
+    }
+    m_numSamples = 0;
+    return result;
+}
+
+static void PrintPercentiles(const char* unit, const Percentiles_t* percentiles)
+{
+    printf(",\"p50_%s\":%lu,\"p99_%s\":%lu,\"p999_%s\":%lu,\"max_%s\":%lu}\n",
+           unit, (unsigned long)percentiles->p50, unit, (unsigned long)percentiles->p99,
+           unit, (unsigned long)percentiles->p999, unit, (unsigned long)percentiles->max);
+}
+
+static double PerSecond(uint64_t count, uint32_t ticks)
+{
+    return (ticks > 0) ? ((double)count * 1e9) / ticks : 0.0;
+}
+
+/* Triggers an event, taking the latency start of its first trigger since the last callback */
+static void TriggerStressEvent(uint8_t index)
+{
+    if (!m_pending[index])
+    {
+        m_pending[index] = true;
+        m_triggerTicks[index] = CycleCounter_Get();
+    }
+    AppEvent_Trigger(m_ids[index]);
+}
+
+static void OnStressEvent(uint8_t index)
+{
+    if (m_pending[index])
+    {
+        m_pending[index] = false;
+        AddSample(CycleCounter_Get() - m_triggerTicks[index]);
+    }
+    ++m_callbackCounts[index];
+}
+
+static void OnStressRecord(void* context, const AppEvent_Record_t* record)
+{
+    (void)context;
+    (void)record;
+    OnStressEvent(0);
+}
+
+/* One callback per event, so that each knows which event it serves */
+#define STRESS_CALLBACK(n)      static void OnStressEvent##n(void) { OnStressEvent(n); }
+#define STRESS_CALLBACK_ENTRY(n) OnStressEvent##n,
+#define STRESS_FOR_EACH_EVENT(X) \
+    X(0) X(1) X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(9) X(10) X(11) X(12) X(13) X(14) X(15) \
+    X(16) X(17) X(18) X(19) X(20) X(21) X(22) X(23) X(24) X(25) X(26) X(27) X(28) X(29) X(30) X(31)
+
+STRESS_FOR_EACH_EVENT(STRESS_CALLBACK)
+
+static const AppEvent_Callback m_callbacks[STRESS_EVENTS] = { STRESS_FOR_EACH_EVENT(STRESS_CALLBACK_ENTRY) };
+
+static const char* EventName(uint8_t i)
+{
+    snprintf(m_names[i], sizeof(m_names[i]), "s%u", i);
+    return m_names[i];
+}
+
+static void ResetModule(void)
+{
+    AppEvent_DeInit();
+    SimTimer_Reset();
+    AppEvent_Init();
+    for (uint8_t i = 0; i < STRESS_EVENTS; ++i)
+    {
+        m_pending[i] = false;
+        m_callbackCounts[i] = 0;
+    }
+    m_numSamples = 0;
+}
+
+static void RegisterStressEvents(uint8_t numEvents)
+{
+    for (uint8_t i = 0; i < numEvents; ++i)
+    {
+        AppEvent_RegisterEvent(&m_ids[i], EventName(i), m_callbacks[i], APP_EVENT_CONTEXT_MAIN);
+        AppEvent_DisableDebug(m_ids[i]);
+    }
+}
+
+/* numEvents main context events, each triggered twice per main loop pass: the second trigger merges */
+static void TestScaleEvents(uint8_t numEvents)
+{
+    uint64_t triggers = 0;
+    uint64_t merged = 0;
+
+    ResetModule();
+    RegisterStressEvents(numEvents);
+
+    const uint32_t start = CycleCounter_Get();
+    for (uint32_t round = 0; round < STRESS_ROUNDS; ++round)
+    {
+        for (uint8_t i = 0; i < numEvents; ++i)
+        {
+            TriggerStressEvent(i);
+            TriggerStressEvent(i);
+        }
+        AppEvent_ProcessMainEvents();
+    }
+    const uint32_t elapsed = CycleCounter_Get() - start;
+
+    for (uint8_t i = 0; i < numEvents; ++i)
+    {
+        AppEvent_Stats_t stats;
+        AppEvent_GetStats(m_ids[i], &stats);
+        triggers += stats.triggerCount;
+        merged += stats.triggerCount - stats.processCount;
+        CHECK("scale_events", stats.triggerCount == 2 * STRESS_ROUNDS);
+        CHECK("scale_events", m_callbackCounts[i] == STRESS_ROUNDS);
+    }
+    CHECK("scale_events", AppEvent_IsIdle());
+
+    const Percentiles_t latency = GetPercentiles();
+    printf("{\"suite\":\"event\",\"test\":\"scale_events\",\"events\":%u,\"passes\":%u,\"triggers\":%llu,"
+           "\"merged\":%llu,\"triggers_per_s\":%.0f,\"ns_per_pass\":%.1f",
+           numEvents, STRESS_ROUNDS, (unsigned long long)triggers, (unsigned long long)merged,
+           PerSecond(triggers, elapsed), (double)elapsed / STRESS_ROUNDS);
+    PrintPercentiles("ns", &latency);
+}
+
+/* Interrupt edges arriving edgesPerPass times per main loop pass, on a plain and on a queued event */
+static void TestInterruptRate(uint16_t edgesPerPass, bool queued)
+{
+    const char* const test = queued ? "interrupt_rate_queued" : "interrupt_rate";
+    static Gpio_t pin = { .intNo = 3 };   /* Still referenced by the event until the next ResetModule() */
+    AppEvent_Stats_t stats;
+    bool level = false;
+
+    ResetModule();
+    AppEvent_RegisterInterrupt(&m_ids[0], EventName(0), m_callbacks[0], &pin, IRQ_RISING_FALLING_EDGE,
+                               IRQ_HIGH_PRIORITY, APP_EVENT_CONTEXT_MAIN);
+    AppEvent_DisableDebug(m_ids[0]);
+    if (queued)
+    {
+        AppEvent_EnableQueue(m_ids[0], m_records, STRESS_QUEUE_SIZE, OnStressRecord, NULL);
+    }
+    AppEvent_Start(m_ids[0], false);
+
+    const uint32_t start = CycleCounter_Get();
+    for (uint32_t round = 0; round < STRESS_ROUNDS; ++round)
+    {
+        for (uint16_t edge = 0; edge < edgesPerPass; ++edge)
+        {
+            if (!m_pending[0])
+            {
+                m_pending[0] = true;
+                m_triggerTicks[0] = CycleCounter_Get();
+            }
+            level = !level;
+            SimGpio_Write(&pin, level);
+        }
+        AppEvent_ProcessMainEvents();
+    }
+    const uint32_t elapsed = CycleCounter_Get() - start;
+
+    AppEvent_GetStats(m_ids[0], &stats);
+    const uint32_t expected = (uint32_t)edgesPerPass * STRESS_ROUNDS;
+    const uint32_t lost = stats.triggerCount - stats.processCount;
+    CHECK(test, stats.triggerCount == expected);
+    CHECK(test, m_callbackCounts[0] == stats.processCount);
+    if (queued)
+    {
+        /* Every trigger is either delivered or dropped */
+        CHECK(test, stats.dropCount == lost);
+    }
+    else
+    {
+        CHECK(test, stats.processCount == STRESS_ROUNDS);
+    }
+
+    const Percentiles_t latency = GetPercentiles();
+    printf("{\"suite\":\"event\",\"test\":\"%s\",\"edges_per_pass\":%u,\"triggers\":%lu,\"callbacks\":%lu,"
+           "\"%s\":%lu,\"triggers_per_s\":%.0f",
+           test, edgesPerPass, (unsigned long)stats.triggerCount, (unsigned long)stats.processCount,
+           queued ? "dropped" : "merged", (unsigned long)lost, PerSecond(stats.triggerCount, elapsed));
+    PrintPercentiles("ns", &latency);
+}
+
+static TimerTime_t m_timerDeadlines[STRESS_EVENTS];
+static uint32_t m_timerPeriods[STRESS_EVENTS];
+
+/* Timer callbacks: latency in simulated ms past the deadline of the period they serve */
+static void OnStressTimer(uint8_t index)
+{
+    const TimerTime_t now = TimerGetCurrentTime();
+
+    AddSample(now - m_timerDeadlines[index]);
+    /* The next callback serves the first period still ahead, expiries in between merged */
+    while (!((int32_t)(m_timerDeadlines[index] - now) > 0))
+    {
+        m_timerDeadlines[index] += m_timerPeriods[index];
+    }
+    ++m_callbackCounts[index];
+}
+
+#define STRESS_TIMER_CALLBACK(n)        static void OnStressTimer##n(void) { OnStressTimer(n); }
+#define STRESS_TIMER_CALLBACK_ENTRY(n)  OnStressTimer##n,
+
+STRESS_FOR_EACH_EVENT(STRESS_TIMER_CALLBACK)
+
+static const AppEvent_Callback m_timerCallbacks[STRESS_EVENTS] =
+{
+    STRESS_FOR_EACH_EVENT(STRESS_TIMER_CALLBACK_ENTRY)
+};
+
+/* numTimers drift-free periodic timers of 10 to 41 ms, main loop passes every passPeriod ms */
+static void TestTimers(const char* test, uint8_t numTimers, uint32_t passPeriod, uint32_t duration)
+{
+    uint64_t triggers = 0;
+    uint64_t callbacks = 0;
+    uint32_t expected = 0;
+
+    ResetModule();
+    for (uint8_t i = 0; i < numTimers; ++i)
+    {
+        m_timerPeriods[i] = 10 + i;
+        m_timerDeadlines[i] = m_timerPeriods[i];
+        AppEvent_RegisterTimer(&m_ids[i], EventName(i), m_timerCallbacks[i], m_timerPeriods[i],
+                               APP_EVENT_CONTEXT_MAIN);
+        AppEvent_DisableDebug(m_ids[i]);
+        AppEvent_SetSchedule(m_ids[i], APP_EVENT_SCHEDULE_ABSOLUTE);
+        AppEvent_Start(m_ids[i], false);
+        expected += duration / m_timerPeriods[i];
+    }
+    const uint32_t alarmWrites = SimTimer_GetAlarmWrites();
+
+    const uint32_t start = CycleCounter_Get();
+    for (uint32_t time = 0; time < duration; time += passPeriod)
+    {
+        SimTimer_Advance(passPeriod);
+        AppEvent_ProcessMainEvents();
+    }
+    const uint32_t elapsed = CycleCounter_Get() - start;
+
+    for (uint8_t i = 0; i < numTimers; ++i)
+    {
+        AppEvent_Stats_t stats;
+        AppEvent_GetStats(m_ids[i], &stats);
+        triggers += stats.triggerCount;
+        callbacks += m_callbackCounts[i];
+        CHECK(test, stats.triggerCount == duration / m_timerPeriods[i]);
+        CHECK(test, m_callbackCounts[i] == stats.processCount);
+    }
+    CHECK(test, triggers == expected);
+
+    const Percentiles_t latency = GetPercentiles();
+    printf("{\"suite\":\"event\",\"test\":\"%s\",\"timers\":%u,\"pass_period_ms\":%lu,\"simulated_ms\":%lu,"
+           "\"triggers\":%llu,\"callbacks\":%llu,\"merged\":%llu,\"alarm_writes\":%lu,\"triggers_per_s\":%.0f",
+           test, numTimers, (unsigned long)passPeriod, (unsigned long)duration, (unsigned long long)triggers,
+           (unsigned long long)callbacks, (unsigned long long)(triggers - callbacks),
+           (unsigned long)(SimTimer_GetAlarmWrites() - alarmWrites), PerSecond(triggers, elapsed));
+    PrintPercentiles("ms", &latency);
+}
+
+/* A broadcast to groupSize of 32 events, one AppEvent_TriggerGroup() against one AppEvent_Trigger() each */
+static void TestGroupTrigger(uint8_t groupSize)
+{
+    AppEvent_Group_t group;
+    uint32_t singlePasses = 0;
+
+    ResetModule();
+    CHECK("group_trigger", AppEvent_GroupCreate(&group));
+    RegisterStressEvents(STRESS_EVENTS);
+    for (uint8_t i = 0; i < groupSize; ++i)
+    {
+        AppEvent_GroupAdd(group, m_ids[i]);
+    }
+
+    const uint32_t triggerStart = CycleCounter_Get();
+    for (uint32_t round = 0; round < STRESS_ROUNDS; ++round)
+    {
+        for (uint8_t i = 0; i < groupSize; ++i)
+        {
+            AppEvent_Trigger(m_ids[i]);
+        }
+        AppEvent_ProcessMainEvents();
+    }
+    const uint32_t triggerElapsed = CycleCounter_Get() - triggerStart;
+
+    /* Paused, the group stays pending; resumed, it runs in one pass */
+    AppEvent_PauseGroup(group);
+    AppEvent_TriggerGroup(group);
+    AppEvent_ProcessMainEvents();
+    CHECK("group_trigger", !AppEvent_IsIdle());
+    CHECK("group_trigger", m_callbackCounts[0] == STRESS_ROUNDS);
+    AppEvent_ResumeGroup(group);
+
+    const uint32_t groupStart = CycleCounter_Get();
+    for (uint32_t round = 0; round < STRESS_ROUNDS; ++round)
+    {
+        if (round != 0)
+        {
+            AppEvent_TriggerGroup(group);
+        }
+        AppEvent_ProcessMainEvents();
+        singlePasses += AppEvent_IsIdle();
+    }
+    const uint32_t groupElapsed = CycleCounter_Get() - groupStart;
+
+    for (uint8_t i = 0; i < STRESS_EVENTS; ++i)
+    {
+        AppEvent_Stats_t stats;
+        AppEvent_GetStats(m_ids[i], &stats);
+        CHECK("group_trigger", m_callbackCounts[i] == ((i < groupSize) ? 2 * STRESS_ROUNDS : 0));
+        CHECK("group_trigger", stats.triggerCount == ((i < groupSize) ? 2 * STRESS_ROUNDS : 0));
+    }
+    CHECK("group_trigger", singlePasses == STRESS_ROUNDS);
+
+    printf("{\"suite\":\"event\",\"test\":\"group_trigger\",\"events\":%u,\"group\":%u,\"broadcasts\":%u,"
+           "\"trigger_ns_per_broadcast\":%.1f,\"group_ns_per_broadcast\":%.1f}\n",
+           STRESS_EVENTS, groupSize, STRESS_ROUNDS, (double)triggerElapsed / STRESS_ROUNDS,
+           (double)groupElapsed / STRESS_ROUNDS);
+}
+
+static TimerTime_t m_callbackTimes[STRESS_EVENTS];
+
+/* Callbacks of the timer regression tests, recording the simulated time they ran at */
+static void OnTimedEvent(uint8_t index)
+{
+    m_callbackTimes[index] = TimerGetCurrentTime();
+    ++m_callbackCounts[index];
+}
+
+static void OnTimedEvent0(void) { OnTimedEvent(0); }
+static void OnTimedEvent1(void) { OnTimedEvent(1); }
+static void OnTimedEvent2(void) { OnTimedEvent(2); }
+
+/* Event 0 stops event 1 from its immediate callback */
+static void OnStoppingTimer(void)
+{
+    OnTimedEvent(0);
+    AppEvent_Stop(m_ids[1]);
+}
+
+/* A stops the continuous timer B from its callback at 10 ms, B due at bTimeout, in the same batch or not */
+static void TestSameBatchStop(uint32_t bTimeout)
+{
+    ResetModule();
+    AppEvent_RegisterTimer(&m_ids[0], EventName(0), OnStoppingTimer, 10, APP_EVENT_CONTEXT_IMMEDIATE);
+    AppEvent_RegisterTimer(&m_ids[1], EventName(1), OnTimedEvent1, bTimeout, APP_EVENT_CONTEXT_IMMEDIATE);
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        AppEvent_DisableDebug(m_ids[i]);
+    }
+    AppEvent_Start(m_ids[0], true);
+    AppEvent_Start(m_ids[1], false);
+
+    SimTimer_Advance(100);
+
+    CHECK("same_batch_stop", m_callbackCounts[0] == 1);
+    CHECK("same_batch_stop", m_callbackCounts[1] == 0);
+    CHECK("same_batch_stop", !AppEvent_Running(m_ids[1]));
+    printf("{\"suite\":\"event\",\"test\":\"same_batch_stop\",\"b_timeout_ms\":%lu,\"a\":%lu,\"b\":%lu}\n",
+           (unsigned long)bTimeout, (unsigned long)m_callbackCounts[0], (unsigned long)m_callbackCounts[1]);
+}
+
+/* A stops B from its immediate callback, both subscribed to the same interrupt line: B is not
+ * triggered by the edge that stopped it */
+static void TestSameLineStop(void)
+{
+    static Gpio_t pin = { .intNo = 4 };   /* Still referenced by the events until the next ResetModule() */
+
+    ResetModule();
+    AppEvent_RegisterInterrupt(&m_ids[0], EventName(0), OnStoppingTimer, &pin, IRQ_RISING_FALLING_EDGE,
+                               IRQ_HIGH_PRIORITY, APP_EVENT_CONTEXT_IMMEDIATE);
+    AppEvent_RegisterInterrupt(&m_ids[1], EventName(1), m_callbacks[1], &pin, IRQ_RISING_FALLING_EDGE,
+                               IRQ_HIGH_PRIORITY, APP_EVENT_CONTEXT_IMMEDIATE);
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        AppEvent_DisableDebug(m_ids[i]);
+        AppEvent_Start(m_ids[i], false);
+    }
+
+    SimGpio_Write(&pin, true);
+    SimGpio_Write(&pin, false);
+
+    CHECK("same_line_stop", m_callbackCounts[0] == 2);
+    CHECK("same_line_stop", m_callbackCounts[1] == 0);
+    printf("{\"suite\":\"event\",\"test\":\"same_line_stop\",\"edges\":2,\"a\":%lu,\"b\":%lu}\n",
+           (unsigned long)m_callbackCounts[0], (unsigned long)m_callbackCounts[1]);
+}
+
+/* Timers ordered by latest expiry R (14 + 1 ms slack), Q (16 ms) and D (10 + 10 ms slack): the wakeup of
+ * R at 15 ms also expires D, which is due but sits below Q in the heap */
+static void TestSlackBatch(void)
+{
+    static const uint32_t timeouts[] = { 14, 16, 10 };
+    static const uint32_t slacks[] = { 1, 0, 10 };
+    static const AppEvent_Callback callbacks[] = { OnTimedEvent0, OnTimedEvent1, OnTimedEvent2 };
+
+    ResetModule();
+    for (uint8_t i = 0; i < 3; ++i)
+    {
+        AppEvent_RegisterTimer(&m_ids[i], EventName(i), callbacks[i], timeouts[i], APP_EVENT_CONTEXT_IMMEDIATE);
+        AppEvent_DisableDebug(m_ids[i]);
+        AppEvent_SetSlack(m_ids[i], slacks[i]);
+    }
+    for (uint8_t i = 0; i < 3; ++i)
+    {
+        AppEvent_Start(m_ids[i], true);
+    }
+    const uint32_t alarmWrites = SimTimer_GetAlarmWrites();
+
+    SimTimer_Advance(100);
+
+    CHECK("slack_batch", m_callbackTimes[0] == 15);
+    CHECK("slack_batch", m_callbackTimes[1] == 16);
+    CHECK("slack_batch", m_callbackTimes[2] == 15);
+    printf("{\"suite\":\"event\",\"test\":\"slack_batch\",\"r_ms\":%lu,\"d_ms\":%lu,\"q_ms\":%lu,"
+           "\"alarm_writes\":%lu}\n",
+           (unsigned long)m_callbackTimes[0], (unsigned long)m_callbackTimes[2], (unsigned long)m_callbackTimes[1],
+           (unsigned long)(SimTimer_GetAlarmWrites() - alarmWrites));
+}
+
+/* A drift-free 10 ms timer with 10 ms of slack expires at its latest expiry, one period late: the period
+ * ending at that very time is still served, not skipped as an overrun, so the callbacks run every 10 ms
+ * from 20 ms */
+static void TestAbsoluteSlack(void)
+{
+    ResetModule();
+    AppEvent_RegisterTimer(&m_ids[0], EventName(0), OnTimedEvent0, 10, APP_EVENT_CONTEXT_IMMEDIATE);
+    AppEvent_DisableDebug(m_ids[0]);
+    AppEvent_SetSchedule(m_ids[0], APP_EVENT_SCHEDULE_ABSOLUTE);
+    AppEvent_SetSlack(m_ids[0], 10);
+    AppEvent_Start(m_ids[0], false);
+
+    SimTimer_Advance(100);
+
+    CHECK("absolute_slack", m_callbackCounts[0] == 9);
+    CHECK("absolute_slack", AppEvent_GetOverrunCount(m_ids[0]) == 0);
+    printf("{\"suite\":\"event\",\"test\":\"absolute_slack\",\"simulated_ms\":100,\"callbacks\":%lu,"
+           "\"overruns\":%lu}\n", (unsigned long)m_callbackCounts[0],
+           (unsigned long)AppEvent_GetOverrunCount(m_ids[0]));
+}
+
+/* Slack or jitter larger than the period delays the callbacks of an idle loop, it does not make every
+ * period an overrun: one drift-free 10 ms timer with 12 ms of slack, one with 15 ms of jitter */
+static void TestAbsoluteLateness(void)
+{
+    ResetModule();
+    AppEvent_RegisterTimer(&m_ids[0], EventName(0), OnTimedEvent0, 10, APP_EVENT_CONTEXT_IMMEDIATE);
+    AppEvent_RegisterTimerWithRandomizer(&m_ids[1], EventName(1), OnTimedEvent1, 10, 15,
+                                         APP_EVENT_CONTEXT_IMMEDIATE);
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        AppEvent_DisableDebug(m_ids[i]);
+        AppEvent_SetSchedule(m_ids[i], APP_EVENT_SCHEDULE_ABSOLUTE);
+    }
+    AppEvent_SetSlack(m_ids[0], 12);
+    AppEvent_Start(m_ids[0], false);
+    AppEvent_Start(m_ids[1], false);
+
+    SimTimer_Advance(1000);
+
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        CHECK("absolute_lateness", m_callbackCounts[i] >= 97);
+        CHECK("absolute_lateness", AppEvent_GetOverrunCount(m_ids[i]) == 0);
+    }
+    printf("{\"suite\":\"event\",\"test\":\"absolute_lateness\",\"simulated_ms\":1000,\"callbacks\":[%lu,%lu],"
+           "\"overruns\":[%lu,%lu]}\n", (unsigned long)m_callbackCounts[0], (unsigned long)m_callbackCounts[1],
+           (unsigned long)AppEvent_GetOverrunCount(m_ids[0]), (unsigned long)AppEvent_GetOverrunCount(m_ids[1]));
+}
+
+#define TEST_MAX_BATCHES        8
+
+static AppEvent_Batch_t m_batchResults[TEST_MAX_BATCHES];
+static TimerTime_t m_batchTimes[TEST_MAX_BATCHES];
+static uint32_t m_numBatches;
+
+static void OnBatch(void* context, const AppEvent_Batch_t* batch)
+{
+    (void)context;
+    if (m_numBatches < TEST_MAX_BATCHES)
+    {
+        m_batchResults[m_numBatches] = *batch;
+        m_batchTimes[m_numBatches] = TimerGetCurrentTime();
+    }
+    ++m_numBatches;
+}
+
+/* Triggers the event at each of @p times, then runs a main loop pass every ms until @p end */
+static void RunBatchTriggers(uint8_t id, const TimerTime_t* times, uint8_t numTimes, TimerTime_t end)
+{
+    uint8_t next = 0;
+
+    while (TimerGetCurrentTime() < end)
+    {
+        while ((next < numTimes) && (times[next] == TimerGetCurrentTime()))
+        {
+            AppEvent_Trigger(id);
+            ++next;
+        }
+        AppEvent_ProcessMainEvents();
+        SimTimer_Advance(1);
+    }
+}
+
+/* A 20 ms batching window: the triggers of a pass make one callback with their count and first/last
+ * times, the triggers within the window are held and run once at its end, a stopped event keeps its
+ * triggers for its next trigger, and an unregistered event leaves no window behind for the event
+ * registered next in its slot */
+static void TestBatching(void)
+{
+    static const TimerTime_t burst[] = { 0, 0, 1, 2 };
+    static const TimerTime_t held[] = { 5, 7 };
+    static const TimerTime_t stopped[] = { 25 };
+    static const TimerTime_t restarted[] = { 60 };
+    static const TimerTime_t unregistered[] = { 70 };
+    uint8_t other;
+
+    ResetModule();
+    m_numBatches = 0;
+    AppEvent_RegisterEvent(&m_ids[0], EventName(0), m_callbacks[0], APP_EVENT_CONTEXT_MAIN);
+    AppEvent_DisableDebug(m_ids[0]);
+    CHECK("batching", AppEvent_EnableBatching(m_ids[0], 20, OnBatch, NULL));
+
+    /* Run in the pass of the first trigger, the window starts there */
+    RunBatchTriggers(m_ids[0], burst, 4, 3);
+    CHECK("batching", (m_numBatches == 1) && (m_batchTimes[0] == 0));
+    CHECK("batching", (m_batchResults[0].count == 2) && (m_batchResults[0].first == 0) &&
+                      (m_batchResults[0].last == 0));
+
+    /* Held to the window end at 20 ms, with the triggers at 1 and 2 ms */
+    RunBatchTriggers(m_ids[0], held, 2, 24);
+    CHECK("batching", (m_numBatches == 2) && (m_batchTimes[1] == 20));
+    CHECK("batching", (m_batchResults[1].count == 4) && (m_batchResults[1].first == 1) &&
+                      (m_batchResults[1].last == 7));
+    CHECK("batching", AppEvent_IsIdle());
+
+    /* Held, then stopped: the window is cancelled and the trigger kept for the next one */
+    RunBatchTriggers(m_ids[0], stopped, 1, 26);
+    AppEvent_Stop(m_ids[0]);
+    RunBatchTriggers(m_ids[0], NULL, 0, 60);
+    CHECK("batching", m_numBatches == 2);
+    RunBatchTriggers(m_ids[0], restarted, 1, 61);
+    CHECK("batching", (m_numBatches == 3) && (m_batchTimes[2] == 60));
+    CHECK("batching", (m_batchResults[2].count == 2) && (m_batchResults[2].first == 25) &&
+                      (m_batchResults[2].last == 60));
+
+    /* Held, then unregistered: the window end reaches neither the batching event registered in the
+     * same window node nor the event registered in the slot */
+    RunBatchTriggers(m_ids[0], unregistered, 1, 71);
+    CHECK("batching", m_numBatches == 3);
+    AppEvent_Unregister(m_ids[0]);
+    AppEvent_RegisterEvent(&m_ids[1], EventName(1), m_callbacks[1], APP_EVENT_CONTEXT_MAIN);
+    AppEvent_RegisterEvent(&other, "other", m_callbacks[2], APP_EVENT_CONTEXT_MAIN);
+    AppEvent_DisableDebug(m_ids[1]);
+    AppEvent_DisableDebug(other);
+    CHECK("batching", AppEvent_EnableBatching(other, 50, OnBatch, NULL));
+    RunBatchTriggers(m_ids[1], NULL, 0, 120);
+    CHECK("batching", (m_numBatches == 3) && (m_callbackCounts[1] == 0) && AppEvent_IsIdle());
+
+    printf("{\"suite\":\"event\",\"test\":\"batching\",\"window_ms\":20,\"callbacks\":%lu,\"counts\":[%lu,%lu,%lu],"
+           "\"times_ms\":[%lu,%lu,%lu]}\n", (unsigned long)m_numBatches, (unsigned long)m_batchResults[0].count,
+           (unsigned long)m_batchResults[1].count, (unsigned long)m_batchResults[2].count,
+           (unsigned long)m_batchTimes[0], (unsigned long)m_batchTimes[1], (unsigned long)m_batchTimes[2]);
+}
+
+/* Events bound to loops 0, 1 and 2 and a timer bound to loop 1: each only runs from the pass of its own
+ * loop, AppEvent_ProcessMainEvents() being the pass of the default loop, and each loop reports its own
+ * idle state */
+static void TestLoops(void)
+{
+    ResetModule();
+    for (uint8_t i = 0; i < 3; ++i)
+    {
+        AppEvent_RegisterEvent(&m_ids[i], EventName(i), m_callbacks[i], APP_EVENT_CONTEXT_MAIN);
+        AppEvent_DisableDebug(m_ids[i]);
+        CHECK("loops", AppEvent_SetLoop(m_ids[i], i));
+    }
+    AppEvent_RegisterTimer(&m_ids[3], EventName(3), m_callbacks[3], 10, APP_EVENT_CONTEXT_MAIN);
+    AppEvent_DisableDebug(m_ids[3]);
+    CHECK("loops", AppEvent_SetLoop(m_ids[3], 1));
+
+    for (uint8_t i = 0; i < 3; ++i)
+    {
+        AppEvent_Trigger(m_ids[i]);
+    }
+    AppEvent_ProcessMainEvents();
+    CHECK("loops", (m_callbackCounts[0] == 1) && (m_callbackCounts[1] == 0) && (m_callbackCounts[2] == 0));
+    CHECK("loops", AppEvent_IsLoopIdle(APP_EVENT_LOOP_DEFAULT) && !AppEvent_IsLoopIdle(1) &&
+                   !AppEvent_IsLoopIdle(2) && !AppEvent_IsIdle());
+
+    AppEvent_ProcessLoopEvents(2);
+    CHECK("loops", (m_callbackCounts[1] == 0) && (m_callbackCounts[2] == 1) && AppEvent_IsLoopIdle(2));
+    AppEvent_ProcessLoopEvents(1);
+    CHECK("loops", (m_callbackCounts[1] == 1) && AppEvent_IsLoopIdle(1) && AppEvent_IsIdle());
+
+    /* The timer of loop 1 expires into loop 1 only */
+    AppEvent_Start(m_ids[3], true);
+    SimTimer_Advance(10);
+    AppEvent_ProcessMainEvents();
+    AppEvent_ProcessLoopEvents(2);
+    CHECK("loops", (m_callbackCounts[3] == 0) && !AppEvent_IsLoopIdle(1));
+    AppEvent_ProcessLoopEvents(1);
+    CHECK("loops", (m_callbackCounts[3] == 1) && AppEvent_IsIdle());
+
+    /* Bound back to the default loop */
+    CHECK("loops", AppEvent_SetLoop(m_ids[1], APP_EVENT_LOOP_DEFAULT));
+    AppEvent_Trigger(m_ids[1]);
+    CHECK("loops", AppEvent_IsLoopIdle(1) && !AppEvent_IsLoopIdle(APP_EVENT_LOOP_DEFAULT));
+    AppEvent_ProcessMainEvents();
+    CHECK("loops", (m_callbackCounts[1] == 2) && AppEvent_IsIdle());
+
+    AppEvent_Unregister(m_ids[2]);
+    CHECK("loops", !AppEvent_SetLoop(m_ids[2], 1));
+    printf("{\"suite\":\"event\",\"test\":\"loops\",\"loops\":%u,\"callbacks\":[%lu,%lu,%lu,%lu]}\n",
+           APP_EVENT_NUM_LOOPS, (unsigned long)m_callbackCounts[0], (unsigned long)m_callbackCounts[1],
+           (unsigned long)m_callbackCounts[2], (unsigned long)m_callbackCounts[3]);
+}
+
+/* Record callback triggering its own event again, so the queue is refilled as fast as it is drained */
+static void OnRefillingRecord(void* context, const AppEvent_Record_t* record)
+{
+    (void)context;
+    ++m_callbackCounts[0];
+    AppEvent_TriggerWithPayload(m_ids[0], record->payload + 1);
+}
+
+/* A pass drains at most one queue length of a self refilling queue and leaves the event pending */
+static void TestQueueRefill(void)
+{
+    ResetModule();
+    AppEvent_RegisterEvent(&m_ids[0], EventName(0), m_callbacks[0], APP_EVENT_CONTEXT_MAIN);
+    AppEvent_DisableDebug(m_ids[0]);
+    AppEvent_EnableQueue(m_ids[0], m_records, STRESS_QUEUE_SIZE, OnRefillingRecord, NULL);
+    AppEvent_TriggerWithPayload(m_ids[0], 0);
+
+    AppEvent_ProcessMainEvents();
+    CHECK("queue_refill", m_callbackCounts[0] == STRESS_QUEUE_SIZE);
+    CHECK("queue_refill", !AppEvent_IsIdle());
+    AppEvent_ProcessMainEvents();
+    CHECK("queue_refill", m_callbackCounts[0] == 2 * STRESS_QUEUE_SIZE);
+
+    AppEvent_Stats_t stats;
+    AppEvent_GetStats(m_ids[0], &stats);
+    CHECK("queue_refill", stats.dropCount == 0);
+    printf("{\"suite\":\"event\",\"test\":\"queue_refill\",\"queue_size\":%u,\"records_per_pass\":%lu}\n",
+           STRESS_QUEUE_SIZE, (unsigned long)(m_callbackCounts[0] / 2));
+}
+
+/* A 100 ms timer after a sleep selection with a 5 ms wake-up latency, the selection followed by an
+ * interrupt wake-up (a loop pass) or by a decision not to sleep: the timer then wakes the CPU once, at
+ * its deadline, rather than 5 ms early */
+static void TestSleepAdvance(bool interruptWakeup)
+{
+    static const AppEvent_SleepState_t sleepStates[] = { { .wakeupLatency = 5, .minResidency = 10 } };
+    const char* const test = interruptWakeup ? "sleep_advance_interrupt" : "sleep_advance_no_sleep";
+
+    ResetModule();
+    AppEvent_SetSleepStates(sleepStates, 1);
+    AppEvent_RegisterTimer(&m_ids[0], EventName(0), OnTimedEvent0, 100, APP_EVENT_CONTEXT_IMMEDIATE);
+    AppEvent_RegisterEvent(&m_ids[1], EventName(1), m_callbacks[1], APP_EVENT_CONTEXT_MAIN);
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        AppEvent_DisableDebug(m_ids[i]);
+    }
+    AppEvent_Start(m_ids[0], true);
+
+    CHECK(test, AppEvent_SelectSleepState() == 0);
+    SimTimer_Advance(50);
+    AppEvent_Trigger(m_ids[1]);
+    if (interruptWakeup)
+    {
+        AppEvent_ProcessMainEvents();
+    }
+    else
+    {
+        CHECK(test, AppEvent_SelectSleepState() == APP_EVENT_NO_SLEEP);
+    }
+    SimTimer_Advance(100);
+
+    CHECK(test, m_callbackTimes[0] == 100);
+    CHECK(test, SimTimer_GetExpiries() == 1);
+    printf("{\"suite\":\"event\",\"test\":\"%s\",\"callback_ms\":%lu,\"wakeups\":%lu}\n",
+           test, (unsigned long)m_callbackTimes[0], (unsigned long)SimTimer_GetExpiries());
+    AppEvent_SetSleepStates(NULL, 0);
+}
+
+static char m_dispatchOrder[4];
+static uint8_t m_numDispatched;
+
+static void OnOrderedEvent(char name)
+{
+    if (m_numDispatched < sizeof(m_dispatchOrder) - 1)
+    {
+        m_dispatchOrder[m_numDispatched++] = name;
+    }
+}
+
+static void OnEventA(void) { OnOrderedEvent('A'); }
+static void OnEventB(void) { OnOrderedEvent('B'); }
+
+/* A and a high priority Y, Y unregistered and its slot taken by B: B is dispatched with the normal
+ * priority it was registered with, after A. The identifier of Y is rejected. */
+static void TestPriorityReuse(void)
+{
+    uint8_t y;
+
+    ResetModule();
+    m_numDispatched = 0;
+    AppEvent_RegisterEvent(&m_ids[0], "A", OnEventA, APP_EVENT_CONTEXT_MAIN);
+    AppEvent_RegisterEvent(&y, "Y", OnEventB, APP_EVENT_CONTEXT_MAIN);
+    AppEvent_SetPriority(y, APP_EVENT_PRIORITY_HIGH);
+    CHECK("priority_reuse", AppEvent_Unregister(y));
+    AppEvent_RegisterEvent(&m_ids[1], "B", OnEventB, APP_EVENT_CONTEXT_MAIN);
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        AppEvent_DisableDebug(m_ids[i]);
+    }
+    AppEvent_Trigger(m_ids[0]);
+    AppEvent_Trigger(m_ids[1]);
+    AppEvent_ProcessMainEvents();
+    m_dispatchOrder[m_numDispatched] = '\0';
+
+    CHECK("priority_reuse", (m_dispatchOrder[0] == 'A') && (m_dispatchOrder[1] == 'B') && (m_numDispatched == 2));
+    CHECK("priority_reuse", !AppEvent_SetPriority(y, APP_EVENT_PRIORITY_HIGH));
+    CHECK("priority_reuse", !AppEvent_Start(y, true) && !AppEvent_Unregister(y));
+    CHECK("priority_reuse", AppEvent_GetTimeout(y) == 0);
+    printf("{\"suite\":\"event\",\"test\":\"priority_reuse\",\"order\":\"%s\"}\n", m_dispatchOrder);
+}
+
+/* A group of A and Y, Y unregistered and its slot taken by B: the group no longer holds the slot, so
+ * triggering it runs A only, and the stale identifier of Y cannot be added back */
+static void TestGroupReuse(void)
+{
+    AppEvent_Group_t group;
+    AppEvent_Group_t other;
+    uint8_t y;
+
+    ResetModule();
+    m_numDispatched = 0;
+    CHECK("group_reuse", AppEvent_GroupCreate(&group));
+    AppEvent_RegisterEvent(&m_ids[0], "A", OnEventA, APP_EVENT_CONTEXT_MAIN);
+    AppEvent_RegisterEvent(&y, "Y", OnEventB, APP_EVENT_CONTEXT_MAIN);
+    AppEvent_GroupAdd(group, m_ids[0]);
+    AppEvent_GroupAdd(group, y);
+    AppEvent_Unregister(y);
+    AppEvent_RegisterEvent(&m_ids[1], "B", OnEventB, APP_EVENT_CONTEXT_MAIN);
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        AppEvent_DisableDebug(m_ids[i]);
+    }
+    CHECK("group_reuse", !AppEvent_GroupAdd(group, y));
+    AppEvent_TriggerGroup(group);
+    AppEvent_ProcessMainEvents();
+    m_dispatchOrder[m_numDispatched] = '\0';
+
+    CHECK("group_reuse", (m_dispatchOrder[0] == 'A') && (m_numDispatched == 1));
+
+    /* Deleted, the group entry is taken by the next group: the stale handle acts on nothing */
+    CHECK("group_reuse", AppEvent_GroupDelete(group));
+    CHECK("group_reuse", AppEvent_GroupCreate(&other) && (other != group));
+    AppEvent_GroupAdd(other, m_ids[1]);
+    CHECK("group_reuse", !AppEvent_GroupAdd(group, m_ids[0]) && !AppEvent_GroupDelete(group));
+    AppEvent_TriggerGroup(group);
+    AppEvent_ProcessMainEvents();
+    CHECK("group_reuse", m_numDispatched == 1);
+
+    /* Creating groups fails once the table is full, and a deleted group can be created again */
+    uint32_t numGroups = 1;
+    while (AppEvent_GroupCreate(&group))
+    {
+        ++numGroups;
+    }
+    CHECK("group_reuse", (numGroups >= 2) && (numGroups <= 32));
+    CHECK("group_reuse", AppEvent_GroupDelete(other) && AppEvent_GroupCreate(&other) && !AppEvent_GroupCreate(&group));
+    m_dispatchOrder[m_numDispatched] = '\0';
+    printf("{\"suite\":\"event\",\"test\":\"group_reuse\",\"order\":\"%s\",\"groups\":%lu}\n", m_dispatchOrder,
+           (unsigned long)numGroups);
+}
+
+/* Register/unregister cycles through all the slots, numCycles times MAX_EVENTS registrations */
+static void TestSlotChurn(uint32_t numCycles)
 {
+    uint32_t staleIgnored = 0;
+    uint32_t registrations = 0;
+
+    ResetModule();
+    RegisterStressEvents(STRESS_EVENTS);
+
+    const uint32_t start = CycleCounter_Get();
+    for (uint32_t cycle = 0; cycle < numCycles; ++cycle)
+    {
+        for (uint8_t i = 0; i < STRESS_EVENTS; ++i)
+        {
+            const uint8_t stale = m_ids[i];
+
+            AppEvent_Unregister(stale);
+            AppEvent_RegisterEvent(&m_ids[i], EventName(i), m_callbacks[i], APP_EVENT_CONTEXT_MAIN);
+            AppEvent_DisableDebug(m_ids[i]);
+            ++registrations;
+
+            /* The identifier from before the re-registration is ignored */
+            AppEvent_Stats_t stats;
+            AppEvent_Trigger(stale);
+            AppEvent_GetStats(m_ids[i], &stats);
+            if (stats.triggerCount == 0)
+            {
+                ++staleIgnored;
+            }
+            TriggerStressEvent(i);
+        }
+        AppEvent_ProcessMainEvents();
+    }
+    const uint32_t elapsed = CycleCounter_Get() - start;
+
+    for (uint8_t i = 0; i < STRESS_EVENTS; ++i)
+    {
+        CHECK("slot_churn", m_callbackCounts[i] == numCycles);
+    }
+    CHECK("slot_churn", staleIgnored == registrations);
 
-    return 0;
+    const Percentiles_t latency = GetPercentiles();
+    printf("{\"suite\":\"event\",\"test\":\"slot_churn\",\"events\":%u,\"registrations\":%lu,"
+           "\"stale_ignored\":%lu,\"registrations_per_s\":%.0f",
+           STRESS_EVENTS, (unsigned long)registrations, (unsigned long)staleIgnored,
+           PerSecond(registrations, elapsed));
+    PrintPercentiles("ns", &latency);
 }
 
+int main (int argc, char* argv[])
+{
+    static const uint8_t eventCounts[] = { 1, 2, 4, 8, 16, 24, 32 };
+    static const uint16_t edgeRates[] = { 1, 2, 8, 32, 128 };
+    static const uint8_t timerCounts[] = { 1, 4, 8, 16, 32 };
+    static const uint32_t passPeriods[] = { 1, 5, 10, 20, 50, 100 };
+    static const uint8_t groupSizes[] = { 1, 2, 5, 8, 16, 32 };
+    (void)argc;
+    (void)argv;
+
+    CycleCounter_Init();
+
+    for (uint8_t i = 0; i < sizeof(eventCounts); ++i)
+    {
+        TestScaleEvents(eventCounts[i]);
+    }
+    for (uint8_t i = 0; i < sizeof(edgeRates) / sizeof(edgeRates[0]); ++i)
+    {
+        TestInterruptRate(edgeRates[i], false);
+        TestInterruptRate(edgeRates[i], true);
+    }
+    for (uint8_t i = 0; i < sizeof(timerCounts); ++i)
+    {
+        TestTimers("scale_timers", timerCounts[i], 1, 10000);
+    }
+    for (uint8_t i = 0; i < sizeof(passPeriods) / sizeof(passPeriods[0]); ++i)
+    {
+        TestTimers("pass_period", 8, passPeriods[i], 10000);
+    }
+    for (uint8_t i = 0; i < sizeof(groupSizes); ++i)
+    {
+        TestGroupTrigger(groupSizes[i]);
+    }
+    TestSlotChurn(64);
+    TestSameBatchStop(10);
+    TestSameBatchStop(15);
+    TestSameLineStop();
+    TestSlackBatch();
+    TestAbsoluteSlack();
+    TestAbsoluteLateness();
+    TestQueueRefill();
+    TestBatching();
+    TestLoops();
+    TestSleepAdvance(true);
+    TestSleepAdvance(false);
+    TestPriorityReuse();
+    TestGroupReuse();
+
+    printf("{\"suite\":\"event\",\"failures\":%lu}\n", (unsigned long)m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
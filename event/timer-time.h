@@ -0,0 +1,20 @@
+#ifndef TIMER_TIME_H
+#define TIMER_TIME_H
+
+/*
+ * Comparison of TimerTime_t values (ms of TimerGetCurrentTime()) across the 32-bit wrap, shared by the
+ * event and digital pattern modules. Valid while the two times are less than 2^31 ms apart.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "timer.h"
+
+/* Wrap-safe "time is earlier than reference" */
+static inline bool TimerTime_IsBefore(TimerTime_t time, TimerTime_t reference)
+{
+    return (int32_t)(time - reference) < 0;
+}
+
+#endif /* TIMER_TIME_H */
@@ -0,0 +1,88 @@
+/* The log module does not log itself */
+#define LOG_LEVEL   0
+
+#include "log.h"
+#include "SerialConsole.h"
+#include "utilities.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+_Static_assert((LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)) == 0, "LOG_BUFFER_SIZE must be a power of two");
+_Static_assert(LOG_BUFFER_SIZE <= 32768, "LOG_BUFFER_SIZE must fit the 16-bit ring indexes");
+
+static const char* const m_levelNames[] = { "", "E", "W", "I", "D" };
+
+static Log_Record_t m_records[LOG_BUFFER_SIZE];
+/* Free running ring indexes, the number of stored records is head - tail */
+static volatile uint16_t m_head;
+static volatile uint16_t m_tail;
+static volatile uint16_t m_dropCount;
+static uint16_t m_reportedDropCount;
+static Log_Formatter m_formatters[LOG_MODULE_COUNT];
+
+void Log_Write(uint8_t module, uint8_t level, uint8_t id, uint8_t code, uint32_t arg)
+{
+    const TimerTime_t now = TimerGetCurrentTime();
+
+    CRITICAL_SECTION_BEGIN();
+    const uint16_t head = m_head;
+    if ((uint16_t)(head - m_tail) >= LOG_BUFFER_SIZE)
+    {
+        ++m_dropCount;
+    }
+    else
+    {
+        Log_Record_t* const record = &m_records[head & (LOG_BUFFER_SIZE - 1)];
+        record->timestamp = now;
+        record->arg = arg;
+        record->module = module;
+        record->level = level;
+        record->id = id;
+        record->code = code;
+        m_head = head + 1;
+    }
+    CRITICAL_SECTION_END();
+}
+
+void Log_SetFormatter(uint8_t module, Log_Formatter formatter)
+{
+    if (module < LOG_MODULE_COUNT)
+    {
+        m_formatters[module] = formatter;
+    }
+}
+
+void Log_Flush(void)
+{
+    while (m_tail != m_head)
+    {
+        /* Only the main context consumes records, producers never move the tail */
+        const Log_Record_t record = m_records[m_tail & (LOG_BUFFER_SIZE - 1)];
+        m_tail = m_tail + 1;
+
+        const char* const level = (record.level <= LOG_LEVEL_DEBUG) ? m_levelNames[record.level] : "?";
+        PRINTF("[%lu] %s ", (unsigned long)record.timestamp, level);
+        if ((record.module < LOG_MODULE_COUNT) && (m_formatters[record.module] != NULL))
+        {
+            (*(m_formatters[record.module]))(&record);
+        }
+        else
+        {
+            PRINTF("module %u id %u code %u arg %lu\r\n", record.module, record.id, record.code,
+                   (unsigned long)record.arg);
+        }
+    }
+
+    const uint16_t dropCount = m_dropCount;
+    if (dropCount != m_reportedDropCount)
+    {
+        PRINTF("#WARN: %u log records dropped\r\n", (uint16_t)(dropCount - m_reportedDropCount));
+        m_reportedDropCount = dropCount;
+    }
+}
+
+uint16_t Log_GetDropCount(void)
+{
+    return m_dropCount;
+}
@@ -0,0 +1,123 @@
+#ifndef LOG_H
+#define LOG_H
+
+/*
+ * Deferred binary logging.
+ *
+ * Logging calls, including the ones in interrupt handlers, only store a fixed size record (module,
+ * level, id, code, argument and timestamp) in a ring buffer. Formatting and console output happen later,
+ * when the main loop calls Log_Flush(), through the formatter each module registers for its records.
+ *
+ * Each module defines LOG_LEVEL to one of the LOG_LEVEL_* values before including this header, usually
+ * from its AppDebugConfig.h switch:
+ *
+ *     #define LOG_LEVEL        DEBUG_APP_EVENT
+ *     #include "log.h"
+ *
+ * Calls above the module level, their arguments and the module formatter are compiled out completely.
+ */
+
+#include <stdint.h>
+
+#include "timer.h"
+
+#define LOG_LEVEL_NONE      0
+#define LOG_LEVEL_ERROR     1
+#define LOG_LEVEL_WARN      2
+#define LOG_LEVEL_INFO      3
+#define LOG_LEVEL_DEBUG     4
+
+/* Number of records held until the next Log_Flush(), power of two */
+#ifndef LOG_BUFFER_SIZE
+#define LOG_BUFFER_SIZE     64
+#endif
+
+typedef enum
+{
+    LOG_MODULE_APP_EVENT,
+    LOG_MODULE_DIGITAL_PATTERN,
+    LOG_MODULE_COUNT
+} LOG_MODULES;
+
+typedef struct
+{
+    TimerTime_t timestamp;
+    uint32_t arg;
+    uint8_t module;
+    uint8_t level;
+    uint8_t id;             /* Module defined, e.g. the event id */
+    uint8_t code;           /* Module defined message code */
+} Log_Record_t;
+
+/* Prints one record of the module, called from Log_Flush() after the record timestamp is printed */
+typedef void (* Log_Formatter)(const Log_Record_t* record);
+
+/**
+ * @brief Stores a log record.
+ * @param module - LOG_MODULES of the caller
+ * @param level - LOG_LEVEL_* of the record
+ * @param id - module defined object id
+ * @param code - module defined message code
+ * @param arg - message argument
+ * @notes Interrupt safe. When the buffer is full the record is dropped and counted, see Log_GetDropCount().
+ * Use the LOG_* macros below rather than calling this directly, so that the call can be compiled out.
+ */
+void Log_Write(uint8_t module, uint8_t level, uint8_t id, uint8_t code, uint32_t arg);
+
+/**
+ * @brief Sets the formatter used by Log_Flush() for the records of a module.
+ * @param module - LOG_MODULES
+ * @param formatter - formatter, records of modules without one are printed raw
+ */
+void Log_SetFormatter(uint8_t module, Log_Formatter formatter);
+
+/**
+ * @brief Formats and prints all stored records, oldest first.
+ * @notes Main context only. Call it when the console output does not matter for timing, e.g. before
+ * entering low power mode.
+ */
+void Log_Flush(void);
+
+/**
+ * @brief Returns the number of records dropped because the buffer was full.
+ */
+uint16_t Log_GetDropCount(void);
+
+#endif /* LOG_H */
+
+/* Level gated logging macros, resolved against the LOG_LEVEL of the including module */
+#if !defined(LOG_LEVEL)
+#error "Define LOG_LEVEL before including log.h"
+#endif
+
+#undef LOG_ERROR
+#undef LOG_WARN
+#undef LOG_INFO
+#undef LOG_DEBUG
+#undef LOG_SET_FORMATTER
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(module, id, code, arg)    Log_Write((module), LOG_LEVEL_ERROR, (id), (code), (arg))
+#define LOG_SET_FORMATTER(module, formatter) Log_SetFormatter((module), (formatter))
+#else
+#define LOG_ERROR(module, id, code, arg)    ((void)0)
+#define LOG_SET_FORMATTER(module, formatter) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(module, id, code, arg)     Log_Write((module), LOG_LEVEL_WARN, (id), (code), (arg))
+#else
+#define LOG_WARN(module, id, code, arg)     ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(module, id, code, arg)     Log_Write((module), LOG_LEVEL_INFO, (id), (code), (arg))
+#else
+#define LOG_INFO(module, id, code, arg)     ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(module, id, code, arg)    Log_Write((module), LOG_LEVEL_DEBUG, (id), (code), (arg))
+#else
+#define LOG_DEBUG(module, id, code, arg)    ((void)0)
+#endif
@@ -0,0 +1,20 @@
+#ifndef APP_DEBUG_CONFIG_H
+#define APP_DEBUG_CONFIG_H
+
+/* Per module debug log switches, off by default so that benchmarks measure the modules only */
+#ifndef DEBUG_APP_EVENT
+#define DEBUG_APP_EVENT         0
+#endif
+
+#ifndef DEBUG_DIGITAL_PATTERN
+#define DEBUG_DIGITAL_PATTERN   0
+#endif
+
+/* The digital-pattern test build records the node changes of the matchers, see digital-pattern/test.c */
+#ifdef DIGITAL_PATTERN_TEST_HOOKS
+#include <stdint.h>
+void Test_OnPatternNode(const void* matcher, uint8_t node);
+#define DIGITAL_PATTERN_HOOK_NODE(matcher, node)    Test_OnPatternNode((matcher), (node))
+#endif
+
+#endif /* APP_DEBUG_CONFIG_H */
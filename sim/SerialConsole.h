@@ -0,0 +1,11 @@
+#ifndef SERIAL_CONSOLE_H
+#define SERIAL_CONSOLE_H
+
+#include <stdio.h>
+
+#define PRINTF(...)         printf(__VA_ARGS__)
+
+/* Gated by the LOG_LEVEL of the including module */
+#define DEBUG_PRINTF(...)   do { if (LOG_LEVEL) { printf(__VA_ARGS__); } } while (0)
+
+#endif /* SERIAL_CONSOLE_H */
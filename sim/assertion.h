@@ -0,0 +1,8 @@
+#ifndef ASSERTION_H
+#define ASSERTION_H
+
+#include <assert.h>
+
+#define ASSERT(x)   assert(x)
+
+#endif /* ASSERTION_H */
@@ -0,0 +1,45 @@
+#include <stddef.h>
+
+#include "gpio.h"
+#include "sim.h"
+
+void GpioSetInterrupt(Gpio_t* obj, IrqModes irqMode, IrqPriorities irqPriority, GpioIrqHandler* irqHandler)
+{
+    (void)irqPriority;
+    obj->irqMode = irqMode;
+    obj->irqHandler = irqHandler;
+}
+
+void GpioRemoveInterrupt(Gpio_t* obj)
+{
+    obj->irqMode = NO_IRQ;
+    obj->irqHandler = NULL;
+}
+
+void GpioMcuSetContext(Gpio_t* obj, void* context)
+{
+    obj->context = context;
+}
+
+uint32_t GpioRead(Gpio_t* obj)
+{
+    return obj->value;
+}
+
+void SimGpio_Write(Gpio_t* obj, bool value)
+{
+    const bool previous = obj->value;
+
+    obj->value = value;
+    if ((obj->irqHandler == NULL) || (previous == value))
+    {
+        return;
+    }
+
+    if ((obj->irqMode == IRQ_RISING_FALLING_EDGE) ||
+        ((obj->irqMode == IRQ_RISING_EDGE) && value) ||
+        ((obj->irqMode == IRQ_FALLING_EDGE) && !value))
+    {
+        (*(obj->irqHandler))(obj->context);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef GPIO_H
+#define GPIO_H
+
+/*
+ * Host simulation of the GPIO HAL.
+ *
+ * Pins are plain structs, SimGpio_Write() changes the input level and runs the interrupt handler
+ * from the caller's context when the edge matches the configured interrupt mode.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum
+{
+    NO_IRQ = 0,
+    IRQ_RISING_EDGE,
+    IRQ_FALLING_EDGE,
+    IRQ_RISING_FALLING_EDGE
+} IrqModes;
+
+typedef enum
+{
+    IRQ_VERY_LOW_PRIORITY = 0,
+    IRQ_LOW_PRIORITY,
+    IRQ_MEDIUM_PRIORITY,
+    IRQ_HIGH_PRIORITY,
+    IRQ_VERY_HIGH_PRIORITY
+} IrqPriorities;
+
+typedef void (GpioIrqHandler)(void* context);
+
+typedef struct
+{
+    uint8_t intNo;
+    bool value;
+    IrqModes irqMode;
+    GpioIrqHandler* irqHandler;
+    void* context;
+} Gpio_t;
+
+void GpioSetInterrupt(Gpio_t* obj, IrqModes irqMode, IrqPriorities irqPriority, GpioIrqHandler* irqHandler);
+
+void GpioRemoveInterrupt(Gpio_t* obj);
+
+void GpioMcuSetContext(Gpio_t* obj, void* context);
+
+uint32_t GpioRead(Gpio_t* obj);
+
+#endif /* GPIO_H */
@@ -0,0 +1,39 @@
+#ifndef SIM_H
+#define SIM_H
+
+/* Test and benchmark controls of the host HAL simulation */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gpio.h"
+
+/**
+ * @brief Moves the simulated time forward, firing every timer that expires on the way.
+ * @param ms - time to advance [ms]
+ */
+void SimTimer_Advance(uint32_t ms);
+
+/**
+ * @brief Returns the number of times the hardware alarm was (re)programmed.
+ */
+uint32_t SimTimer_GetAlarmWrites(void);
+
+/**
+ * @brief Returns the number of timer expiries, i.e. of wake-ups by a timer on a target.
+ */
+uint32_t SimTimer_GetExpiries(void);
+
+/**
+ * @brief Drops all running timers and resets the simulated time to 0.
+ */
+void SimTimer_Reset(void);
+
+/**
+ * @brief Drives the level of an input pin, running its interrupt handler on a matching edge.
+ * @param obj - pin
+ * @param value - new level
+ */
+void SimGpio_Write(Gpio_t* obj, bool value);
+
+#endif /* SIM_H */
@@ -0,0 +1,143 @@
+#include <stddef.h>
+
+#include "timer.h"
+#include "sim.h"
+#include "utilities.h"
+
+/* Running timers, sorted by expiry */
+static TimerEvent_t* m_timerList;
+static TimerTime_t m_now;
+static uint32_t m_alarmWrites;
+static uint32_t m_expiries;
+static uint32_t m_criticalDepth;
+
+static bool IsBefore(TimerTime_t a, TimerTime_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+static void RemoveTimer(TimerEvent_t* obj)
+{
+    for (TimerEvent_t** it = &m_timerList; *it != NULL; it = &(*it)->next)
+    {
+        if (*it == obj)
+        {
+            *it = obj->next;
+            break;
+        }
+    }
+    obj->running = false;
+}
+
+void TimerInit(TimerEvent_t* obj, void (* callback)(void* context))
+{
+    obj->running = false;
+    obj->callback = callback;
+    obj->context = NULL;
+    obj->reloadValue = 0;
+    obj->next = NULL;
+}
+
+void TimerStart(TimerEvent_t* obj)
+{
+    TimerEvent_t** it = &m_timerList;
+
+    if (obj->running)
+    {
+        RemoveTimer(obj);
+    }
+
+    obj->expiry = m_now + obj->reloadValue;
+    obj->running = true;
+    while ((*it != NULL) && !IsBefore(obj->expiry, (*it)->expiry))
+    {
+        it = &(*it)->next;
+    }
+    obj->next = *it;
+    *it = obj;
+    ++m_alarmWrites;
+}
+
+void TimerStartWithParam(TimerEvent_t* obj, void* context)
+{
+    obj->context = context;
+    TimerStart(obj);
+}
+
+void TimerStop(TimerEvent_t* obj)
+{
+    if (obj->running)
+    {
+        RemoveTimer(obj);
+    }
+}
+
+void TimerSetValue(TimerEvent_t* obj, uint32_t value)
+{
+    TimerStop(obj);
+    obj->reloadValue = value;
+}
+
+bool TimerRunning(TimerEvent_t* obj)
+{
+    return obj->running;
+}
+
+TimerTime_t TimerGetCurrentTime(void)
+{
+    return m_now;
+}
+
+TimerTime_t TimerGetElapsedTime(TimerTime_t past)
+{
+    return m_now - past;
+}
+
+TimerTime_t TimerTimeRemaining(TimerEvent_t* obj)
+{
+    return obj->running ? (obj->expiry - m_now) : 0;
+}
+
+void SimTimer_Advance(uint32_t ms)
+{
+    const TimerTime_t target = m_now + ms;
+
+    while ((m_timerList != NULL) && !IsBefore(target, m_timerList->expiry))
+    {
+        TimerEvent_t* obj = m_timerList;
+
+        m_now = obj->expiry;
+        RemoveTimer(obj);
+        ++m_expiries;
+        (*(obj->callback))(obj->context);
+    }
+    m_now = target;
+}
+
+uint32_t SimTimer_GetAlarmWrites(void)
+{
+    return m_alarmWrites;
+}
+
+uint32_t SimTimer_GetExpiries(void)
+{
+    return m_expiries;
+}
+
+void SimTimer_Reset(void)
+{
+    m_timerList = NULL;
+    m_now = 0;
+    m_alarmWrites = 0;
+    m_expiries = 0;
+}
+
+void BoardCriticalSectionBegin(uint32_t* mask)
+{
+    *mask = m_criticalDepth++;
+}
+
+void BoardCriticalSectionEnd(uint32_t* mask)
+{
+    m_criticalDepth = *mask;
+}
@@ -0,0 +1,45 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+/*
+ * Host simulation of the timer HAL.
+ *
+ * Time is simulated in milliseconds and only moves when SimTimer_Advance() is called, which fires
+ * due timers in expiry order from the caller's context, as the RTC alarm interrupt would.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef uint32_t TimerTime_t;
+
+typedef struct TimerEvent_s
+{
+    TimerTime_t expiry;
+    TimerTime_t reloadValue;
+    bool running;
+    void (* callback)(void* context);
+    void* context;
+    struct TimerEvent_s* next;
+} TimerEvent_t;
+
+void TimerInit(TimerEvent_t* obj, void (* callback)(void* context));
+
+void TimerStart(TimerEvent_t* obj);
+
+void TimerStartWithParam(TimerEvent_t* obj, void* context);
+
+void TimerStop(TimerEvent_t* obj);
+
+/* Stops the timer, as the target implementation does */
+void TimerSetValue(TimerEvent_t* obj, uint32_t value);
+
+bool TimerRunning(TimerEvent_t* obj);
+
+TimerTime_t TimerGetCurrentTime(void);
+
+TimerTime_t TimerGetElapsedTime(TimerTime_t past);
+
+TimerTime_t TimerTimeRemaining(TimerEvent_t* obj);
+
+#endif /* TIMER_H */
@@ -0,0 +1,14 @@
+#ifndef UTILITIES_H
+#define UTILITIES_H
+
+#include <stdint.h>
+
+/* The host has no interrupts, the critical section only tracks nesting */
+void BoardCriticalSectionBegin(uint32_t* mask);
+
+void BoardCriticalSectionEnd(uint32_t* mask);
+
+#define CRITICAL_SECTION_BEGIN()    uint32_t mask; BoardCriticalSectionBegin(&mask)
+#define CRITICAL_SECTION_END()      BoardCriticalSectionEnd(&mask)
+
+#endif /* UTILITIES_H */
@@ -0,0 +1,129 @@
+/*
+TEST trace decoder
+Runs the host decoder (trace-decode) on crafted dumps (make test). The decoder path is given by
+TRACE_DECODE at build time, or as the first argument.
+
+Checks the timestamp unwrapping across a counter wrap and with a record older than its predecessor in
+the ring, which is what a record preempted by an interrupt trace point looks like. Each result is one
+JSON object per line on stdout:
+
+    {"suite":"trace","test":"decode_order","records":5,"ts_us":[...]}
+
+A failed check prints an "error" line and makes the suite exit with 1.
+*/
+#define _POSIX_C_SOURCE 200809L
+
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef TRACE_DECODE
+#define TRACE_DECODE            "trace-decode"
+#endif
+
+#define TEST_COUNTER_HZ         1000000u    /* One tick per us */
+#define TEST_MAX_RECORDS        8
+
+#define CHECK(test, condition) \
+    do { if (!(condition)) { Fail((test), #condition, __LINE__); } } while (0)
+
+static const char* m_decoder = TRACE_DECODE;
+static uint32_t m_failures;
+
+static void Fail(const char* test, const char* condition, int line)
+{
+    printf("{\"suite\":\"trace\",\"test\":\"%s\",\"error\":\"%s\",\"line\":%d}\n", test, condition, line);
+    ++m_failures;
+}
+
+/* Decodes a dump of trigger records with the given timestamps, returns the number of timestamps read */
+static uint32_t Decode(const uint32_t* timestamps, uint32_t count, double* us)
+{
+    const Trace_Header_t header = { .magic = TRACE_MAGIC, .counterHz = TEST_COUNTER_HZ, .count = count };
+    char path[] = "/tmp/trace-test-XXXXXX";
+    char command[256];
+    char line[256];
+    uint32_t decoded = 0;
+    FILE* dump;
+    FILE* output;
+    int fd;
+
+    if (((fd = mkstemp(path)) < 0) || ((dump = fdopen(fd, "wb")) == NULL))
+        return 0;
+    fwrite(&header, sizeof(header), 1, dump);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const Trace_Record_t record =
+        {
+            .timestamp = timestamps[i],
+            .id = (uint8_t)i,
+            .code = TRACE_EVENT_TRIGGER
+        };
+
+        fwrite(&record, sizeof(record), 1, dump);
+    }
+    fclose(dump);
+
+    snprintf(command, sizeof(command), "%s %s", m_decoder, path);
+    if ((output = popen(command, "r")) != NULL)
+    {
+        /* One trace event per line, the instant events are the records */
+        while ((fgets(line, sizeof(line), output) != NULL) && (decoded < count))
+        {
+            const char* const ts = strstr(line, "\"ts\":");
+
+            if ((strstr(line, "\"ph\":\"i\"") != NULL) && (ts != NULL))
+            {
+                us[decoded++] = strtod(ts + strlen("\"ts\":"), NULL);
+            }
+        }
+        if (pclose(output) != 0)
+        {
+            decoded = 0;
+        }
+    }
+    remove(path);
+    return decoded;
+}
+
+static void PrintTimestamps(const char* test, const double* us, uint32_t count)
+{
+    printf("{\"suite\":\"trace\",\"test\":\"%s\",\"records\":%lu,\"ts_us\":[", test, (unsigned long)count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        printf("%s%.0f", (i == 0) ? "" : ",", us[i]);
+    }
+    printf("]}\n");
+}
+
+/* Records across the counter wrap, the fourth one preempted by the third: its timestamp is 1 ms older
+ * than the record before it in the ring, and the decoder places it 1 ms earlier, not 2^32 ticks later */
+static void TestDecodeOrder(void)
+{
+    static const uint32_t timestamps[] = { 0xFFFFF830u, 0xFFFFFC18u, 0x000003E8u, 0x00000000u, 0x000007D0u };
+    static const double expected[] = { 0.0, 1000.0, 3000.0, 2000.0, 4000.0 };
+    const uint32_t count = sizeof(timestamps) / sizeof(timestamps[0]);
+    double us[TEST_MAX_RECORDS] = { 0 };
+    const uint32_t decoded = Decode(timestamps, count, us);
+
+    CHECK("decode_order", decoded == count);
+    for (uint32_t i = 0; i < decoded; ++i)
+    {
+        CHECK("decode_order", us[i] == expected[i]);
+    }
+    PrintTimestamps("decode_order", us, decoded);
+}
+
+int main (int argc, char* argv[])
+{
+    if (argc > 1)
+    {
+        m_decoder = argv[1];
+    }
+
+    TestDecodeOrder();
+
+    printf("{\"suite\":\"trace\",\"failures\":%lu}\n", (unsigned long)m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+/*
+Host decoder of Trace_Dump() output
+Converts a trace dump to a Chrome/Perfetto JSON trace (chrome://tracing, ui.perfetto.dev):
+
+    trace-decode [dump] > trace.json
+
+The dump is read from stdin when no file is given. Event callbacks are shown as slices, triggers,
+timer expiries, interrupts and starts as instant events, and pattern phases as a counter track.
+*/
+#include "trace.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define TID_EVENTS      1
+#define TID_PATTERNS    2
+
+static const char* const m_phaseStates[] = { "idle", "in progress", "complete", "invalid" };
+
+static bool m_first = true;
+
+/* Prints the separator and the fields common to every trace event */
+static void BeginTraceEvent(const char* phase, uint8_t tid, double us)
+{
+    printf("%s\n{\"ph\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f", m_first ? "" : ",", phase, tid, us);
+    m_first = false;
+}
+
+static void PrintThreadName(uint8_t tid, const char* name)
+{
+    BeginTraceEvent("M", tid, 0.0);
+    printf(",\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}", name);
+}
+
+static void PrintInstant(const char* name, uint8_t id, double us, const Trace_Record_t* record, bool withArg)
+{
+    BeginTraceEvent("i", TID_EVENTS, us);
+    printf(",\"s\":\"t\",\"name\":\"%s %u\"", name, id);
+    if (withArg)
+    {
+        printf(",\"args\":{\"arg\":%u}", record->arg);
+    }
+    printf("}");
+}
+
+static void PrintRecord(const Trace_Record_t* record, double us)
+{
+    switch (record->code)
+    {
+        case TRACE_EVENT_TRIGGER:
+            PrintInstant("trigger", record->id, us, record, true);
+            break;
+        case TRACE_EVENT_TIMER:
+            PrintInstant("timer", record->id, us, record, false);
+            break;
+        case TRACE_EVENT_INTERRUPT:
+            PrintInstant("irq", record->id, us, record, false);
+            break;
+        case TRACE_EVENT_START:
+            PrintInstant("start", record->id, us, record, true);
+            break;
+        case TRACE_EVENT_CALLBACK_BEGIN:
+        case TRACE_EVENT_CALLBACK_END:
+            BeginTraceEvent((record->code == TRACE_EVENT_CALLBACK_BEGIN) ? "B" : "E", TID_EVENTS, us);
+            printf(",\"name\":\"event %u\"}", record->id);
+            break;
+        case TRACE_PATTERN_PHASE:
+        {
+            const int phase = (record->id == 0xFF) ? -1 : record->id;
+            const char* const state = (record->arg < 4) ? m_phaseStates[record->arg] : "?";
+
+            BeginTraceEvent("C", TID_PATTERNS, us);
+            printf(",\"name\":\"pattern phase\",\"args\":{\"phase\":%d}}", phase);
+            BeginTraceEvent("i", TID_PATTERNS, us);
+            printf(",\"s\":\"t\",\"name\":\"phase %d %s\"}", phase, state);
+            break;
+        }
+        case TRACE_PATTERN_NODE:
+            BeginTraceEvent("C", TID_PATTERNS, us);
+            printf(",\"name\":\"pattern node\",\"args\":{\"node\":%u}}", record->id);
+            break;
+        default:
+            fprintf(stderr, "unknown trace code %u\n", record->code);
+            break;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    FILE* const input = (argc > 1) ? fopen(argv[1], "rb") : stdin;
+    Trace_Header_t header;
+    Trace_Record_t record;
+    int64_t ticks = 0;
+    uint32_t previous = 0;
+    uint32_t count = 0;
+
+    if (input == NULL)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    if ((fread(&header, sizeof(header), 1, input) != 1) || (header.magic != TRACE_MAGIC) || (header.counterHz == 0))
+    {
+        fprintf(stderr, "not a trace dump\n");
+        return 1;
+    }
+    if (header.lost != 0)
+    {
+        fprintf(stderr, "%" PRIu32 " older records were overwritten\n", header.lost);
+    }
+
+    printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    PrintThreadName(TID_EVENTS, "events");
+    PrintThreadName(TID_PATTERNS, "patterns");
+    for (; (count < header.count) && (fread(&record, sizeof(record), 1, input) == 1); ++count)
+    {
+        /* Timestamps relative to the first record, unwrapped across counter wraps. The delta is signed:
+         * a record preempted between its index reservation and its stores is older than its predecessor. */
+        ticks += (count == 0) ? 0 : (int32_t)(record.timestamp - previous);
+        previous = record.timestamp;
+        PrintRecord(&record, (double)ticks * 1e6 / header.counterHz);
+    }
+    printf("\n]}\n");
+
+    if (count != header.count)
+    {
+        fprintf(stderr, "dump truncated, %" PRIu32 " of %" PRIu32 " records\n", count, header.count);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+#include "assertion.h"
+#include "trace.h"
+
+#include <stddef.h>
+#include <string.h>
+
+_Static_assert((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0, "TRACE_BUFFER_SIZE must be a power of two");
+
+Trace_Buffer_t Trace_Buffer;
+
+static uint32_t m_counterHz;
+
+void Trace_Init(uint32_t counterHz)
+{
+    ASSERT(counterHz != 0);
+
+    CycleCounter_Init();
+    memset(Trace_Buffer.records, 0, sizeof(Trace_Buffer.records));
+    atomic_init(&Trace_Buffer.head, 0);
+    m_counterHz = counterHz;
+}
+
+void Trace_Dump(Trace_Output output)
+{
+    ASSERT(output != NULL);
+
+    const uint32_t head = atomic_load_explicit(&Trace_Buffer.head, memory_order_acquire);
+    const uint32_t count = (head < TRACE_BUFFER_SIZE) ? head : TRACE_BUFFER_SIZE;
+    const Trace_Header_t header =
+    {
+        .magic = TRACE_MAGIC,
+        .counterHz = m_counterHz,
+        .count = count,
+        .lost = head - count
+    };
+
+    (*output)(&header, sizeof(header));
+    for (uint32_t i = head - count; i != head; ++i)
+    {
+        (*output)(&Trace_Buffer.records[i & (TRACE_BUFFER_SIZE - 1)], sizeof(Trace_Record_t));
+    }
+}
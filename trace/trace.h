@@ -0,0 +1,115 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/*
+ * Hot path trace points with cycle counter timestamps.
+ *
+ * Each trace point stores an 8-byte record (cycle counter, tracepoint code, id and argument) in a RAM
+ * ring that keeps the most recent TRACE_BUFFER_SIZE records. Trace_Write() is inline: a counter read,
+ * one atomic increment of the ring index and two stores, interrupt safe. The ring is dumped with
+ * Trace_Dump(), and the host decoder (trace/trace-decode.c) converts the dump to a Chrome/Perfetto
+ * JSON trace:
+ *
+ *     trace-decode trace.bin > trace.json
+ *
+ * The modules compile their trace points in with a build flag and out completely without it:
+ *  - APP_EVENT_TRACE: triggers, timer expiries, interrupts, event starts and callback begin/end
+ *  - DIGITAL_PATTERN_TRACE: phase changes and compiled matcher node changes
+ *
+ * Timestamps are CycleCounter_Get() ticks (see cycle-counter.h). The decoder unwraps them from the signed
+ * difference of consecutive records, which must be less than half a counter wrap apart in either
+ * direction: a preempted record may be older than the one before it in the ring, see Trace_Write().
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "cycle-counter.h"
+
+/* Number of records kept in the ring, power of two */
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE       256
+#endif
+
+/* Trace_Header_t magic, "TRC1" in a little endian dump */
+#define TRACE_MAGIC             0x31435254u
+
+typedef enum
+{
+    TRACE_EVENT_TRIGGER,            /* id: event, arg: payload (low 16 bits) */
+    TRACE_EVENT_TIMER,              /* id: event, timer expiry in OnEvent */
+    TRACE_EVENT_INTERRUPT,          /* id: interrupt line, OnInterruptEvent entry */
+    TRACE_EVENT_START,              /* id: event, arg: timeout [ms] or interrupt line */
+    TRACE_EVENT_CALLBACK_BEGIN,     /* id: event */
+    TRACE_EVENT_CALLBACK_END,       /* id: event */
+    TRACE_PATTERN_PHASE,            /* id: phase index (0xFF once reset), arg: PHASE_STATE */
+    TRACE_PATTERN_NODE,             /* id: node of a compiled matcher */
+    TRACE_CODE_COUNT
+} TRACE_CODES;
+
+typedef struct
+{
+    uint32_t timestamp;             /* CycleCounter_Get() */
+    uint16_t arg;
+    uint8_t id;
+    uint8_t code;                   /* TRACE_CODES */
+} Trace_Record_t;
+
+_Static_assert(sizeof(Trace_Record_t) == 8, "Trace_Record_t must stay 8 bytes");
+
+/* Start of a Trace_Dump() output, followed by count records, oldest first */
+typedef struct
+{
+    uint32_t magic;                 /* TRACE_MAGIC */
+    uint32_t counterHz;             /* Cycle counter frequency */
+    uint32_t count;                 /* Records that follow */
+    uint32_t lost;                  /* Older records overwritten before the dump */
+} Trace_Header_t;
+
+/* Writes @p size bytes of the dump, e.g. to a console or a file */
+typedef void (* Trace_Output)(const void* data, uint32_t size);
+
+/* Ring of Trace_Write(), not to be used directly */
+typedef struct
+{
+    Trace_Record_t records[TRACE_BUFFER_SIZE];
+    _Atomic uint32_t head;          /* Free running, records written since Trace_Init() */
+} Trace_Buffer_t;
+
+extern Trace_Buffer_t Trace_Buffer;
+
+/**
+ * @brief Clears the ring and starts the cycle counter.
+ * @param counterHz - cycle counter frequency, e.g. the CPU clock, stored in the dump for the decoder
+ */
+void Trace_Init(uint32_t counterHz);
+
+/**
+ * @brief Stores a trace record, overwriting the oldest one when the ring is full.
+ * @param code - TRACE_CODES
+ * @param id - code defined id
+ * @param arg - code defined argument
+ * @notes Interrupt safe. A record preempted between its index reservation and its stores is still
+ * written completely, only the order of the two records in the ring may differ from their timestamps.
+ */
+static inline void Trace_Write(uint8_t code, uint8_t id, uint16_t arg)
+{
+    const uint32_t timestamp = CycleCounter_Get();
+    const uint32_t head = atomic_fetch_add_explicit(&Trace_Buffer.head, 1, memory_order_relaxed);
+    Trace_Record_t* const record = &Trace_Buffer.records[head & (TRACE_BUFFER_SIZE - 1)];
+
+    record->timestamp = timestamp;
+    record->arg = arg;
+    record->id = id;
+    record->code = code;
+}
+
+/**
+ * @brief Writes the header and the stored records, oldest first.
+ * @param output - output of the dump
+ * @notes Main context. Records written during the dump may overwrite the oldest ones being output,
+ * dump while the traced activity is quiet, e.g. after a failure or before entering low power mode.
+ */
+void Trace_Dump(Trace_Output output);
+
+#endif /* TRACE_H */